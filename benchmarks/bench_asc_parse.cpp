@@ -0,0 +1,186 @@
+// ASC parse-throughput benchmark: AscParser over a synthetic 3D Studio ASCII
+// mesh (a subdivided grid with about a million faces by default), reported in
+// MB/s. --legacy also times the former per-line std::regex importer on the
+// same text, which is slow enough that a smaller --faces count is advised.
+//
+// Usage: bench_asc_parse [--runs N] [--faces N] [--legacy] [file.asc...]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "assets/asc_parser.hpp"
+#include "assets/mapped_file.hpp"
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    double elapsedMs(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    double median(std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+        return values.empty() ? 0.0 : values[values.size() / 2];
+    }
+
+    // A (side+1)^2 vertex grid split into 2*side^2 triangles, laid out the way
+    // 3D Studio exports it.
+    std::string makeSyntheticAsc(size_t faces) {
+        size_t side = 1;
+        while (2 * side * side < faces) {
+            ++side;
+        }
+        const size_t vertexCount = (side + 1) * (side + 1);
+        const size_t faceCount = 2 * side * side;
+
+        std::string text;
+        text.reserve(vertexCount * 64 + faceCount * 48);
+        char line[128];
+        text += "Named Object: \"Grid01\"\n";
+        std::snprintf(line, sizeof(line), "Tri-mesh, Vertices: %zu     Faces: %zu\n", vertexCount, faceCount);
+        text += line;
+        text += "Vertex list:\n";
+        for (size_t y = 0; y <= side; ++y) {
+            for (size_t x = 0; x <= side; ++x) {
+                float h = static_cast<float>((x * 7 + y * 13) % 17) * 0.125f - 1.0f;
+                std::snprintf(line, sizeof(line), "Vertex %zu: X: %f     Y: %f     Z: %f\n",
+                              y * (side + 1) + x, x * 0.5f - side * 0.25f, y * 0.5f - side * 0.25f, h);
+                text += line;
+            }
+        }
+        text += "Face list:\n";
+        size_t face = 0;
+        for (size_t y = 0; y < side; ++y) {
+            for (size_t x = 0; x < side; ++x) {
+                size_t a = y * (side + 1) + x;
+                size_t b = a + 1;
+                size_t c = a + side + 1;
+                size_t d = c + 1;
+                std::snprintf(line, sizeof(line), "Face %zu:    A:%zu B:%zu C:%zu AB:1 BC:1 CA:0\n", face++, a, b, d);
+                text += line;
+                text += "Smoothing:  1\n";
+                std::snprintf(line, sizeof(line), "Face %zu:    A:%zu B:%zu C:%zu AB:1 BC:1 CA:0\n", face++, a, d, c);
+                text += line;
+                text += "Smoothing:  1\n";
+            }
+        }
+        return text;
+    }
+
+    // The importer this benchmark replaced, kept for comparison.
+    size_t parseWithRegex(const std::string& text) {
+        std::istringstream file(text);
+        std::string line;
+        bool readingVertices = false;
+        bool readingFaces = false;
+        std::vector<VertexData> vertices;
+        std::vector<FaceData> faces;
+
+        while (std::getline(file, line)) {
+            line.erase(0, line.find_first_not_of(" \t\r\n"));
+            line.erase(line.find_last_not_of(" \t\r\n") + 1);
+            if (line.empty())
+                continue;
+            if (line.find("Vertex list:") != std::string::npos) {
+                readingVertices = true;
+                readingFaces = false;
+                continue;
+            }
+            if (line.find("Face list:") != std::string::npos) {
+                readingVertices = false;
+                readingFaces = true;
+                continue;
+            }
+            if (readingVertices && line.find("Vertex") != std::string::npos) {
+                std::regex vertexRegex(R"(Vertex\s+\d+:\s+X:\s+([-.\dEe]+)\s+Y:\s+([-.\dEe]+)\s+Z:\s+([-.\dEe]+))");
+                std::smatch match;
+                if (std::regex_search(line, match, vertexRegex)) {
+                    VertexData vertexData;
+                    vertexData.vertex.x = std::stof(match[1]);
+                    vertexData.vertex.y = std::stof(match[2]);
+                    vertexData.vertex.z = std::stof(match[3]);
+                    vertices.push_back(vertexData);
+                }
+            }
+            if (readingFaces && line.find("Face") != std::string::npos) {
+                std::regex faceRegex(R"(Face\s+\d+:\s+A:(\d+)\s+B:(\d+)\s+C:(\d+))");
+                std::smatch match;
+                if (std::regex_search(line, match, faceRegex)) {
+                    FaceData faceData;
+                    faceData.face.vertexIndices.push_back(std::stoi(match[1]));
+                    faceData.face.vertexIndices.push_back(std::stoi(match[2]));
+                    faceData.face.vertexIndices.push_back(std::stoi(match[3]));
+                    faces.push_back(faceData);
+                }
+            }
+        }
+        return faces.size();
+    }
+
+    void report(const std::string& label, const std::string& text, int runs, bool legacy) {
+        const double megabytes = text.size() / (1024.0 * 1024.0);
+        std::vector<double> times;
+        size_t faces = 0;
+        for (int r = 0; r < runs; ++r) {
+            AscParser::Result result;
+            auto start = Clock::now();
+            AscParser::parse(text.data(), text.size(), result);
+            times.push_back(elapsedMs(start));
+            faces = result.faces.size();
+        }
+        double ms = median(times);
+        std::printf("%-32s %9.1f %10zu %10.2f %10.1f", label.c_str(), megabytes, faces, ms,
+                    megabytes / (ms / 1000.0));
+
+        if (legacy) {
+            auto start = Clock::now();
+            parseWithRegex(text);
+            double legacyMs = elapsedMs(start);
+            std::printf(" %12.1f %10.2f", legacyMs, megabytes / (legacyMs / 1000.0));
+        }
+        std::printf("\n");
+    }
+
+}
+
+int main(int argc, char** argv) {
+    int runs = 5;
+    size_t faces = 1000000;
+    bool legacy = false;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--faces") == 0 && i + 1 < argc) {
+            faces = static_cast<size_t>(std::max(2, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--legacy") == 0) {
+            legacy = true;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+
+    std::printf("%-32s %9s %10s %10s %10s", "input", "MB", "faces", "parse ms", "MB/s");
+    if (legacy) {
+        std::printf(" %12s %10s", "regex ms", "regex MB/s");
+    }
+    std::printf("\n");
+
+    report("synthetic (" + std::to_string(faces) + " faces)", makeSyntheticAsc(faces), runs, legacy);
+    for (const auto& file : files) {
+        MappedFile mapped;
+        if (!mapped.open(file)) {
+            std::fprintf(stderr, "cannot open %s\n", file.c_str());
+            continue;
+        }
+        report(file, std::string(mapped.data(), mapped.size()), runs, legacy);
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+// Material key benchmark: face key memory and the per-face material lookup
+// of the draw loop, with the names an OBJ import produces and after
+// MaterialKeys::intern() replaced them with dense ids. Meshes whose names
+// all fit the string's inline buffer are left as imported, so both columns
+// match for them.
+//
+// Usage: bench_material_keys [--runs N] file.obj...
+// The lookup loop stands in for the renderer's: one find() per face in the
+// MaterialComponent's own map type, repeated for `frames` frames.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "assets/material_keys.hpp"
+#include "assets/mesh_cache.hpp"
+#include "assets/prefab_factory.hpp"
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int kFrames = 100;
+
+    double elapsedMs(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    double median(std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+        return values.empty() ? 0.0 : values[values.size() / 2];
+    }
+
+    // Face array plus the bytes its material keys hold on the heap.
+    size_t faceBytes(const MeshComponent& mesh) {
+        size_t bytes = mesh.faceData.size() * sizeof(FaceData);
+        for (const auto& face : mesh.faceData) {
+            bytes += face.face.vertexIndices.size() * sizeof(int);
+        }
+        return bytes + MaterialKeys::keyHeapBytes(mesh);
+    }
+
+    // Milliseconds per frame of looking up every face's material.
+    double lookupMs(const MeshComponent& mesh, const MaterialComponent& material, int runs) {
+        std::vector<double> times;
+        size_t found = 0;
+        for (int r = 0; r < runs; ++r) {
+            auto start = Clock::now();
+            for (int frame = 0; frame < kFrames; ++frame) {
+                for (const auto& face : mesh.faceData) {
+                    found += material.materials.find(face.face.materialKey) != material.materials.end();
+                }
+            }
+            times.push_back(elapsedMs(start) / kFrames);
+        }
+        if (found == 0) {
+            std::fprintf(stderr, "no face matched a material\n");
+        }
+        return median(times);
+    }
+
+}
+
+int main(int argc, char** argv) {
+    int runs = 5;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = std::max(1, std::atoi(argv[++i]));
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (files.empty()) {
+        files = {"resources/objs/isometric_level/Isometric_Game_Level_Low_Poly.obj",
+                 "resources/objs/cat_statue/concrete_cat_statue.obj",
+                 "resources/objs/viking_room/viking_room.obj"};
+    }
+
+    MeshCache::setEnabled(false);
+
+    std::printf("%-64s %8s %12s %12s %12s %12s\n", "file", "faces",
+                "names KB", "ids KB", "names ms", "ids ms");
+    for (const auto& file : files) {
+        MeshComponent mesh;
+        MaterialComponent material;
+        TransformComponent transform;
+        PrefabFactory::buildObj(file, mesh, material, transform, false);
+        if (mesh.faceData.empty()) {
+            std::fprintf(stderr, "failed to load %s\n", file.c_str());
+            continue;
+        }
+
+        const size_t namedBytes = faceBytes(mesh);
+        const double namedMs = lookupMs(mesh, material, runs);
+        MaterialKeys::intern(mesh, material);
+        const size_t internedBytes = faceBytes(mesh);
+        const double internedMs = lookupMs(mesh, material, runs);
+
+        std::printf("%-64s %8zu %12.1f %12.1f %12.3f %12.3f\n", file.c_str(),
+                    mesh.faceData.size(), namedBytes / 1024.0, internedBytes / 1024.0,
+                    namedMs, internedMs);
+    }
+    return 0;
+}
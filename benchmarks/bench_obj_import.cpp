@@ -0,0 +1,158 @@
+// OBJ import benchmark: end-to-end PrefabFactory::buildObj time (mesh cache
+// disabled) plus the corner-deduplication stage in isolation, comparing the
+// former std::map<tuple> approach with VertexDedupTable.
+//
+// Usage: bench_obj_import [--runs N] [--dedup map|table|both] file.obj...
+// Peak RSS is process-wide, so compare strategies with one --dedup per run.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "assets/mesh_cache.hpp"
+#include "assets/prefab_factory.hpp"
+#include "assets/vertex_dedup.hpp"
+#include "vendor/tinyobjloader/tiny_obj_loader.h"
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    double elapsedMs(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    double median(std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+        return values.empty() ? 0.0 : values[values.size() / 2];
+    }
+
+    double peakRssMb() {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters;
+        GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+        return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+        return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+        return usage.ru_maxrss / 1024.0;
+#endif
+#endif
+    }
+
+    size_t dedupWithMap(const std::vector<tinyobj::shape_t>& shapes) {
+        std::map<std::tuple<int, int, int>, int> vertexMap;
+        for (const auto& shape : shapes) {
+            for (const auto& idx : shape.mesh.indices) {
+                auto key = std::make_tuple(idx.vertex_index, idx.texcoord_index, idx.normal_index);
+                if (vertexMap.find(key) == vertexMap.end()) {
+                    vertexMap[key] = static_cast<int>(vertexMap.size());
+                }
+            }
+        }
+        return vertexMap.size();
+    }
+
+    size_t dedupWithTable(const std::vector<tinyobj::shape_t>& shapes) {
+        size_t corners = 0;
+        for (const auto& shape : shapes) {
+            corners += shape.mesh.indices.size();
+        }
+        VertexDedupTable table(corners);
+        for (const auto& shape : shapes) {
+            for (const auto& idx : shape.mesh.indices) {
+                table.findOrInsert(idx.vertex_index, idx.texcoord_index, idx.normal_index,
+                                   static_cast<int>(table.size()));
+            }
+        }
+        return table.size();
+    }
+
+}
+
+int main(int argc, char** argv) {
+    int runs = 5;
+    std::string dedup = "both";
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--dedup") == 0 && i + 1 < argc) {
+            dedup = argv[++i];
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (files.empty()) {
+        files = {"resources/objs/bunny.obj", "resources/objs/suzanne.obj",
+                 "resources/objs/teapot.obj"};
+    }
+
+    MeshCache::setEnabled(false);
+
+    std::printf("%-32s %10s %10s %12s %12s %9s\n",
+                "file", "import ms", "corners", "map ms", "table ms", "vertices");
+    for (const auto& file : files) {
+        std::vector<double> importTimes;
+        for (int r = 0; r < runs; ++r) {
+            MeshComponent mesh;
+            MaterialComponent material;
+            TransformComponent transform;
+            auto start = Clock::now();
+            PrefabFactory::buildObj(file, mesh, material, transform, false);
+            importTimes.push_back(elapsedMs(start));
+        }
+
+        tinyobj::ObjReader reader;
+        tinyobj::ObjReaderConfig config;
+        config.triangulate = true;
+        if (!reader.ParseFromFile(file, config)) {
+            std::fprintf(stderr, "failed to parse %s\n", file.c_str());
+            continue;
+        }
+        const auto& shapes = reader.GetShapes();
+        size_t corners = 0;
+        for (const auto& shape : shapes) {
+            corners += shape.mesh.indices.size();
+        }
+
+        std::vector<double> mapTimes;
+        std::vector<double> tableTimes;
+        size_t unique = 0;
+        for (int r = 0; r < runs; ++r) {
+            if (dedup != "table") {
+                auto start = Clock::now();
+                unique = dedupWithMap(shapes);
+                mapTimes.push_back(elapsedMs(start));
+            }
+            if (dedup != "map") {
+                auto start = Clock::now();
+                unique = dedupWithTable(shapes);
+                tableTimes.push_back(elapsedMs(start));
+            }
+        }
+
+        std::printf("%-32s %10.2f %10zu %12.3f %12.3f %9zu\n", file.c_str(),
+                    median(importTimes), corners, median(mapTimes), median(tableTimes), unique);
+    }
+
+    std::printf("peak RSS: %.1f MB\n", peakRssMb());
+    return 0;
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <string>
+#include <vector>
 #include <render3d/constants.hpp>
 #include <render3d/scene.hpp>
 
@@ -10,4 +13,51 @@ struct AppConfig {
     const char* windowTitle = "3D Engine";
     Screen screen{SCREEN_WIDTH, SCREEN_HEIGHT};
     int windowScale = 2;
+    // Estimated memory the scenes kept off screen may hold.
+    size_t sceneCacheBudget = size_t(512) << 20;
+    // Load the scenes next to the current one in the selector ahead of time.
+    bool prefetchScenes = true;
+    // Draw each frame on a render thread, from a copy of the scene, while
+    // the next one is updated and the previous one presented
+    // (RenderPipeline); toggled at run time from the UI.
+    bool pipelined = false;
+    // Upload frames by locking the streaming texture instead of
+    // SDL_UpdateTexture; toggled at run time from the UI.
+    bool lockedUpload = false;
+    // Shrink the framebuffer (down to `minResolutionScale` of `screen` on
+    // each axis) while drawing a frame takes longer than `targetRenderMs`;
+    // adjustable at run time from the UI.
+    bool dynamicResolution = false;
+    float targetRenderMs = 16.0f;
+    float minResolutionScale = 0.5f;
+
+    // Set from the command line (see main.cpp).
+    // Scene shown first, as an index into the scene selector.
+    int startScene = 0;
+    // Write the start scene's memory report as JSON to this file ("-" for
+    // stdout) and exit without opening a window.
+    std::string memoryReportPath;
+    // Render `frames` frames without a window (HeadlessRunner), stepping the
+    // scene by `fixedTimestep` seconds each.
+    bool headless = false;
+    int frames = 100;
+    float fixedTimestep = 1.0f / 60.0f;
+    // Frames written as <framePrefix>_NNNN.ppm; -1 is the last.
+    std::vector<int> savedFrames;
+    std::string framePrefix = "frame";
+    // Benchmark the scenes given with --scene (all YAML scenes when none
+    // was) with BenchRunner: `warmupFrames` untimed frames, then `frames`
+    // timed ones, reported as JSON to `benchOutput` ("-" for stdout). With a
+    // baseline report, a median or p95 frame time more than
+    // `regressionThreshold` (0.1 = 10%) slower fails the run.
+    bool bench = false;
+    std::vector<int> benchScenes;
+    int warmupFrames = 30;
+    std::string benchOutput = "-";
+    std::string baselinePath;
+    double regressionThreshold = 0.1;
+    // Chrome trace of the last Profiler::kMaxFrames frames, written on exit
+    // (any mode) and by the profiler panel's export button. Zones are only
+    // recorded in builds with ENABLE_PROFILER.
+    std::string tracePath;
 };
@@ -1,16 +1,57 @@
 #pragma once
 
 #include <render3d/scene.hpp>
+#include "scenes/dynamic_resolution.hpp"
+#include "scenes/frame_state.hpp"
+#include "scenes/memory_report.hpp"
+#include "scenes/mesh_lod.hpp"
+#include "scenes/scene_reloader.hpp"
+#include "scenes/texture_lod.hpp"
 
 #include <map>
 #include <memory>
+#include <string>
 
 
 using namespace render3d;
 
+// Last framebuffer upload to the streaming texture (Application::uploadFrame).
+struct UploadStats {
+    bool locked = false;  // through SDL_LockTexture
+    bool padded = false;  // the locked rows were wider than the framebuffer's
+    size_t bytes = 0;     // framebuffer bytes copied
+    double ms = 0.0;
+};
+
 struct AppState {
     std::unique_ptr<Scene> scene;
+    // Mip chains of the scene's diffuse maps; rebuilt with every scene.
+    TextureLod textureLod;
+    // Simplified levels of the scene's meshes; rebuilt with every scene.
+    MeshLod meshLod;
+    // Follows the YAML of the scene on screen and patches it on save.
+    SceneReloader sceneReloader;
+    // Last collection shown by the memory panel, and when (ImGui time; < 0
+    // before the first).
+    MemoryReport::Report memoryReport;
+    double memoryReportTime = -1.0;
+    // Profiler panel: kept frame shown while recording is paused (-1: the
+    // latest) and the outcome of the last trace export.
+    int profilerFrame = -1;
+    std::string profilerStatus;
+    // Frames are drawn by Application's RenderPipeline, from renderCopy: a
+    // clone of the scene the loader built with it, brought up to date by
+    // FrameState::copy() at every submit.
+    bool pipelined = false;
+    RenderCopy renderCopy;
+    bool lockedUpload = false;
+    UploadStats upload;
+    // Internal resolution of the scene on screen, fed with its draw times.
+    DynamicResolution resolution;
     std::map<int, bool> keys;
     bool closedWindow = false;
+    // Index picked in the scene selector; may still be loading.
     int currentSceneIndex = 0;
+    // Index of the scene currently shown.
+    int loadedSceneIndex = 0;
 };
@@ -1,13 +1,20 @@
 #include "application.hpp"
 
 #include "scene_ui.hpp"
+#include "assets/profiler.hpp"
+#include "scenes/frame_state.hpp"
+#include "scenes/memory_report.hpp"
 #include "scenes/scene_factory.hpp"
+#include "scenes/scene_loader.hpp"
 #include "vendor/imgui/imgui.h"
 #include "vendor/imgui/imgui_impl_sdl3.h"
 #include "vendor/imgui/imgui_impl_sdlrenderer3.h"
 
 #include <SDL3/SDL.h>
+#include <chrono>
 #include <cstdio>
+#include <cstring>
+#include <exception>
 #include <memory>
 
 
@@ -41,28 +48,100 @@ bool Application::init() {
   }
   SDL_SetRenderVSync(sdlRenderer.get(), 1);
 
-  if (!texture.create(sdlRenderer.get(), SDL_PIXELFORMAT_ARGB8888,
-                      SDL_TEXTUREACCESS_STREAMING, config.screen.width,
-                      config.screen.height)) {
-    SDL_Log("Error: SDL_CreateTexture(): %s\n", SDL_GetError());
+  if (!createTexture(config.screen)) {
     return false;
   }
-  SDL_SetTextureBlendMode(texture.get(), SDL_BLENDMODE_NONE);
   SDL_SetWindowPosition(window.get(), SDL_WINDOWPOS_CENTERED,
                         SDL_WINDOWPOS_CENTERED);
   SDL_ShowWindow(window.get());
 
   imgui.init(window.get(), sdlRenderer.get());
+  state.pipelined = config.pipelined;
+  state.lockedUpload = config.lockedUpload;
+  state.resolution.enabled = config.dynamicResolution;
+  state.resolution.targetMs = config.targetRenderMs;
+  state.resolution.minScale = config.minResolutionScale;
 
-  state.scene = SceneFactory::createSceneByIndex(state.currentSceneIndex, config.screen);
-  state.scene->setup();
+  if (!loadStartScene()) {
+    return false;
+  }
+  state.sceneReloader.track(SceneFactory::yamlPathForIndex(state.loadedSceneIndex), *state.scene);
+  sceneLoader.renderCopies = state.pipelined;
+  if (state.pipelined) {
+    // Like the start scene itself, its copy is built before the first frame,
+    // with the background its file asks for.
+    RenderCopy& copy = state.renderCopy;
+    copy.scene = FrameState::clone(*state.scene);
+    const SceneDescription& description = state.sceneReloader.description();
+    if (description.background) {
+      try {
+        SceneLoader::applyBackground(*description.background, *copy.scene);
+      } catch (const std::exception& e) {
+        std::fprintf(stderr, "Error: %s\n", e.what());
+      }
+    }
+    copy.textureLod.build(*copy.scene);
+    copy.meshLod.build(*copy.scene);
+  }
+  sceneLoader.setCacheBudget(config.sceneCacheBudget);
+  sceneLoader.prefetch = config.prefetchScenes;
+  sceneLoader.prefetchAround(state.loadedSceneIndex, config.screen, state.scene->backgroundType);
   inputHandler = std::make_unique<InputHandler>(window.get(), state.keys);
 
   return true;
 }
 
+bool Application::createTexture(Screen size) {
+  if (!texture.create(sdlRenderer.get(), SDL_PIXELFORMAT_ARGB8888,
+                      SDL_TEXTUREACCESS_STREAMING, size.width, size.height)) {
+    SDL_Log("Error: SDL_CreateTexture(): %s\n", SDL_GetError());
+    return false;
+  }
+  SDL_SetTextureBlendMode(texture.get(), SDL_BLENDMODE_NONE);
+  textureSize = size;
+  return true;
+}
+
+bool Application::loadStartScene() {
+  state.currentSceneIndex = config.startScene;
+  std::vector<SceneSnapshot::Dependency> sources;
+  state.scene = SceneFactory::createSceneByIndex(state.currentSceneIndex, config.screen,
+                                                 nullptr, &sources);
+  if (!state.scene) {
+    std::fprintf(stderr, "Error: no scene at index %d\n", state.currentSceneIndex);
+    return false;
+  }
+  state.scene->setup();
+  state.textureLod.build(*state.scene);
+  state.meshLod.build(*state.scene);
+  state.loadedSceneIndex = state.currentSceneIndex;
+  sceneLoader.adopt(state.loadedSceneIndex, std::move(sources));
+  return true;
+}
+
+int Application::writeMemoryReport() {
+  if (!loadStartScene()) {
+    return 1;
+  }
+  const std::string json = MemoryReport::toJson(
+      MemoryReport::collect(*state.scene, &state.textureLod, &state.meshLod));
+
+  const bool toStdout = config.memoryReportPath == "-";
+  FILE* file = toStdout ? stdout : std::fopen(config.memoryReportPath.c_str(), "wb");
+  if (!file) {
+    std::fprintf(stderr, "Error: cannot write %s\n", config.memoryReportPath.c_str());
+    return 1;
+  }
+  const bool written = std::fwrite(json.data(), 1, json.size(), file) == json.size();
+  if (!toStdout) {
+    std::fclose(file);
+  }
+  return written ? 0 : 1;
+}
+
 int Application::run() {
   ImGuiIO& io = ImGui::GetIO();
+  PROFILE_THREAD("Main");
 
 #ifdef __EMSCRIPTEN__
   io.IniFilename = nullptr;
@@ -77,10 +156,21 @@ int Application::run() {
   EMSCRIPTEN_MAINLOOP_END;
 #endif
 
+  if (!config.tracePath.empty() && !Profiler::writeChromeTrace(config.tracePath)) {
+    std::fprintf(stderr, "Error: cannot write %s\n", config.tracePath.c_str());
+    return 1;
+  }
   return 0;
 }
 
+// Pipelined, the render thread draws frame N from state.renderCopy while
+// this thread runs input, UI and Scene::update for frame N+1 on state.scene;
+// the two only meet in submitFrame(), which then presents frame N.
 void Application::runFrame() {
+  followPipelinedMode();
+  swapLoadedScene();
+  applyResolution();
+  reloadChangedScene();
   processInput();
 
   if (shouldPauseFrame()) {
@@ -91,11 +181,99 @@ void Application::runFrame() {
   beginUiFrame();
   drawUi();
   updateScene();
-  renderScene();
-  presentFrame();
+  if (state.pipelined && submitFrame()) {
+    const auto& front = renderPipeline.frontBuffer();
+    presentFrame(front.empty() ? nullptr : front.data(), renderPipeline.frontScreen());
+  } else {
+    renderScene();
+    presentFrame(state.scene->pixels.data(), state.scene->screen);
+  }
+  PROFILE_FRAME();
+}
+
+// Render copies come from the loader, built with each scene. Switching the
+// pipelined mode on loads the scene on screen again with one; switching it
+// off hands the copy back to the loader to free.
+void Application::followPipelinedMode() {
+  if (state.pipelined == sceneLoader.renderCopies) {
+    return;
+  }
+  sceneLoader.renderCopies = state.pipelined;
+  if (!state.pipelined) {
+    finishFrame();
+    sceneLoader.discard(nullptr, TextureLod{}, MeshLod{}, std::move(state.renderCopy));
+    state.renderCopy = RenderCopy{};
+  } else if (!state.renderCopy.scene && !sceneLoader.status().loading) {
+    sceneLoader.request(state.loadedSceneIndex, config.screen, state.scene->backgroundType);
+  }
+}
+
+// Scenes built in the background or taken from the cache replace the
+// current one here, before any input, UI or rendering work of the frame
+// touches it, together with their render copies. The outgoing scene goes to
+// the loader's cache, unless it is an older copy of the incoming one.
+void Application::swapLoadedScene() {
+  PROFILE_ZONE("Swap scene");
+  int index = 0;
+  TextureLod textureLod;
+  MeshLod meshLod;
+  RenderCopy copy;
+  if (auto scene = sceneLoader.takeReady(index, &textureLod, &meshLod, &copy)) {
+    // The render thread may still be drawing the outgoing copy.
+    finishFrame();
+    if (index != state.loadedSceneIndex) {
+      sceneLoader.retire(state.loadedSceneIndex, std::move(state.scene),
+                         std::move(state.textureLod), std::move(state.meshLod),
+                         std::move(state.renderCopy));
+    } else {
+      sceneLoader.discard(std::move(state.scene), std::move(state.textureLod),
+                          std::move(state.meshLod), std::move(state.renderCopy));
+    }
+    state.scene = std::move(scene);
+    state.textureLod = std::move(textureLod);
+    state.meshLod = std::move(meshLod);
+    state.renderCopy = std::move(copy);
+    state.loadedSceneIndex = index;
+    state.currentSceneIndex = index;
+    state.resolution.reset();
+    state.sceneReloader.track(SceneFactory::yamlPathForIndex(index), *state.scene);
+    sceneLoader.prefetchAround(index, config.screen, state.scene->backgroundType);
+  } else if (!sceneLoader.status().loading) {
+    // Cancelled or failed: point the selector back at the scene on screen.
+    state.currentSceneIndex = state.loadedSceneIndex;
+  }
+}
+
+// Sizes the scene's framebuffer to the dynamic resolution's pick. Scenes
+// are created at config.screen, the largest size it picks, so this only
+// shrinks below what render3d allocated for them.
+void Application::applyResolution() {
+  const Screen size = state.resolution.screenFor(config.screen);
+  Scene& scene = *state.scene;
+  if (scene.screen.width == size.width && scene.screen.height == size.height) {
+    return;
+  }
+  scene.screen = size;
+  scene.pixels.resize(static_cast<size_t>(size.width) * size.height);
+}
+
+// Saved edits to the scene's YAML or models are patched into the live scene
+// and its render copy. Edits it cannot map onto the scene load the file again
+// in the background.
+void Application::reloadChangedScene() {
+  PROFILE_ZONE("Hot reload");
+  SceneReloader::Result result =
+      state.sceneReloader.update(*state.scene, &state.textureLod, &state.meshLod);
+  if (result.reloaded) {
+    patchRenderCopy(result);
+  }
+  if (result.needsFullReload && !sceneLoader.status().loading) {
+    sceneLoader.request(state.loadedSceneIndex, config.screen, state.scene->backgroundType);
+  }
 }
 
 void Application::processInput() {
+  PROFILE_ZONE("Input");
   state.closedWindow = inputHandler->processEvents(state.scene);
   inputHandler->processKeyboardInput(state.scene);
 }
@@ -112,38 +290,181 @@ void Application::beginUiFrame() {
 }
 
 void Application::updateScene() {
+  PROFILE_ZONE("Update");
   ImGuiIO& io = ImGui::GetIO();
-  state.scene->update(io.DeltaTime);
+  {
+    PROFILE_ZONE("Scene::update");
+    state.scene->update(io.DeltaTime);
+  }
+  state.textureLod.update(*state.scene);
+  state.meshLod.update(*state.scene);
+}
+
+// Repeats a hot reload on the render copy, entity by entity, so it keeps
+// matching the scene without being built again. Only the chains of the
+// entities the reload rebuilt are built again in the copy's LOD.
+void Application::patchRenderCopy(const SceneReloader::Result& result) {
+  RenderCopy& copy = state.renderCopy;
+  if (!copy.scene) {
+    return;
+  }
+  PROFILE_ZONE("Patch render copy");
+  finishFrame();
+  const bool relinked = !result.rebuiltEntities.empty() || !result.removedSlots.empty();
+  if (relinked) {
+    copy.textureLod.restore(*copy.scene);
+    copy.meshLod.restore(*copy.scene);
+  }
+  const std::vector<Entity> rebuilt = FrameState::copyReload(*state.scene, *copy.scene, result);
+  const SceneDescription& description = state.sceneReloader.description();
+  if (result.backgroundChanged && description.background) {
+    try {
+      SceneLoader::applyBackground(*description.background, *copy.scene);
+    } catch (const std::exception&) {
+      // The reload of the scene on screen already reported it.
+    }
+  }
+  if (relinked) {
+    copy.textureLod.rebuild(*copy.scene, rebuilt);
+    copy.meshLod.rebuild(*copy.scene, rebuilt);
+  }
+}
+
+// Waits for the frame in flight, if any, and hands what it produced to the
+// scene on screen.
+void Application::finishFrame() {
+  if (renderPipeline.finish()) {
+    state.resolution.update(renderPipeline.stats().drawMs);
+    FrameState::copyResults(*state.renderCopy.scene, *state.scene);
+  }
+}
+
+// Waits for the frame in flight, brings the render copy up to date with the
+// scene this thread just updated and hands the copy to the render thread.
+// Returns false, and the frame is drawn on this thread instead, while the
+// scene on screen has no copy yet.
+bool Application::submitFrame() {
+  finishFrame();
+  RenderCopy& copy = state.renderCopy;
+  if (!copy.scene) {
+    return false;
+  }
+
+  {
+    PROFILE_ZONE("Copy frame state");
+    FrameState::copy(*state.scene, *copy.scene);
+    copy.textureLod.enabled = state.textureLod.enabled;
+    copy.meshLod.enabled = state.meshLod.enabled;
+    copy.textureLod.update(*copy.scene);
+    copy.meshLod.update(*copy.scene);
+  }
+  renderPipeline.submit(*copy.scene);
+  return true;
 }
 
+// render3d is not instrumented: shadow passes, background and rasterization
+// show up as one zone.
 void Application::renderScene() {
+  PROFILE_ZONE("Renderer::drawScene");
+  const auto start = std::chrono::steady_clock::now();
   solidRenderer.drawScene(*state.scene);
+  state.resolution.update(std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - start).count());
 }
 
-void Application::presentFrame() {
-  ImGui::Render();
+// The present zone includes the wait for vsync. Without pixels (the first
+// pipelined frame) the texture keeps its previous contents. The texture is
+// stretched over the whole window whatever the frame's size.
+void Application::presentFrame(const uint32_t* pixels, Screen size) {
+  PROFILE_ZONE("Present");
+  {
+    PROFILE_ZONE("ImGui::Render");
+    ImGui::Render();
+  }
+  {
+    PROFILE_ZONE("Upload framebuffer");
+    if (pixels) {
+      uploadFrame(pixels, size);
+    }
+    SDL_RenderTexture(sdlRenderer.get(), texture.get(), nullptr, nullptr);
+  }
+  {
+    PROFILE_ZONE("Draw ImGui");
+    ImGui_ImplSDLRenderer3_RenderDrawData(ImGui::GetDrawData(),
+                                          sdlRenderer.get());
+  }
+  {
+    PROFILE_ZONE("SDL_RenderPresent");
+    SDL_RenderPresent(sdlRenderer.get());
+  }
+}
 
-  SDL_UpdateTexture(texture.get(), nullptr, state.scene->pixels.data(), 4 * config.screen.width);
-  SDL_RenderTexture(sdlRenderer.get(), texture.get(), nullptr, nullptr);
+// Copies the framebuffer into the streaming texture. render3d rasterizes
+// into Scene::pixels, a vector it owns, so it cannot draw into texture
+// memory; the locked path writes the one copy straight into the memory
+// SDL_LockTexture exposes, row by row when its pitch is padded. The copy
+// through SDL_UpdateTexture is used when locking is off, fails, or the
+// texture is not ARGB8888. The texture is recreated when the dynamic
+// resolution changed the frame's size.
+void Application::uploadFrame(const uint32_t* pixels, Screen size) {
+  if ((size.width != textureSize.width || size.height != textureSize.height) &&
+      !createTexture(size)) {
+    return;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  const int width = size.width;
+  const int height = size.height;
+  const size_t rowBytes = sizeof(uint32_t) * width;
 
-  ImGui_ImplSDLRenderer3_RenderDrawData(ImGui::GetDrawData(),
-                                        sdlRenderer.get());
-  SDL_RenderPresent(sdlRenderer.get());
+  UploadStats& upload = state.upload;
+  upload.locked = false;
+  upload.padded = false;
+  void* target = nullptr;
+  int pitch = 0;
+  if (state.lockedUpload && texture.get()->format == SDL_PIXELFORMAT_ARGB8888 &&
+      SDL_LockTexture(texture.get(), nullptr, &target, &pitch)) {
+    if (static_cast<size_t>(pitch) == rowBytes) {
+      std::memcpy(target, pixels, rowBytes * height);
+    } else {
+      auto* row = static_cast<unsigned char*>(target);
+      for (int y = 0; y < height; ++y, row += pitch) {
+        std::memcpy(row, pixels + static_cast<size_t>(y) * width, rowBytes);
+      }
+      upload.padded = true;
+    }
+    SDL_UnlockTexture(texture.get());
+    upload.locked = true;
+  } else {
+    SDL_UpdateTexture(texture.get(), nullptr, pixels, static_cast<int>(rowBytes));
+  }
+  upload.bytes = rowBytes * height;
+  upload.ms = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - start).count();
 }
 
 void Application::drawUi() {
+  PROFILE_ZONE("UI");
   ImGuiIO& io = ImGui::GetIO();
 
   ImGui::Begin("3d params");
   SceneUI::drawCameraControls(*state.scene);
   SceneUI::drawSolidControls(*state.scene);
-  SceneUI::drawSceneSelector(state, config.screen);
+  SceneUI::drawSceneSelector(state, sceneLoader, config.screen);
   SceneUI::drawSceneControls(*state.scene);
 
   ImGui::Text("Application average %.3f ms/frame (%.1f FPS)",
               1000.0f / io.Framerate, io.Framerate);
   SceneUI::drawCameraInfo(*state.scene);
+  SceneUI::drawPipeline(state, renderPipeline);
+  SceneUI::drawUpload(state);
+  SceneUI::drawResolution(state, config.screen);
   SceneUI::drawStats(*state.scene);
+  SceneUI::drawTextureLod(state.textureLod);
+  SceneUI::drawMeshLod(state.meshLod);
+  SceneUI::drawSceneCache(sceneLoader);
+  SceneUI::drawHotReload(state.sceneReloader);
+  SceneUI::drawMemory(state, sceneLoader);
+  SceneUI::drawProfiler(state, config.tracePath.empty() ? "trace.json" : config.tracePath);
 
   ImGui::End();
 }
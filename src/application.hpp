@@ -4,6 +4,8 @@
 #include "app_state.hpp"
 #include "input_handler.hpp"
 #include "platform_resources.hpp"
+#include "render_pipeline.hpp"
+#include "scenes/async_scene_loader.hpp"
 #include <render3d/renderer.hpp>
 
 #include <memory>
@@ -13,7 +15,7 @@ using namespace render3d;
 
 class Application {
 public:
-  Application() = default;
+  explicit Application(const AppConfig& config = AppConfig{}) : config(config) {}
   ~Application();
 
   Application(const Application&) = delete;
@@ -22,20 +24,35 @@ public:
   bool init();
   int run();
 
+  // Headless: loads the start scene and writes its memory report to
+  // config.memoryReportPath. Returns the process exit code.
+  int writeMemoryReport();
+
 private:
+  bool loadStartScene();
+  bool createTexture(Screen size);
+  void followPipelinedMode();
+  void swapLoadedScene();
+  void applyResolution();
+  void reloadChangedScene();
   void processInput();
   bool shouldPauseFrame() const;
   void beginUiFrame();
   void drawUi();
   void updateScene();
   void renderScene();
-  void presentFrame();
+  void patchRenderCopy(const SceneReloader::Result& result);
+  void finishFrame();
+  bool submitFrame();
+  void uploadFrame(const uint32_t* pixels, Screen size);
+  void presentFrame(const uint32_t* pixels, Screen size);
   void runFrame();
 
   SdlContext sdl;
   SdlWindow window;
   SdlRenderer sdlRenderer;
   SdlTexture texture;
+  Screen textureSize{0, 0};
   ImguiContext imgui;
 
   Renderer solidRenderer;
@@ -43,4 +60,7 @@ private:
 
   AppConfig config;
   AppState state;
+  AsyncSceneLoader sceneLoader;
+  // Declared after the state it draws so it stops before the scene goes.
+  RenderPipeline renderPipeline{solidRenderer};
 };
@@ -0,0 +1,196 @@
+#include "asc_parser.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+#include "mapped_file.hpp"
+
+namespace {
+
+    inline bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v';
+    }
+    inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+    inline bool isNumberChar(char c) { return isDigit(c) || c == '-' || c == '.' || c == 'E' || c == 'e'; }
+
+    // Consumes one or more whitespace characters.
+    bool skipRequiredSpace(const char*& p, const char* end) {
+        const char* start = p;
+        while (p < end && isSpace(*p)) ++p;
+        return p != start;
+    }
+
+    bool consume(const char*& p, const char* end, std::string_view literal) {
+        if (static_cast<size_t>(end - p) < literal.size() ||
+            std::memcmp(p, literal.data(), literal.size()) != 0) {
+            return false;
+        }
+        p += literal.size();
+        return true;
+    }
+
+    bool skipDigits(const char*& p, const char* end) {
+        const char* start = p;
+        while (p < end && isDigit(*p)) ++p;
+        return p != start;
+    }
+
+    // Parses the longest float prefix of [first, last), as std::stof did for
+    // the regex captures. Both round correctly, so the values are identical.
+    bool toFloat(const char* first, const char* last, float& out) {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        return std::from_chars(first, last, out).ec == std::errc();
+#else
+        char buffer[64];
+        size_t length = std::min<size_t>(last - first, sizeof(buffer) - 1);
+        std::memcpy(buffer, first, length);
+        buffer[length] = '\0';
+        char* parsed = nullptr;
+        out = std::strtof(buffer, &parsed);
+        return parsed != buffer;
+#endif
+    }
+
+    // `<label>` then whitespace, then a run of [-.0-9Ee] converted to float.
+    bool parseCoordinate(const char*& p, const char* end, std::string_view label, float& out) {
+        if (!consume(p, end, label) || !skipRequiredSpace(p, end)) {
+            return false;
+        }
+        const char* start = p;
+        while (p < end && isNumberChar(*p)) ++p;
+        return p != start && toFloat(start, p, out);
+    }
+
+    // `<label>` immediately followed by decimal digits.
+    bool parseIndex(const char*& p, const char* end, std::string_view label, int& out) {
+        if (!consume(p, end, label)) {
+            return false;
+        }
+        const char* start = p;
+        if (!skipDigits(p, end)) {
+            return false;
+        }
+        return std::from_chars(start, p, out).ec == std::errc();
+    }
+
+    // Vertex\s+\d+:\s+X:\s+<f>\s+Y:\s+<f>\s+Z:\s+<f>, anchored at p.
+    bool matchVertex(const char* p, const char* end, VertexData& vertex) {
+        float x, y, z;
+        if (!consume(p, end, "Vertex") || !skipRequiredSpace(p, end) ||
+            !skipDigits(p, end) || !consume(p, end, ":") || !skipRequiredSpace(p, end) ||
+            !parseCoordinate(p, end, "X:", x) || !skipRequiredSpace(p, end) ||
+            !parseCoordinate(p, end, "Y:", y) || !skipRequiredSpace(p, end) ||
+            !parseCoordinate(p, end, "Z:", z)) {
+            return false;
+        }
+        vertex.vertex = {x, y, z};
+        return true;
+    }
+
+    // Face\s+\d+:\s+A:\d+\s+B:\d+\s+C:\d+, anchored at p.
+    bool matchFace(const char* p, const char* end, int (&indices)[3]) {
+        return consume(p, end, "Face") && skipRequiredSpace(p, end) &&
+               skipDigits(p, end) && consume(p, end, ":") && skipRequiredSpace(p, end) &&
+               parseIndex(p, end, "A:", indices[0]) && skipRequiredSpace(p, end) &&
+               parseIndex(p, end, "B:", indices[1]) && skipRequiredSpace(p, end) &&
+               parseIndex(p, end, "C:", indices[2]);
+    }
+
+    // Like regex_search: tries every occurrence of `keyword` in the line.
+    template <typename Match>
+    bool searchLine(std::string_view line, std::string_view keyword, Match&& match) {
+        for (size_t at = line.find(keyword); at != std::string_view::npos;
+             at = line.find(keyword, at + 1)) {
+            if (match(line.data() + at, line.data() + line.size())) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Reads N from "... <label> N" for the Tri-mesh header, 0 if absent.
+    size_t headerCount(std::string_view line, std::string_view label) {
+        size_t at = line.find(label);
+        if (at == std::string_view::npos) {
+            return 0;
+        }
+        const char* p = line.data() + at + label.size();
+        const char* end = line.data() + line.size();
+        while (p < end && isSpace(*p)) ++p;
+        size_t count = 0;
+        std::from_chars(p, end, count);
+        return count;
+    }
+}
+
+namespace AscParser {
+
+bool parse(const std::string& filename, Result& result) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        return false;
+    }
+    parse(file.data(), file.size(), result);
+    return true;
+}
+
+void parse(const char* data, size_t size, Result& result) {
+    bool readingVertices = false;
+    bool readingFaces = false;
+
+    const char* cursor = data;
+    const char* end = data + size;
+    while (cursor < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+        if (!lineEnd) lineEnd = end;
+        std::string_view line(cursor, lineEnd - cursor);
+        cursor = lineEnd + (lineEnd < end ? 1 : 0);
+
+        while (!line.empty() && isSpace(line.front())) line.remove_prefix(1);
+        while (!line.empty() && isSpace(line.back())) line.remove_suffix(1);
+        if (line.empty()) {
+            continue;
+        }
+
+        if (line.find("Tri-mesh,") != std::string_view::npos) {
+            result.vertices.reserve(result.vertices.size() + headerCount(line, "Vertices:"));
+            result.faces.reserve(result.faces.size() + headerCount(line, "Faces:"));
+        }
+
+        if (line.find("Vertex list:") != std::string_view::npos) {
+            readingVertices = true;
+            readingFaces = false;
+            continue;
+        }
+
+        if (line.find("Face list:") != std::string_view::npos) {
+            readingVertices = false;
+            readingFaces = true;
+            continue;
+        }
+
+        if (readingVertices) {
+            VertexData vertex;
+            if (searchLine(line, "Vertex", [&](const char* p, const char* e) {
+                    return matchVertex(p, e, vertex);
+                })) {
+                result.vertices.push_back(vertex);
+            }
+        }
+
+        if (readingFaces) {
+            int indices[3];
+            if (searchLine(line, "Face", [&](const char* p, const char* e) {
+                    return matchFace(p, e, indices);
+                })) {
+                FaceData& face = result.faces.emplace_back();
+                face.face.vertexIndices.assign(indices, indices + 3);
+            }
+        }
+    }
+}
+
+} // namespace AscParser
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <render3d/ecs/mesh_component.hpp>
+
+// Streaming reader for 3D Studio ASCII (.asc) meshes. Scans the mapped file
+// line by line without copying or regular expressions, and reserves the
+// vertex and face arrays from the "Tri-mesh, Vertices: N Faces: M" headers.
+//
+// Accepts the same lines the former regex importer did:
+//   Vertex <n>: X: <x> Y: <y> Z: <z>      (inside a "Vertex list:" section)
+//   Face <n>: A:<a> B:<b> C:<c> ...       (inside a "Face list:" section)
+// Vertices of every object are appended to one list and face indices are
+// kept as written, so multi-object files load exactly as before.
+
+using namespace render3d;
+
+namespace AscParser {
+
+    struct Result {
+        std::vector<VertexData> vertices;
+        // Faces carry materialKey, which the caller fills in.
+        std::vector<FaceData> faces;
+    };
+
+    bool parse(const std::string& filename, Result& result);
+    void parse(const char* data, size_t size, Result& result);
+
+} // namespace AscParser
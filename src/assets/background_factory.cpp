@@ -1,6 +1,9 @@
 #include "background_factory.hpp"
 
+#include <chrono>
 #include <cstdio>
+#include <map>
+#include <mutex>
 #include <utility>
 #include <vector>
 
@@ -11,12 +14,48 @@
 #include <render3d/backgrounds/hdr_panorama.hpp>
 #include "texture_loader.hpp"
 #include "cubemap_loader.hpp"
+#include "hdr_cache.hpp"
 
 #include "../vendor/nothings/stb_image.h"
 
 
 using namespace render3d;
 
+namespace {
+
+    // Panorama recorded for each scene by setBackground(). Entries of
+    // destroyed scenes are overwritten or erased when their address is
+    // given a background again.
+    std::mutex statsMutex;
+    std::map<const Scene*, BackgroundFactory::HdrStats> sceneHdrStats;
+
+    // The last panorama createHdrPanorama() made on this thread, matched
+    // to the scene it is handed to by setBackground().
+    thread_local const Background* lastHdr = nullptr;
+    thread_local BackgroundFactory::HdrStats lastHdrStats;
+
+    // Decodes the .hdr with stb_image and shrinks it to maxWidth.
+    bool decodeHdr(const std::string& path, int maxWidth, HdrCache::CompactImage& compact,
+                   std::vector<float>& pixels) {
+        int width = 0, height = 0, channels = 0;
+        float* data = stbi_loadf(path.c_str(), &width, &height, &channels, 3);
+        if (!data) {
+            std::fprintf(stderr, "HdrPanorama: failed to load '%s': %s\n",
+                         path.c_str(), stbi_failure_reason());
+            return false;
+        }
+        pixels.assign(data, data + static_cast<size_t>(width) * height * 3);
+        stbi_image_free(data);
+
+        compact.sourceWidth = width;
+        compact.sourceHeight = height;
+        HdrCache::shrinkToWidth(pixels, width, height, maxWidth);
+        compact.width = width;
+        compact.height = height;
+        return true;
+    }
+}
+
 namespace BackgroundFactory {
 
 std::unique_ptr<Background> createSkybox(const std::string& px, const std::string& nx,
@@ -25,17 +64,62 @@ std::unique_ptr<Background> createSkybox(const std::string& px, const std::strin
     return std::make_unique<Skybox>(CubeMapLoader::load(px, nx, py, ny, pz, nz));
 }
 
-std::unique_ptr<Background> createHdrPanorama(const std::string& path) {
-    int width = 0, height = 0, channels = 0;
-    float* data = stbi_loadf(path.c_str(), &width, &height, &channels, 3);
-    if (!data) {
-        std::fprintf(stderr, "HdrPanorama: failed to load '%s': %s\n",
-                     path.c_str(), stbi_failure_reason());
+std::unique_ptr<Background> createHdrPanorama(const std::string& path, const HdrOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+
+    const uint64_t stamp = options.useCache ? HdrCache::sourceStamp(path) : 0;
+    const std::string cachePath = HdrCache::cachePathFor(path);
+    HdrCache::CompactImage compact;
+    std::vector<float> pixels;
+    bool fromCache = false;
+
+    if (stamp != 0 && HdrCache::load(cachePath, stamp, options.maxWidth, compact)) {
+        pixels = HdrCache::expand(compact);
+        fromCache = true;
+    } else if (decodeHdr(path, options.maxWidth, compact, pixels)) {
+        if (stamp != 0) {
+            HdrCache::CompactImage encoded = HdrCache::compress(pixels.data(), compact.width, compact.height);
+            encoded.sourceWidth = compact.sourceWidth;
+            encoded.sourceHeight = compact.sourceHeight;
+            HdrCache::save(cachePath, stamp, options.maxWidth, encoded);
+        }
+    } else {
         return std::make_unique<HdrPanorama>();
     }
-    std::vector<float> pixels(data, data + static_cast<size_t>(width) * height * 3);
-    stbi_image_free(data);
-    return std::make_unique<HdrPanorama>(width, height, std::move(pixels));
+
+    HdrStats stats;
+    stats.path = path;
+    stats.sourceWidth = compact.sourceWidth;
+    stats.sourceHeight = compact.sourceHeight;
+    stats.width = compact.width;
+    stats.height = compact.height;
+    stats.sourceBytes = static_cast<size_t>(compact.sourceWidth) * compact.sourceHeight * 3 * sizeof(float);
+    stats.residentBytes = pixels.size() * sizeof(float);
+    stats.compactBytes = static_cast<size_t>(compact.width) * compact.height * 4;
+    stats.loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stats.fromCache = fromCache;
+
+    auto panorama = std::make_unique<HdrPanorama>(compact.width, compact.height, std::move(pixels));
+    lastHdr = panorama.get();
+    lastHdrStats = std::move(stats);
+    return panorama;
+}
+
+void setBackground(Scene& scene, std::unique_ptr<Background> background) {
+    const bool isHdr = background && background.get() == lastHdr;
+    scene.setBackground(std::move(background));
+    std::lock_guard<std::mutex> lock(statsMutex);
+    if (isHdr) {
+        sceneHdrStats[&scene] = lastHdrStats;
+    } else {
+        sceneHdrStats.erase(&scene);
+    }
+}
+
+HdrStats hdrStatsFor(const Scene& scene) {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    auto it = sceneHdrStats.find(&scene);
+    return it != sceneHdrStats.end() ? it->second : HdrStats{};
 }
 
 std::unique_ptr<Background> create(BackgroundType type) {
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <render3d/backgrounds/background.hpp>
+#include <render3d/scene.hpp>
 
 // Application-side construction of backgrounds. This is where the files a
 // background needs (skybox faces, HDR panorama, image/twister textures) are
@@ -21,7 +23,40 @@ namespace BackgroundFactory {
                                              const std::string& py, const std::string& ny,
                                              const std::string& pz, const std::string& nz);
 
+    struct HdrOptions {
+        // Halve the panorama until it is at most this wide; 0 keeps full size.
+        int maxWidth = 0;
+        // Read/write the RGBE sidecar (see HdrCache) instead of always
+        // decoding the .hdr.
+        bool useCache = true;
+    };
+
+    // What createHdrPanorama() loaded, for the stats and memory panels.
+    struct HdrStats {
+        std::string path;
+        int sourceWidth = 0;
+        int sourceHeight = 0;
+        int width = 0;
+        int height = 0;
+        size_t sourceBytes = 0;    // float RGB at the file's resolution
+        size_t residentBytes = 0;  // float RGB handed to the panorama
+        size_t compactBytes = 0;   // RGBE size of the same texels
+        double loadMs = 0.0;
+        bool fromCache = false;
+    };
+
     // Equirectangular HDR panorama from an .hdr file path.
-    std::unique_ptr<Background> createHdrPanorama(const std::string& path);
+    std::unique_ptr<Background> createHdrPanorama(const std::string& path,
+                                                  const HdrOptions& options = {});
+
+    // Gives `scene` its background and records the panorama it holds, if
+    // the background came from createHdrPanorama() on this thread. Scenes
+    // are loaded in the background and prefetched, so the last panorama
+    // loaded is often not the one on screen; hdrStatsFor() tells them apart.
+    void setBackground(Scene& scene, std::unique_ptr<Background> background);
+
+    // The panorama recorded for `scene` by setBackground(); an empty path
+    // when its background is not one.
+    HdrStats hdrStatsFor(const Scene& scene);
 
 } // namespace BackgroundFactory
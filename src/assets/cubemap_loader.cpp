@@ -0,0 +1,112 @@
+#include "cubemap_loader.hpp"
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "parallel_for.hpp"
+#include "texture_loader.hpp"
+
+
+using namespace render3d;
+
+namespace {
+
+    using FacePaths = std::array<std::string, 6>;
+
+    struct Entry {
+        std::shared_ptr<const CubeMap> cubemap;
+        size_t bytes = 0;
+    };
+
+    std::mutex memoMutex;
+    std::map<FacePaths, Entry> memo;
+    CubeMapLoader::Stats counters;
+
+    void recordLoad(double ms, bool memoized) {
+        counters.lastLoadMs = ms;
+        counters.lastWasMemoized = memoized;
+        if (memoized) {
+            ++counters.hits;
+        } else {
+            ++counters.misses;
+        }
+    }
+
+}
+
+namespace CubeMapLoader {
+
+CubeMap load(const std::string& px, const std::string& nx,
+             const std::string& py, const std::string& ny,
+             const std::string& pz, const std::string& nz) {
+    auto start = std::chrono::steady_clock::now();
+    auto elapsedMs = [&start]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // Indexed by CubeMapFace.
+    FacePaths paths;
+    paths[static_cast<int>(CubeMapFace::POSITIVE_X)] = px;
+    paths[static_cast<int>(CubeMapFace::NEGATIVE_X)] = nx;
+    paths[static_cast<int>(CubeMapFace::POSITIVE_Y)] = py;
+    paths[static_cast<int>(CubeMapFace::NEGATIVE_Y)] = ny;
+    paths[static_cast<int>(CubeMapFace::POSITIVE_Z)] = pz;
+    paths[static_cast<int>(CubeMapFace::NEGATIVE_Z)] = nz;
+
+    {
+        std::lock_guard<std::mutex> lock(memoMutex);
+        auto it = memo.find(paths);
+        if (it != memo.end()) {
+            CubeMap cubemap = *it->second.cubemap;
+            recordLoad(elapsedMs(), true);
+            return cubemap;
+        }
+    }
+
+    // Faces bypass the TextureCache: the memo below already keeps them, and
+    // a second decoded copy per face would only double the memory.
+    std::array<Texture, 6> faces;
+    std::array<size_t, 6> faceBytes{};
+    Parallel::forEach(faces.size(), [&](size_t face) {
+        faces[face] = TextureLoader::decode(paths[face], TextureFilter::BILINEAR, &faceBytes[face]);
+    });
+
+    size_t bytes = 0;
+    bool complete = true;
+    for (size_t decoded : faceBytes) {
+        bytes += decoded;
+        complete = complete && decoded > 0;
+    }
+
+    CubeMap cubemap;
+    cubemap.setFaces(std::move(faces));
+
+    std::lock_guard<std::mutex> lock(memoMutex);
+    if (complete) {
+        Entry entry{std::make_shared<const CubeMap>(cubemap), bytes};
+        if (memo.insert({paths, std::move(entry)}).second) {
+            counters.bytes += bytes;
+        }
+    }
+    recordLoad(elapsedMs(), false);
+    return cubemap;
+}
+
+Stats stats() {
+    std::lock_guard<std::mutex> lock(memoMutex);
+    Stats result = counters;
+    result.entries = memo.size();
+    return result;
+}
+
+void clear() {
+    std::lock_guard<std::mutex> lock(memoMutex);
+    memo.clear();
+    counters = {};
+}
+
+} // namespace CubeMapLoader
@@ -0,0 +1,166 @@
+#include "file_watcher.hpp"
+
+#include <filesystem>
+#include <set>
+
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#define FILE_WATCHER_INOTIFY 1
+#endif
+
+namespace {
+
+    std::string normalize(const std::string& path) {
+        std::error_code ec;
+        std::filesystem::path absolute = std::filesystem::absolute(path, ec);
+        if (ec) {
+            return path;
+        }
+        return absolute.lexically_normal().string();
+    }
+
+}
+
+FileWatcher::FileWatcher() {
+#ifdef FILE_WATCHER_INOTIFY
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef FILE_WATCHER_INOTIFY
+    if (inotifyFd >= 0) {
+        close(inotifyFd);
+    }
+#endif
+}
+
+void FileWatcher::setFiles(const std::vector<std::string>& paths) {
+    files.clear();
+    stamps.clear();
+    pending.clear();
+    for (const auto& path : paths) {
+        files[normalize(path)] = path;
+    }
+
+#ifdef FILE_WATCHER_INOTIFY
+    if (inotifyFd >= 0) {
+        for (const auto& [wd, directory] : directories) {
+            inotify_rm_watch(inotifyFd, wd);
+        }
+        directories.clear();
+
+        std::set<std::string> wanted;
+        for (const auto& [normalized, path] : files) {
+            wanted.insert(std::filesystem::path(normalized).parent_path().string());
+        }
+        for (const auto& directory : wanted) {
+            int wd = inotify_add_watch(inotifyFd, directory.c_str(),
+                                       IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+            if (wd >= 0) {
+                directories[wd] = directory;
+            }
+        }
+        // Drop events queued for the previous set.
+        readEvents();
+        pending.clear();
+        return;
+    }
+#endif
+
+#ifndef __EMSCRIPTEN__
+    for (const auto& [normalized, path] : files) {
+        stamps[normalized] = stampOf(normalized);
+    }
+    lastStampPoll = Clock::now();
+#endif
+}
+
+std::vector<std::string> FileWatcher::poll() {
+    if (usesInotify()) {
+        readEvents();
+    } else {
+        pollStamps();
+    }
+
+    std::vector<std::string> changed;
+    const Clock::time_point now = Clock::now();
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (now - it->second >= kSettle) {
+            changed.push_back(files[it->first]);
+            it = pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return changed;
+}
+
+FileWatcher::Stamp FileWatcher::stampOf(const std::string& path) {
+    Stamp stamp;
+    std::error_code ec;
+    stamp.size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return {};
+    }
+    auto modified = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return {};
+    }
+    stamp.exists = true;
+    stamp.modified = static_cast<int64_t>(modified.time_since_epoch().count());
+    return stamp;
+}
+
+void FileWatcher::readEvents() {
+#ifdef FILE_WATCHER_INOTIFY
+    alignas(inotify_event) char buffer[4096];
+    for (;;) {
+        ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            return;
+        }
+        const Clock::time_point now = Clock::now();
+        for (ssize_t offset = 0; offset < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                // Events were lost: treat every file as changed.
+                for (const auto& [normalized, path] : files) {
+                    pending[normalized] = now;
+                }
+                continue;
+            }
+            auto directory = directories.find(event->wd);
+            if (directory == directories.end() || event->len == 0) {
+                continue;
+            }
+            std::string path = (std::filesystem::path(directory->second) / event->name).string();
+            if (files.count(path)) {
+                pending[path] = now;
+            }
+        }
+    }
+#endif
+}
+
+void FileWatcher::pollStamps() {
+#ifndef __EMSCRIPTEN__
+    const Clock::time_point now = Clock::now();
+    if (now - lastStampPoll < kPollInterval) {
+        return;
+    }
+    lastStampPoll = now;
+    for (auto& [normalized, stamp] : stamps) {
+        Stamp current = stampOf(normalized);
+        if (current.exists != stamp.exists || current.size != stamp.size ||
+            current.modified != stamp.modified) {
+            stamp = current;
+            // Polling already spaces out reads, so no need to wait further.
+            pending[normalized] = now - kSettle;
+        }
+    }
+#endif
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Reports changes to a set of files. On Linux it listens to inotify events
+// on the files' directories, which also catches editors that save by
+// writing a temporary file and renaming it over the original. Elsewhere it
+// compares size and modification time a few times per second. Emscripten
+// builds have no files that change behind the app's back and watch nothing.
+//
+// A file is reported once its events have been quiet for kSettle, so a save
+// that arrives as several writes turns into one change.
+
+class FileWatcher {
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Replaces the watched set. Files that do not exist yet are watched for
+    // their creation.
+    void setFiles(const std::vector<std::string>& paths);
+
+    // Files changed since the last call, spelled as they were passed to
+    // setFiles(). Never blocks.
+    std::vector<std::string> poll();
+
+    bool usesInotify() const { return inotifyFd >= 0; }
+
+    static constexpr std::chrono::milliseconds kSettle{15};
+    static constexpr std::chrono::milliseconds kPollInterval{250};
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stamp {
+        bool exists = false;
+        uint64_t size = 0;
+        int64_t modified = 0;
+    };
+
+    static Stamp stampOf(const std::string& path);
+    void readEvents();
+    void pollStamps();
+
+    // Normalized absolute path -> path as given.
+    std::map<std::string, std::string> files;
+    std::map<std::string, Stamp> stamps;
+    std::map<std::string, Clock::time_point> pending;
+    Clock::time_point lastStampPoll{};
+
+    int inotifyFd = -1;
+    // inotify watch descriptor -> normalized directory.
+    std::map<int, std::string> directories;
+};
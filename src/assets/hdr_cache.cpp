@@ -0,0 +1,259 @@
+#include "hdr_cache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "mapped_file.hpp"
+#include "parallel_for.hpp"
+
+namespace {
+
+    constexpr char MAGIC[8] = {'R', '3', 'D', 'H', 'D', 'R', '\0', '\0'};
+    constexpr uint32_t BYTE_ORDER_MARK = 0x01020304u;
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t sourceStamp;
+        int32_t maxWidth;
+        int32_t width;
+        int32_t height;
+        int32_t sourceWidth;
+        int32_t sourceHeight;
+        uint32_t reserved;
+    };
+
+    std::atomic<bool> cacheEnabled{true};
+
+    // Rows handed to one worker at a time when converting whole images.
+    constexpr size_t kRowsPerBand = 16;
+
+    template <typename Fn>
+    void forEachRowBand(int height, Fn&& fn) {
+        size_t bands = (static_cast<size_t>(height) + kRowsPerBand - 1) / kRowsPerBand;
+        Parallel::forEach(bands, [&](size_t band) {
+            int y0 = static_cast<int>(band * kRowsPerBand);
+            fn(y0, std::min(height, y0 + static_cast<int>(kRowsPerBand)));
+        });
+    }
+
+    std::vector<float> halve(const std::vector<float>& rgb, int width, int height,
+                             int& outWidth, int& outHeight) {
+        outWidth = std::max(1, width / 2);
+        outHeight = std::max(1, height / 2);
+        std::vector<float> out(static_cast<size_t>(outWidth) * outHeight * 3);
+        const int w = outWidth;
+        const int h = outHeight;
+        forEachRowBand(h, [&](int y0, int y1) {
+            for (int y = y0; y < y1; ++y) {
+                int sy0 = y * 2;
+                int sy1 = std::min(height, sy0 + 2);
+                for (int x = 0; x < w; ++x) {
+                    int sx0 = x * 2;
+                    int sx1 = std::min(width, sx0 + 2);
+                    float sum[3] = {0.0f, 0.0f, 0.0f};
+                    for (int sy = sy0; sy < sy1; ++sy) {
+                        for (int sx = sx0; sx < sx1; ++sx) {
+                            const float* p = &rgb[(static_cast<size_t>(sy) * width + sx) * 3];
+                            sum[0] += p[0];
+                            sum[1] += p[1];
+                            sum[2] += p[2];
+                        }
+                    }
+                    float scale = 1.0f / static_cast<float>((sy1 - sy0) * (sx1 - sx0));
+                    float* o = &out[(static_cast<size_t>(y) * w + x) * 3];
+                    o[0] = sum[0] * scale;
+                    o[1] = sum[1] * scale;
+                    o[2] = sum[2] * scale;
+                }
+            }
+        });
+        return out;
+    }
+}
+
+namespace HdrCache {
+
+void encodeRgbe(float r, float g, float b, uint8_t out[4]) {
+    r = std::max(r, 0.0f);
+    g = std::max(g, 0.0f);
+    b = std::max(b, 0.0f);
+    float largest = std::max(r, std::max(g, b));
+    if (largest < 1e-32f) {
+        out[0] = out[1] = out[2] = out[3] = 0;
+        return;
+    }
+    int exponent = 0;
+    float scale = std::frexp(largest, &exponent) * 256.0f / largest;
+    out[0] = static_cast<uint8_t>(std::min(255.0f, r * scale));
+    out[1] = static_cast<uint8_t>(std::min(255.0f, g * scale));
+    out[2] = static_cast<uint8_t>(std::min(255.0f, b * scale));
+    out[3] = static_cast<uint8_t>(std::clamp(exponent + 128, 1, 255));
+}
+
+void decodeRgbe(const uint8_t in[4], float& r, float& g, float& b) {
+    if (in[3] == 0) {
+        r = g = b = 0.0f;
+        return;
+    }
+    // Same scaling as stb_image's RGBE decoder, so round trips are exact.
+    float scale = std::ldexp(1.0f, static_cast<int>(in[3]) - (128 + 8));
+    r = in[0] * scale;
+    g = in[1] * scale;
+    b = in[2] * scale;
+}
+
+CompactImage compress(const float* rgb, int width, int height) {
+    CompactImage image;
+    image.width = width;
+    image.height = height;
+    image.sourceWidth = width;
+    image.sourceHeight = height;
+    image.rgbe.resize(static_cast<size_t>(width) * height * 4);
+    forEachRowBand(height, [&](int y0, int y1) {
+        for (size_t i = static_cast<size_t>(y0) * width; i < static_cast<size_t>(y1) * width; ++i) {
+            encodeRgbe(rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2], &image.rgbe[i * 4]);
+        }
+    });
+    return image;
+}
+
+std::vector<float> expand(const CompactImage& image) {
+    std::vector<float> rgb(static_cast<size_t>(image.width) * image.height * 3);
+    const size_t width = static_cast<size_t>(image.width);
+    forEachRowBand(image.height, [&](int y0, int y1) {
+        for (size_t i = y0 * width; i < y1 * width; ++i) {
+            decodeRgbe(&image.rgbe[i * 4], rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]);
+        }
+    });
+    return rgb;
+}
+
+void shrinkToWidth(std::vector<float>& rgb, int& width, int& height, int maxWidth) {
+    if (maxWidth <= 0) {
+        return;
+    }
+    while (width > maxWidth && width > 1) {
+        int w = 0;
+        int h = 0;
+        rgb = halve(rgb, width, height, w, h);
+        width = w;
+        height = h;
+    }
+}
+
+uint64_t sourceStamp(const std::string& sourcePath) {
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(sourcePath, ec);
+    if (ec) {
+        return 0;
+    }
+    auto modified = std::filesystem::last_write_time(sourcePath, ec);
+    if (ec) {
+        return 0;
+    }
+    uint64_t ticks = static_cast<uint64_t>(modified.time_since_epoch().count());
+    return (size * 0x9E3779B97F4A7C15ull) ^ ticks;
+}
+
+std::string cachePathFor(const std::string& sourcePath) {
+    return sourcePath + ".r3dhdr";
+}
+
+bool load(const std::string& cachePath, uint64_t sourceStamp, int maxWidth,
+          CompactImage& image) {
+    if (!isEnabled() || sourceStamp == 0) {
+        return false;
+    }
+
+    MappedFile file;
+    if (!file.open(cachePath) || file.size() < sizeof(FileHeader)) {
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.version != FORMAT_VERSION ||
+        header.byteOrder != BYTE_ORDER_MARK ||
+        header.sourceStamp != sourceStamp ||
+        header.maxWidth != maxWidth ||
+        header.width <= 0 || header.height <= 0) {
+        return false;
+    }
+
+    const size_t texelBytes = static_cast<size_t>(header.width) * header.height * 4;
+    if (file.size() != sizeof(FileHeader) + texelBytes) {
+        return false;
+    }
+
+    image.width = header.width;
+    image.height = header.height;
+    image.sourceWidth = header.sourceWidth;
+    image.sourceHeight = header.sourceHeight;
+    image.rgbe.assign(file.data() + sizeof(FileHeader), file.data() + file.size());
+    return true;
+}
+
+bool save(const std::string& cachePath, uint64_t sourceStamp, int maxWidth,
+          const CompactImage& image) {
+    if (!isEnabled() || sourceStamp == 0) {
+        return false;
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.sourceStamp = sourceStamp;
+    header.maxWidth = maxWidth;
+    header.width = image.width;
+    header.height = image.height;
+    header.sourceWidth = image.sourceWidth;
+    header.sourceHeight = image.sourceHeight;
+
+    // Same temp-and-rename scheme as the mesh cache.
+    std::string tempPath = tempPathFor(cachePath);
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            std::cerr << "HDR cache: cannot write " << cachePath << "\n";
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(image.rgbe.data()),
+                  static_cast<std::streamsize>(image.rgbe.size()));
+        if (!out) {
+            std::cerr << "HDR cache: failed writing " << cachePath << "\n";
+            out.close();
+            std::error_code ignored;
+            std::filesystem::remove(tempPath, ignored);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec) {
+        std::cerr << "HDR cache: cannot replace " << cachePath << ": " << ec.message() << "\n";
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+void setEnabled(bool enabled) {
+    cacheEnabled = enabled;
+}
+
+bool isEnabled() {
+    return cacheEnabled;
+}
+
+} // namespace HdrCache
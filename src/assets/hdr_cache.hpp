@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Compact storage for HDR panoramas. Texels are kept as shared-exponent RGBE
+// (8-bit mantissas plus one common exponent, 4 bytes instead of 12 for float
+// RGB). .hdr files are RGBE already, so converting their decoded floats back
+// is lossless.
+//
+// The first load of an .hdr writes "<file>.r3dhdr" next to it holding the
+// (optionally downsized) RGBE image; later loads map that file and expand it
+// in parallel instead of running stb_image's RLE decoder again. The sidecar is
+// keyed by the source's size and modification time and by the size cap.
+
+namespace HdrCache {
+
+    constexpr uint32_t FORMAT_VERSION = 1;
+
+    struct CompactImage {
+        int width = 0;
+        int height = 0;
+        // Size of the .hdr before shrinkToWidth(), for memory reporting.
+        int sourceWidth = 0;
+        int sourceHeight = 0;
+        std::vector<uint8_t> rgbe;  // width * height * 4
+
+        size_t bytes() const { return rgbe.size(); }
+    };
+
+    // Shared-exponent encoding of one texel (Ward's RGBE, as used by .hdr).
+    // Negative components encode as 0.
+    void encodeRgbe(float r, float g, float b, uint8_t out[4]);
+    void decodeRgbe(const uint8_t in[4], float& r, float& g, float& b);
+
+    CompactImage compress(const float* rgb, int width, int height);
+    std::vector<float> expand(const CompactImage& image);
+
+    // Halves float RGB with a 2x2 box filter until width <= maxWidth (0 keeps
+    // the size). width and height are updated in place.
+    void shrinkToWidth(std::vector<float>& rgb, int& width, int& height, int maxWidth);
+
+    // Identifies a source file revision cheaply (size + mtime), 0 if missing.
+    uint64_t sourceStamp(const std::string& sourcePath);
+
+    std::string cachePathFor(const std::string& sourcePath);
+
+    // Restores an image written by save() for the same stamp and size cap.
+    bool load(const std::string& cachePath, uint64_t sourceStamp, int maxWidth,
+              CompactImage& image);
+
+    // Writes the sidecar; failure is reported and otherwise ignored.
+    bool save(const std::string& cachePath, uint64_t sourceStamp, int maxWidth,
+              const CompactImage& image);
+
+    // Global switch, on by default.
+    void setEnabled(bool enabled);
+    bool isEnabled();
+
+} // namespace HdrCache
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+// Quoted JSON string writer shared by the profiler's trace and the bench and
+// memory reports. Quotes and backslashes are escaped, other control
+// characters become \u00XX; everything else, UTF-8 included, is copied as-is.
+
+namespace Json {
+
+    inline void appendString(std::string& out, std::string_view text) {
+        out += '"';
+        for (unsigned char c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += static_cast<char>(c);
+            } else if (c < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+            } else {
+                out += static_cast<char>(c);
+            }
+        }
+        out += '"';
+    }
+
+} // namespace Json
@@ -0,0 +1,122 @@
+#include "mapped_file.hpp"
+
+#include <fstream>
+#include <functional>
+#include <thread>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPED_FILE_POSIX 1
+#endif
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            opened = true;
+            return true;
+        }
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (view) {
+            fileHandle = file;
+            mappingHandle = mapping;
+            begin = static_cast<const char*>(view);
+            length = static_cast<size_t>(fileSize.QuadPart);
+            mapped = true;
+            opened = true;
+            return true;
+        }
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+    }
+#elif defined(MAPPED_FILE_POSIX)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            if (st.st_size == 0) {
+                ::close(fd);
+                opened = true;
+                return true;
+            }
+            void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (view != MAP_FAILED) {
+                madvise(view, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+                begin = static_cast<const char*>(view);
+                length = static_cast<size_t>(st.st_size);
+                mapped = true;
+                opened = true;
+                return true;
+            }
+        } else {
+            ::close(fd);
+        }
+    }
+#endif
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::streamsize size = file.tellg();
+    if (size < 0) {
+        return false;
+    }
+    fallback.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    if (size > 0 && !file.read(fallback.data(), size)) {
+        fallback.clear();
+        return false;
+    }
+    begin = fallback.data();
+    length = fallback.size();
+    opened = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (mapped) {
+#if defined(_WIN32)
+        UnmapViewOfFile(begin);
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        mappingHandle = nullptr;
+        fileHandle = nullptr;
+#elif defined(MAPPED_FILE_POSIX)
+        munmap(const_cast<char*>(begin), length);
+#endif
+    }
+    fallback.clear();
+    fallback.shrink_to_fit();
+    begin = nullptr;
+    length = 0;
+    opened = false;
+    mapped = false;
+}
+
+std::string tempPathFor(const std::string& path) {
+#if defined(_WIN32)
+    const unsigned long processId = GetCurrentProcessId();
+#elif defined(MAPPED_FILE_POSIX)
+    const unsigned long processId = static_cast<unsigned long>(getpid());
+#else
+    const unsigned long processId = 0;
+#endif
+    const size_t threadId = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    return path + "." + std::to_string(processId) + "." + std::to_string(threadId) + ".tmp";
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Read-only view of a whole file. Uses mmap (or MapViewOfFile on Windows) so
+// importers can scan large assets without copying them into a std::string;
+// falls back to reading the file into memory where mapping is unavailable.
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Maps the file. Returns false if it cannot be opened; an empty file opens
+    // successfully with size() == 0.
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return opened; }
+    const char* data() const { return begin; }
+    size_t size() const { return length; }
+
+private:
+    const char* begin = nullptr;
+    size_t length = 0;
+    bool opened = false;
+    bool mapped = false;
+    std::vector<char> fallback;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+// Sibling of `path` to write before renaming it into place. The name carries
+// the process and thread id, so concurrent writers of the same cache file
+// (a prefetch and a requested load, or two running copies of the engine)
+// never truncate each other's temp file.
+std::string tempPathFor(const std::string& path);
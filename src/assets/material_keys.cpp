@@ -0,0 +1,67 @@
+#include "material_keys.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+    // Whether a string keeps its characters in its own small buffer.
+    bool isInline(const std::string& text) {
+        const char* self = reinterpret_cast<const char*>(&text);
+        const char* data = text.data();
+        return data >= self && data < self + sizeof(std::string);
+    }
+
+}
+
+namespace MaterialKeys {
+
+size_t intern(MeshComponent& mesh, MaterialComponent& material) {
+    if (keyHeapBytes(mesh) == 0) {
+        return 0;
+    }
+
+    std::unordered_map<std::string, std::string> ids;
+    auto idFor = [&ids](const std::string& name) -> const std::string& {
+        auto it = ids.find(name);
+        if (it == ids.end()) {
+            it = ids.emplace(name, std::to_string(ids.size())).first;
+        }
+        return it->second;
+    };
+
+    // Runs of faces usually share a material: skip the lookup for them.
+    std::string previous;
+    const std::string* previousId = nullptr;
+    for (auto& face : mesh.faceData) {
+        std::string& key = face.face.materialKey;
+        if (!previousId || key != previous) {
+            previous = key;
+            previousId = &idFor(key);
+        }
+        // Swapped in rather than assigned, which would keep a long name's
+        // heap buffer.
+        std::string(*previousId).swap(key);
+    }
+
+    decltype(material.materials) renamed;
+    for (auto& [name, properties] : material.materials) {
+        renamed.emplace(idFor(name), std::move(properties));
+    }
+    material.materials = std::move(renamed);
+    return ids.size();
+}
+
+size_t keyHeapBytes(const MeshComponent& mesh) {
+    size_t bytes = 0;
+    for (const auto& face : mesh.faceData) {
+        const std::string& key = face.face.materialKey;
+        if (!isInline(key)) {
+            bytes += key.capacity() + 1;
+        }
+    }
+    return bytes;
+}
+
+} // namespace MaterialKeys
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <render3d/ecs/material_component.hpp>
+#include <render3d/ecs/mesh_component.hpp>
+
+// Dense material ids for imported and generated meshes. render3d keys every
+// face's material by a std::string and looks it up by name while drawing, so
+// a long name such as an exporter's "concrete_cat_statue" is a separate heap
+// allocation on every face and a long hash per face per frame.
+//
+// intern() renames a mesh's materials to their index in a dense table ("0",
+// "1", ...), numbered in order of first use by the faces. The ids fit in the
+// string's inline buffer, so faces stop owning heap memory. Names that are
+// already inline gain nothing from this (measured slightly slower on the
+// isometric level), so a mesh whose keys all fit keeps its readable names.
+// Importers still match faces to MTL materials by name; interning runs once
+// the solid is built.
+
+using namespace render3d;
+
+namespace MaterialKeys {
+
+    // Renames the materials of `material` and the keys of `mesh`'s faces to
+    // dense ids when some face key lives on the heap; otherwise leaves both
+    // untouched and returns 0. Materials no face uses are kept, numbered
+    // after the used ones; a face naming a missing material gets an id that
+    // is missing too. Returns the number of ids handed out.
+    size_t intern(MeshComponent& mesh, MaterialComponent& material);
+
+    // Heap bytes held by the faces' material keys; 0 for inline keys.
+    size_t keyHeapBytes(const MeshComponent& mesh);
+
+} // namespace MaterialKeys
@@ -0,0 +1,346 @@
+#include "mesh_cache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string_view>
+
+#include "mapped_file.hpp"
+
+
+using namespace render3d;
+
+namespace {
+
+    constexpr char MAGIC[8] = {'R', '3', 'D', 'M', 'E', 'S', 'H', '\0'};
+    constexpr uint32_t BYTE_ORDER_MARK = 0x01020304u;
+    constexpr uint32_t FLAG_LOADED_NORMALS = 1u << 0;
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t sourceHash;
+        uint32_t flags;
+        uint32_t vertexCount;
+        uint32_t faceCount;
+        uint32_t indexCount;
+        uint32_t materialKeyCount;
+        uint32_t materialKeyBytes;
+        float radius;
+        float boundsMin[3];
+        float boundsMax[3];
+    };
+
+    struct PackedVertex {
+        float position[3];
+        float normal[3];
+        float texCoord[2];
+    };
+
+    struct PackedFace {
+        uint32_t indexCount;
+        uint32_t materialKey;
+    };
+
+    std::atomic<bool> cacheEnabled{true};
+
+    constexpr uint64_t FNV_OFFSET = 1469598103934665603ull;
+    constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+    uint64_t fnv1a(uint64_t hash, const char* data, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+
+    // Collects the file names listed on `mtllib` lines of an OBJ.
+    void findMaterialLibraries(std::string_view text, std::vector<std::string>& out) {
+        size_t pos = 0;
+        while (pos < text.size()) {
+            size_t end = text.find('\n', pos);
+            if (end == std::string_view::npos) end = text.size();
+            std::string_view line = text.substr(pos, end - pos);
+            pos = end + 1;
+
+            size_t first = line.find_first_not_of(" \t");
+            if (first == std::string_view::npos) continue;
+            line.remove_prefix(first);
+            if (line.size() < 7 || line.substr(0, 6) != "mtllib" ||
+                (line[6] != ' ' && line[6] != '\t')) {
+                continue;
+            }
+
+            line.remove_prefix(6);
+            while (!line.empty()) {
+                size_t start = line.find_first_not_of(" \t\r");
+                if (start == std::string_view::npos) break;
+                line.remove_prefix(start);
+                size_t stop = line.find_first_of(" \t\r");
+                out.emplace_back(line.substr(0, stop));
+                if (stop == std::string_view::npos) break;
+                line.remove_prefix(stop);
+            }
+        }
+    }
+
+    template <typename T>
+    void appendArray(std::string& out, const std::vector<T>& values) {
+        if (!values.empty()) {
+            out.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+        }
+    }
+
+}
+
+namespace MeshCache {
+
+SourceInfo describeSource(const std::string& sourcePath) {
+    SourceInfo info;
+    MappedFile source;
+    if (!source.open(sourcePath)) {
+        return info;
+    }
+
+    info.hash = fnv1a(FNV_OFFSET, source.data(), source.size());
+    findMaterialLibraries(std::string_view(source.data(), source.size()), info.materialLibraries);
+
+    std::filesystem::path basePath = std::filesystem::path(sourcePath).parent_path();
+    for (const auto& library : info.materialLibraries) {
+        info.hash = fnv1a(info.hash, library.data(), library.size());
+        MappedFile mtl;
+        if (mtl.open((basePath / library).string())) {
+            info.hash = fnv1a(info.hash, mtl.data(), mtl.size());
+        }
+    }
+
+    info.valid = true;
+    return info;
+}
+
+std::vector<std::string> materialLibraries(const std::string& sourcePath) {
+    std::vector<std::string> libraries;
+    MappedFile source;
+    if (source.open(sourcePath)) {
+        findMaterialLibraries(std::string_view(source.data(), source.size()), libraries);
+    }
+    return libraries;
+}
+
+std::string cachePathFor(const std::string& sourcePath) {
+    return sourcePath + ".r3dmesh";
+}
+
+bool load(const std::string& cachePath, uint64_t sourceHash,
+          MeshComponent& mesh, bool& hasLoadedNormals) {
+    if (!isEnabled()) {
+        return false;
+    }
+
+    MappedFile file;
+    if (!file.open(cachePath)) {
+        return false;
+    }
+    return decode(file.data(), file.size(), sourceHash, mesh, hasLoadedNormals);
+}
+
+bool decode(const char* data, size_t size, uint64_t sourceHash,
+            MeshComponent& mesh, bool& hasLoadedNormals) {
+    if (size < sizeof(FileHeader)) {
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.version != FORMAT_VERSION ||
+        header.byteOrder != BYTE_ORDER_MARK ||
+        header.sourceHash != sourceHash) {
+        return false;
+    }
+
+    const size_t vertexBytes = size_t(header.vertexCount) * sizeof(PackedVertex);
+    const size_t faceBytes = size_t(header.faceCount) * sizeof(PackedFace);
+    const size_t indexBytes = size_t(header.indexCount) * sizeof(int32_t);
+    const size_t offsetBytes = (size_t(header.materialKeyCount) + 1) * sizeof(uint32_t);
+    const size_t expected = sizeof(FileHeader) + vertexBytes + faceBytes + indexBytes +
+                            offsetBytes + header.materialKeyBytes;
+    if (size != expected) {
+        return false;
+    }
+
+    const char* cursor = data + sizeof(FileHeader);
+    const char* vertices = cursor;  cursor += vertexBytes;
+    const char* faces = cursor;     cursor += faceBytes;
+    const char* indices = cursor;   cursor += indexBytes;
+    const char* offsets = cursor;   cursor += offsetBytes;
+    const char* keyChars = cursor;
+
+    std::vector<std::string> keys(header.materialKeyCount);
+    for (uint32_t k = 0; k < header.materialKeyCount; ++k) {
+        uint32_t range[2];
+        std::memcpy(range, offsets + k * sizeof(uint32_t), sizeof(range));
+        if (range[0] > range[1] || range[1] > header.materialKeyBytes) {
+            return false;
+        }
+        keys[k].assign(keyChars + range[0], range[1] - range[0]);
+    }
+
+    std::vector<VertexData> vertexData(header.vertexCount);
+    for (uint32_t v = 0; v < header.vertexCount; ++v) {
+        PackedVertex packed;
+        std::memcpy(&packed, vertices + v * sizeof(PackedVertex), sizeof(packed));
+        VertexData& vd = vertexData[v];
+        vd.vertex = {packed.position[0], packed.position[1], packed.position[2]};
+        vd.normal = {packed.normal[0], packed.normal[1], packed.normal[2]};
+        vd.texCoord.x = packed.texCoord[0];
+        vd.texCoord.y = packed.texCoord[1];
+    }
+
+    std::vector<int32_t> indexData(header.indexCount);
+    if (indexBytes > 0) {
+        std::memcpy(indexData.data(), indices, indexBytes);
+    }
+
+    std::vector<FaceData> faceData(header.faceCount);
+    size_t nextIndex = 0;
+    for (uint32_t f = 0; f < header.faceCount; ++f) {
+        PackedFace packed;
+        std::memcpy(&packed, faces + f * sizeof(PackedFace), sizeof(packed));
+        if (packed.materialKey >= keys.size() ||
+            nextIndex + packed.indexCount > indexData.size()) {
+            return false;
+        }
+        const int32_t* first = indexData.data() + nextIndex;
+        for (uint32_t i = 0; i < packed.indexCount; ++i) {
+            if (first[i] < 0 || static_cast<uint32_t>(first[i]) >= header.vertexCount) {
+                return false;
+            }
+        }
+        faceData[f].face.vertexIndices.assign(first, first + packed.indexCount);
+        faceData[f].face.materialKey = keys[packed.materialKey];
+        nextIndex += packed.indexCount;
+    }
+
+    mesh.vertexData = std::move(vertexData);
+    mesh.faceData = std::move(faceData);
+    hasLoadedNormals = (header.flags & FLAG_LOADED_NORMALS) != 0;
+    return true;
+}
+
+std::string encode(uint64_t sourceHash, const MeshComponent& mesh, bool hasLoadedNormals) {
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.sourceHash = sourceHash;
+    header.flags = hasLoadedNormals ? FLAG_LOADED_NORMALS : 0u;
+    header.vertexCount = static_cast<uint32_t>(mesh.vertexData.size());
+    header.faceCount = static_cast<uint32_t>(mesh.faceData.size());
+    header.radius = mesh.radius;
+
+    std::vector<PackedVertex> vertices(mesh.vertexData.size());
+    for (size_t v = 0; v < mesh.vertexData.size(); ++v) {
+        const VertexData& vd = mesh.vertexData[v];
+        vertices[v] = {{vd.vertex.x, vd.vertex.y, vd.vertex.z},
+                       {vd.normal.x, vd.normal.y, vd.normal.z},
+                       {vd.texCoord.x, vd.texCoord.y}};
+        if (v == 0) {
+            header.boundsMin[0] = header.boundsMax[0] = vd.vertex.x;
+            header.boundsMin[1] = header.boundsMax[1] = vd.vertex.y;
+            header.boundsMin[2] = header.boundsMax[2] = vd.vertex.z;
+        }
+        header.boundsMin[0] = std::min(header.boundsMin[0], vd.vertex.x);
+        header.boundsMin[1] = std::min(header.boundsMin[1], vd.vertex.y);
+        header.boundsMin[2] = std::min(header.boundsMin[2], vd.vertex.z);
+        header.boundsMax[0] = std::max(header.boundsMax[0], vd.vertex.x);
+        header.boundsMax[1] = std::max(header.boundsMax[1], vd.vertex.y);
+        header.boundsMax[2] = std::max(header.boundsMax[2], vd.vertex.z);
+    }
+
+    std::map<std::string, uint32_t> keyIds;
+    std::vector<uint32_t> keyOffsets{0};
+    std::string keyChars;
+    std::vector<PackedFace> faces(mesh.faceData.size());
+    std::vector<int32_t> indices;
+    for (size_t f = 0; f < mesh.faceData.size(); ++f) {
+        const auto& face = mesh.faceData[f].face;
+        auto [it, inserted] = keyIds.insert({face.materialKey, static_cast<uint32_t>(keyIds.size())});
+        if (inserted) {
+            keyChars += face.materialKey;
+            keyOffsets.push_back(static_cast<uint32_t>(keyChars.size()));
+        }
+        faces[f] = {static_cast<uint32_t>(face.vertexIndices.size()), it->second};
+        for (auto index : face.vertexIndices) {
+            indices.push_back(static_cast<int32_t>(index));
+        }
+    }
+    header.indexCount = static_cast<uint32_t>(indices.size());
+    header.materialKeyCount = static_cast<uint32_t>(keyIds.size());
+    header.materialKeyBytes = static_cast<uint32_t>(keyChars.size());
+
+    std::string bytes;
+    bytes.reserve(sizeof(header) + vertices.size() * sizeof(PackedVertex) +
+                  faces.size() * sizeof(PackedFace) + indices.size() * sizeof(int32_t) +
+                  keyOffsets.size() * sizeof(uint32_t) + keyChars.size());
+    bytes.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    appendArray(bytes, vertices);
+    appendArray(bytes, faces);
+    appendArray(bytes, indices);
+    appendArray(bytes, keyOffsets);
+    bytes += keyChars;
+    return bytes;
+}
+
+bool save(const std::string& cachePath, uint64_t sourceHash,
+          const MeshComponent& mesh, bool hasLoadedNormals) {
+    if (!isEnabled()) {
+        return false;
+    }
+
+    std::string bytes = encode(sourceHash, mesh, hasLoadedNormals);
+
+    // Write to a temporary name and rename, so a crash or a concurrent
+    // reader never sees a half-written cache.
+    std::string tempPath = tempPathFor(cachePath);
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            std::cerr << "Mesh cache: cannot write " << cachePath << "\n";
+            return false;
+        }
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!out) {
+            std::cerr << "Mesh cache: failed writing " << cachePath << "\n";
+            out.close();
+            std::error_code ignored;
+            std::filesystem::remove(tempPath, ignored);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec) {
+        std::cerr << "Mesh cache: cannot replace " << cachePath << ": " << ec.message() << "\n";
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+void setEnabled(bool enabled) {
+    cacheEnabled = enabled;
+}
+
+bool isEnabled() {
+    return cacheEnabled;
+}
+
+} // namespace MeshCache
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <render3d/ecs/mesh_component.hpp>
+
+// Binary pre-cooked meshes for imported assets. The first import of an OBJ or
+// ASC file writes "<file>.r3dmesh" next to the source; later imports validate
+// it against a content hash of the source (plus any MTL libraries it names)
+// and restore the final vertex/face arrays straight from the mapped file,
+// skipping parsing, vertex deduplication and normal generation.
+
+using namespace render3d;
+
+namespace MeshCache {
+
+    constexpr uint32_t FORMAT_VERSION = 1;
+
+    struct SourceInfo {
+        bool valid = false;
+        uint64_t hash = 0;
+        // MTL libraries named by `mtllib` lines, in file order (OBJ only).
+        std::vector<std::string> materialLibraries;
+    };
+
+    // Hashes the source asset and the MTL libraries it references.
+    SourceInfo describeSource(const std::string& sourcePath);
+
+    // The MTL libraries an OBJ names, relative to its directory. Reads the
+    // file without hashing anything.
+    std::vector<std::string> materialLibraries(const std::string& sourcePath);
+
+    std::string cachePathFor(const std::string& sourcePath);
+
+    // Restores a mesh written by save(). Fails if the file is missing, has a
+    // different version, or was cooked from a source with another hash.
+    bool load(const std::string& cachePath, uint64_t sourceHash,
+              MeshComponent& mesh, bool& hasLoadedNormals);
+
+    // Writes the cooked mesh. Failure (e.g. a read-only asset directory) is
+    // reported and otherwise ignored; the import simply stays uncached.
+    bool save(const std::string& cachePath, uint64_t sourceHash,
+              const MeshComponent& mesh, bool hasLoadedNormals);
+
+    // In-memory form of the cache file, for containers that embed cooked
+    // meshes (scene snapshots). decode() checks the same things load() does.
+    std::string encode(uint64_t sourceHash, const MeshComponent& mesh, bool hasLoadedNormals);
+    bool decode(const char* data, size_t size, uint64_t sourceHash,
+                MeshComponent& mesh, bool& hasLoadedNormals);
+
+    // Global switch, on by default.
+    void setEnabled(bool enabled);
+    bool isEnabled();
+
+} // namespace MeshCache
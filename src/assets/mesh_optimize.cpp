@@ -0,0 +1,231 @@
+#include "mesh_optimize.hpp"
+
+#include <utility>
+#include <vector>
+
+namespace {
+
+    bool isTriangle(const FaceData& face) {
+        return face.face.vertexIndices.size() == 3;
+    }
+
+    // Tipsify's choice among the vertices the last fan touched: the one whose
+    // remaining triangles will still find it in the cache, preferring the
+    // oldest entry; -1 if none qualifies.
+    int nextFanVertex(const std::vector<int>& candidates, const std::vector<int>& live,
+                      const std::vector<int>& cacheTime, int time, int cacheSize) {
+        int best = -1;
+        int bestPriority = -1;
+        for (int v : candidates) {
+            if (live[v] <= 0) {
+                continue;
+            }
+            int priority = 0;
+            if (time - cacheTime[v] + 2 * live[v] <= cacheSize) {
+                priority = time - cacheTime[v];
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                best = v;
+            }
+        }
+        return best;
+    }
+
+}
+
+namespace MeshOptimize {
+
+float acmr(const MeshComponent& mesh, int cacheSize) {
+    std::vector<int> insertedAt(mesh.vertexData.size(), -1);
+    int misses = 0;
+    size_t triangles = 0;
+    auto touch = [&](int v) {
+        if (v < 0 || v >= static_cast<int>(insertedAt.size())) {
+            return;
+        }
+        // FIFO: an entry is evicted cacheSize misses after it went in.
+        if (insertedAt[v] < 0 || misses - insertedAt[v] >= cacheSize) {
+            insertedAt[v] = misses++;
+        }
+    };
+    for (const auto& face : mesh.faceData) {
+        const auto& indices = face.face.vertexIndices;
+        for (size_t i = 2; i < indices.size(); ++i) {
+            touch(indices[0]);
+            touch(indices[i - 1]);
+            touch(indices[i]);
+            ++triangles;
+        }
+    }
+    return triangles ? static_cast<float>(misses) / triangles : 0.0f;
+}
+
+void triangulate(MeshComponent& mesh) {
+    bool triangulated = true;
+    for (const auto& face : mesh.faceData) {
+        triangulated = triangulated && face.face.vertexIndices.size() <= 3;
+    }
+    if (triangulated) {
+        return;
+    }
+
+    std::vector<FaceData> faces;
+    faces.reserve(mesh.faceData.size() * 2);
+    for (auto& face : mesh.faceData) {
+        const auto& indices = face.face.vertexIndices;
+        if (indices.size() <= 3) {
+            faces.push_back(std::move(face));
+            continue;
+        }
+        for (size_t i = 2; i < indices.size(); ++i) {
+            FaceData triangle;
+            triangle.face = face.face;
+            triangle.face.vertexIndices = {indices[0], indices[i - 1], indices[i]};
+            faces.push_back(std::move(triangle));
+        }
+    }
+    mesh.faceData = std::move(faces);
+}
+
+void reorderFaces(MeshComponent& mesh, int cacheSize) {
+    const int vertexCount = static_cast<int>(mesh.vertexData.size());
+    const int faceCount = static_cast<int>(mesh.faceData.size());
+
+    // Triangles around each vertex, as offsets into one array.
+    std::vector<int> live(vertexCount, 0);
+    std::vector<bool> emitted(faceCount, true);
+    for (int f = 0; f < faceCount; ++f) {
+        const auto& indices = mesh.faceData[f].face.vertexIndices;
+        if (!isTriangle(mesh.faceData[f])) {
+            continue;
+        }
+        bool valid = true;
+        for (int v : indices) {
+            valid = valid && v >= 0 && v < vertexCount;
+        }
+        if (!valid) {
+            continue;
+        }
+        emitted[f] = false;
+        for (int v : indices) {
+            live[v]++;
+        }
+    }
+    std::vector<int> offsets(vertexCount + 1, 0);
+    for (int v = 0; v < vertexCount; ++v) {
+        offsets[v + 1] = offsets[v] + live[v];
+    }
+    std::vector<int> around(offsets[vertexCount]);
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (int f = 0; f < faceCount; ++f) {
+        if (emitted[f]) {
+            continue;
+        }
+        for (int v : mesh.faceData[f].face.vertexIndices) {
+            around[fill[v]++] = f;
+        }
+    }
+
+    std::vector<int> order;
+    order.reserve(faceCount);
+    std::vector<int> cacheTime(vertexCount, 0);
+    std::vector<int> deadEnds;
+    std::vector<int> candidates;
+    int time = cacheSize + 1;
+    int cursor = 0;
+    int fan = vertexCount > 0 ? 0 : -1;
+
+    while (fan >= 0) {
+        candidates.clear();
+        for (int i = offsets[fan]; i < offsets[fan + 1]; ++i) {
+            const int f = around[i];
+            if (emitted[f]) {
+                continue;
+            }
+            emitted[f] = true;
+            order.push_back(f);
+            for (int v : mesh.faceData[f].face.vertexIndices) {
+                deadEnds.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if (time - cacheTime[v] > cacheSize) {
+                    cacheTime[v] = time++;
+                }
+            }
+        }
+
+        fan = nextFanVertex(candidates, live, cacheTime, time, cacheSize);
+        if (fan >= 0) {
+            continue;
+        }
+        // Dead end: back up to a recently used vertex with triangles left,
+        // then fall back to the next one in index order.
+        while (!deadEnds.empty() && fan < 0) {
+            const int v = deadEnds.back();
+            deadEnds.pop_back();
+            if (live[v] > 0) {
+                fan = v;
+            }
+        }
+        while (fan < 0 && cursor < vertexCount) {
+            if (live[cursor] > 0) {
+                fan = cursor;
+            }
+            ++cursor;
+        }
+    }
+
+    // Polygons and faces with bad indices follow in their original order.
+    std::vector<bool> placed(faceCount, false);
+    std::vector<FaceData> faces;
+    faces.reserve(faceCount);
+    for (int f : order) {
+        placed[f] = true;
+        faces.push_back(std::move(mesh.faceData[f]));
+    }
+    for (int f = 0; f < faceCount; ++f) {
+        if (!placed[f]) {
+            faces.push_back(std::move(mesh.faceData[f]));
+        }
+    }
+    mesh.faceData = std::move(faces);
+}
+
+void reorderVertices(MeshComponent& mesh) {
+    const int vertexCount = static_cast<int>(mesh.vertexData.size());
+    std::vector<int> remap(vertexCount, -1);
+    std::vector<VertexData> vertices;
+    vertices.reserve(vertexCount);
+    for (auto& face : mesh.faceData) {
+        for (int& index : face.face.vertexIndices) {
+            if (index < 0 || index >= vertexCount) {
+                continue;
+            }
+            if (remap[index] < 0) {
+                remap[index] = static_cast<int>(vertices.size());
+                vertices.push_back(mesh.vertexData[index]);
+            }
+            index = remap[index];
+        }
+    }
+    for (int v = 0; v < vertexCount; ++v) {
+        if (remap[v] < 0) {
+            vertices.push_back(mesh.vertexData[v]);
+        }
+    }
+    mesh.vertexData = std::move(vertices);
+}
+
+Result optimize(MeshComponent& mesh) {
+    Result result;
+    result.acmrBefore = acmr(mesh);
+    triangulate(mesh);
+    reorderFaces(mesh);
+    reorderVertices(mesh);
+    result.acmrAfter = acmr(mesh);
+    result.triangles = mesh.faceData.size();
+    return result;
+}
+
+} // namespace MeshOptimize
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <render3d/ecs/mesh_component.hpp>
+
+// Load-time reordering of a mesh for the transform and raster loops.
+//
+//  - triangulate() splits quads and larger polygons into fans.
+//  - reorderFaces() orders triangles with Tipsify (Sander, Nehab and
+//    Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced
+//    Overdraw"), so consecutive triangles reuse the vertices the ones before
+//    them touched.
+//  - reorderVertices() renumbers vertexData in order of first use by the
+//    faces, so fetching them walks memory forward.
+//
+// None of them changes what is drawn: every face keeps its material key and
+// normal, and the vertex data is only moved. Face order does change, which
+// matters only to scenes that draw without depth sorting or a depth test
+// and rely on file order.
+
+using namespace render3d;
+
+namespace MeshOptimize {
+
+    // FIFO post-transform cache size the orders are tuned and measured for.
+    constexpr int kCacheSize = 16;
+
+    // Average cache misses per triangle (ACMR) of the faces in their current
+    // order, for a FIFO cache of `cacheSize` vertices: 3 is no reuse at all,
+    // ~0.5-0.7 is what a well-ordered closed mesh reaches.
+    float acmr(const MeshComponent& mesh, int cacheSize = kCacheSize);
+
+    void triangulate(MeshComponent& mesh);
+
+    // Expects a triangulated mesh; polygons are left where they are.
+    void reorderFaces(MeshComponent& mesh, int cacheSize = kCacheSize);
+
+    // Vertices no face uses are kept, after the used ones.
+    void reorderVertices(MeshComponent& mesh);
+
+    struct Result {
+        size_t triangles = 0;
+        float acmrBefore = 0.0f;
+        float acmrAfter = 0.0f;
+    };
+
+    // All three steps, in order.
+    Result optimize(MeshComponent& mesh);
+
+} // namespace MeshOptimize
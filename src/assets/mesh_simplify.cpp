@@ -0,0 +1,287 @@
+#include "mesh_simplify.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <render3d/ecs/mesh_system.hpp>
+
+namespace {
+
+    // Weight of the penalty planes along open edges, relative to the
+    // triangle planes (which are weighted by area).
+    constexpr double kBoundaryWeight = 1000.0;
+
+    // A collapse may not turn any remaining triangle more than ~78 degrees.
+    constexpr double kMinNormalDot = 0.2;
+
+    struct Vec {
+        double x = 0, y = 0, z = 0;
+    };
+
+    Vec sub(const Vec& a, const Vec& b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+    Vec cross(const Vec& a, const Vec& b) {
+        return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    }
+    double dot(const Vec& a, const Vec& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    double length(const Vec& a) { return std::sqrt(dot(a, a)); }
+
+    // Symmetric 4x4 matrix summing squared distances to a set of planes,
+    // stored as its upper triangle.
+    struct Quadric {
+        double aa = 0, ab = 0, ac = 0, ad = 0, bb = 0, bc = 0, bd = 0, cc = 0, cd = 0, dd = 0;
+
+        void addPlane(const Vec& n, double d, double weight) {
+            aa += weight * n.x * n.x; ab += weight * n.x * n.y; ac += weight * n.x * n.z;
+            ad += weight * n.x * d;   bb += weight * n.y * n.y; bc += weight * n.y * n.z;
+            bd += weight * n.y * d;   cc += weight * n.z * n.z; cd += weight * n.z * d;
+            dd += weight * d * d;
+        }
+
+        Quadric& operator+=(const Quadric& o) {
+            aa += o.aa; ab += o.ab; ac += o.ac; ad += o.ad; bb += o.bb;
+            bc += o.bc; bd += o.bd; cc += o.cc; cd += o.cd; dd += o.dd;
+            return *this;
+        }
+
+        double error(const Vec& p) const {
+            return aa * p.x * p.x + 2 * ab * p.x * p.y + 2 * ac * p.x * p.z + 2 * ad * p.x +
+                   bb * p.y * p.y + 2 * bc * p.y * p.z + 2 * bd * p.y +
+                   cc * p.z * p.z + 2 * cd * p.z + dd;
+        }
+    };
+
+    struct Triangle {
+        int v[3];
+        int face;  // source face, for its material and other attributes
+        bool removed = false;
+    };
+
+    // Moves vertex `from` onto vertex `to`. Stamps detect entries queued
+    // before either quadric changed.
+    struct Collapse {
+        double cost;
+        int from, to;
+        uint32_t fromStamp, toStamp;
+        bool operator>(const Collapse& o) const { return cost > o.cost; }
+    };
+
+    uint64_t edgeKey(int a, int b) {
+        if (a > b) std::swap(a, b);
+        return (static_cast<uint64_t>(static_cast<uint32_t>(a)) << 32) | static_cast<uint32_t>(b);
+    }
+
+    class Simplifier {
+    public:
+        explicit Simplifier(const MeshComponent& mesh) {
+            positions.reserve(mesh.vertexData.size());
+            for (const auto& vertex : mesh.vertexData) {
+                positions.push_back({vertex.vertex.x, vertex.vertex.y, vertex.vertex.z});
+            }
+            const int vertexCount = static_cast<int>(positions.size());
+            for (size_t f = 0; f < mesh.faceData.size(); ++f) {
+                const auto& indices = mesh.faceData[f].face.vertexIndices;
+                for (size_t i = 2; i < indices.size(); ++i) {
+                    Triangle t{{indices[0], indices[i - 1], indices[i]}, static_cast<int>(f)};
+                    bool valid = true;
+                    for (int v : t.v) valid = valid && v >= 0 && v < vertexCount;
+                    if (valid) triangles.push_back(t);
+                }
+            }
+            live = triangles.size();
+            quadrics.assign(positions.size(), Quadric{});
+            stamps.assign(positions.size(), 0);
+            removed.assign(positions.size(), false);
+            vertexTriangles.assign(positions.size(), {});
+        }
+
+        void run(size_t target) {
+            std::unordered_map<uint64_t, int> edgeUse;
+            for (size_t t = 0; t < triangles.size(); ++t) {
+                Triangle& tri = triangles[t];
+                Vec normal = normalOf(tri.v[0], tri.v[1], tri.v[2]);
+                double area = length(normal);
+                if (area > 0) {
+                    Vec n{normal.x / area, normal.y / area, normal.z / area};
+                    double d = -dot(n, positions[tri.v[0]]);
+                    for (int v : tri.v) quadrics[v].addPlane(n, d, 0.5 * area);
+                }
+                for (int i = 0; i < 3; ++i) {
+                    vertexTriangles[tri.v[i]].push_back(static_cast<int>(t));
+                    edgeUse[edgeKey(tri.v[i], tri.v[(i + 1) % 3])]++;
+                }
+            }
+
+            // Open edges: a plane through the edge, perpendicular to its triangle.
+            for (const Triangle& tri : triangles) {
+                Vec normal = normalOf(tri.v[0], tri.v[1], tri.v[2]);
+                double area = length(normal);
+                if (area <= 0) continue;
+                for (int i = 0; i < 3; ++i) {
+                    int a = tri.v[i], b = tri.v[(i + 1) % 3];
+                    if (edgeUse[edgeKey(a, b)] != 1) continue;
+                    Vec edge = sub(positions[b], positions[a]);
+                    Vec side = cross(edge, normal);
+                    double sideLength = length(side);
+                    if (sideLength <= 0) continue;
+                    Vec n{side.x / sideLength, side.y / sideLength, side.z / sideLength};
+                    double weight = kBoundaryWeight * dot(edge, edge);
+                    double d = -dot(n, positions[a]);
+                    quadrics[a].addPlane(n, d, weight);
+                    quadrics[b].addPlane(n, d, weight);
+                }
+            }
+
+            for (const auto& [key, count] : edgeUse) {
+                queueEdge(static_cast<int>(key >> 32), static_cast<int>(key & 0xffffffffu));
+            }
+
+            while (live > target && !queue.empty()) {
+                Collapse c = queue.top();
+                queue.pop();
+                if (removed[c.from] || removed[c.to] ||
+                    stamps[c.from] != c.fromStamp || stamps[c.to] != c.toStamp) {
+                    continue;
+                }
+                if (!keepsOrientation(c.from, c.to)) continue;
+                collapse(c.from, c.to);
+            }
+        }
+
+        MeshComponent result(const MeshComponent& mesh) const {
+            MeshComponent out;
+            std::vector<int> remap(positions.size(), -1);
+            for (const Triangle& tri : triangles) {
+                if (tri.removed) continue;
+                FaceData face = mesh.faceData[tri.face];
+                face.face.vertexIndices.assign(3, 0);
+                for (int i = 0; i < 3; ++i) {
+                    int& index = remap[tri.v[i]];
+                    if (index < 0) {
+                        index = static_cast<int>(out.vertexData.size());
+                        out.vertexData.push_back(mesh.vertexData[tri.v[i]]);
+                    }
+                    face.face.vertexIndices[i] = index;
+                }
+                out.faceData.push_back(std::move(face));
+            }
+            MeshSystem::updateFaceNormals(out);
+            out.radius = mesh.radius;
+            MeshSystem::markBoundsDirty(out);
+            return out;
+        }
+
+    private:
+        Vec normalOf(int a, int b, int c) const {
+            return cross(sub(positions[b], positions[a]), sub(positions[c], positions[a]));
+        }
+
+        void queueEdge(int a, int b) {
+            Quadric q = quadrics[a];
+            q += quadrics[b];
+            double aToB = q.error(positions[b]);
+            double bToA = q.error(positions[a]);
+            if (aToB <= bToA) {
+                queue.push({aToB, a, b, stamps[a], stamps[b]});
+            } else {
+                queue.push({bToA, b, a, stamps[b], stamps[a]});
+            }
+        }
+
+        bool keepsOrientation(int from, int to) const {
+            for (int t : vertexTriangles[from]) {
+                const Triangle& tri = triangles[t];
+                if (tri.removed) continue;
+                if (tri.v[0] == to || tri.v[1] == to || tri.v[2] == to) continue;
+
+                Vec before = normalOf(tri.v[0], tri.v[1], tri.v[2]);
+                int moved[3] = {tri.v[0], tri.v[1], tri.v[2]};
+                for (int& v : moved) {
+                    if (v == from) v = to;
+                }
+                Vec after = normalOf(moved[0], moved[1], moved[2]);
+                double lengths = length(before) * length(after);
+                if (lengths <= 0 || dot(before, after) < kMinNormalDot * lengths) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void collapse(int from, int to) {
+            for (int t : vertexTriangles[from]) {
+                Triangle& tri = triangles[t];
+                if (tri.removed) continue;
+                if (tri.v[0] == to || tri.v[1] == to || tri.v[2] == to) {
+                    tri.removed = true;
+                    --live;
+                    continue;
+                }
+                for (int& v : tri.v) {
+                    if (v == from) v = to;
+                }
+                vertexTriangles[to].push_back(t);
+            }
+            removed[from] = true;
+            vertexTriangles[from].clear();
+            quadrics[to] += quadrics[from];
+            ++stamps[to];
+
+            // Drop dead triangles from the survivor and requeue its edges.
+            std::vector<int>& around = vertexTriangles[to];
+            std::vector<int> kept;
+            kept.reserve(around.size());
+            std::vector<int> neighbours;
+            for (int t : around) {
+                const Triangle& tri = triangles[t];
+                if (tri.removed) continue;
+                kept.push_back(t);
+                for (int v : tri.v) {
+                    if (v != to) neighbours.push_back(v);
+                }
+            }
+            around.swap(kept);
+            std::sort(neighbours.begin(), neighbours.end());
+            neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+            for (int v : neighbours) {
+                queueEdge(to, v);
+            }
+        }
+
+        std::vector<Vec> positions;
+        std::vector<Triangle> triangles;
+        std::vector<Quadric> quadrics;
+        std::vector<uint32_t> stamps;
+        std::vector<bool> removed;
+        std::vector<std::vector<int>> vertexTriangles;
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue;
+        size_t live = 0;
+    };
+
+}
+
+namespace MeshSimplify {
+
+size_t triangleCount(const MeshComponent& mesh) {
+    size_t triangles = 0;
+    for (const auto& face : mesh.faceData) {
+        const size_t corners = face.face.vertexIndices.size();
+        if (corners >= 3) {
+            triangles += corners - 2;
+        }
+    }
+    return triangles;
+}
+
+MeshComponent simplify(const MeshComponent& mesh, size_t targetTriangles) {
+    Simplifier simplifier(mesh);
+    simplifier.run(targetTriangles);
+    return simplifier.result(mesh);
+}
+
+} // namespace MeshSimplify
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <render3d/ecs/mesh_component.hpp>
+
+// Mesh simplification by edge collapse with quadric error metrics (Garland &
+// Heckbert). Every vertex accumulates the planes of its triangles; the
+// cheapest edge is collapsed into whichever endpoint moves the surface
+// least, until the triangle budget is met.
+//
+// Collapsing onto an endpoint instead of an optimal new position keeps each
+// surviving vertex's normal and texture coordinate untouched, so materials
+// and UV mapping carry over to the simplified mesh unchanged. Open edges,
+// which include UV and normal seams (the importers split vertices there),
+// get a steep penalty plane so outlines and seams hold their shape.
+// Collapses that would flip a triangle are skipped.
+
+using namespace render3d;
+
+namespace MeshSimplify {
+
+    // Triangles a mesh renders: an n-gon counts as n - 2.
+    size_t triangleCount(const MeshComponent& mesh);
+
+    // Returns `mesh` reduced to `targetTriangles` triangles, or more when
+    // no further collapse is allowed. Polygons are triangulated as
+    // fans first; each triangle keeps its face's material key. Face normals
+    // are recomputed and the radius is kept, so the result bounds the same.
+    MeshComponent simplify(const MeshComponent& mesh, size_t targetTriangles);
+
+} // namespace MeshSimplify
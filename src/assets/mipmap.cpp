@@ -0,0 +1,110 @@
+#include "mipmap.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "parallel_for.hpp"
+
+namespace {
+
+    // Destination rows per parallel band, and the level size below which the
+    // thread start-up costs more than the filtering.
+    constexpr int kRowsPerBand = 32;
+    constexpr size_t kParallelPixels = 256 * 256;
+
+    // Box-filters destination rows [y0, y1). Source texel (x, y) of an odd
+    // edge is shared with the last destination texel instead of dropped, so
+    // a 5-wide row averages 2+3 texels at its right end.
+    void filterRows(const Texture& src, int dstW, int dstH, unsigned char* dst, int y0, int y1) {
+        const int srcW = src.w;
+        const int srcH = src.h;
+        const unsigned char* pixels = src.data.data();
+
+        for (int y = y0; y < y1; ++y) {
+            int sy0 = y * 2;
+            int sy1 = (y == dstH - 1) ? srcH : std::min(srcH, sy0 + 2);
+            for (int x = 0; x < dstW; ++x) {
+                int sx0 = x * 2;
+                int sx1 = (x == dstW - 1) ? srcW : std::min(srcW, sx0 + 2);
+
+                unsigned sum[4] = {0, 0, 0, 0};
+                for (int sy = sy0; sy < sy1; ++sy) {
+                    const unsigned char* row = pixels + (static_cast<size_t>(sy) * srcW + sx0) * 4;
+                    for (int sx = sx0; sx < sx1; ++sx, row += 4) {
+                        sum[0] += row[0];
+                        sum[1] += row[1];
+                        sum[2] += row[2];
+                        sum[3] += row[3];
+                    }
+                }
+                unsigned count = static_cast<unsigned>((sy1 - sy0) * (sx1 - sx0));
+                unsigned char* out = dst + (static_cast<size_t>(y) * dstW + x) * 4;
+                for (int c = 0; c < 4; ++c) {
+                    out[c] = static_cast<unsigned char>((sum[c] + count / 2) / count);
+                }
+            }
+        }
+    }
+
+    Texture downsample(const Texture& source, const Texture& shell) {
+        const int dstW = std::max(1, source.w / 2);
+        const int dstH = std::max(1, source.h / 2);
+        std::vector<unsigned char> pixels(static_cast<size_t>(dstW) * dstH * 4);
+
+        if (static_cast<size_t>(dstW) * dstH < kParallelPixels) {
+            filterRows(source, dstW, dstH, pixels.data(), 0, dstH);
+        } else {
+            size_t bands = (dstH + kRowsPerBand - 1) / kRowsPerBand;
+            Parallel::forEach(bands, [&](size_t band) {
+                int y0 = static_cast<int>(band) * kRowsPerBand;
+                filterRows(source, dstW, dstH, pixels.data(), y0, std::min(dstH, y0 + kRowsPerBand));
+            });
+        }
+
+        Texture level = shell;
+        level.w = dstW;
+        level.h = dstH;
+        level.data = std::move(pixels);
+        return level;
+    }
+}
+
+namespace Mipmap {
+
+int levelCount(int width, int height) {
+    int size = std::max(width, height);
+    int levels = 1;
+    while (size > 1) {
+        size /= 2;
+        ++levels;
+    }
+    return levels;
+}
+
+std::vector<Texture> buildChain(Texture& base, int minSize) {
+    std::vector<Texture> chain;
+    if (base.w <= 0 || base.h <= 0 ||
+        base.data.size() < static_cast<size_t>(base.w) * base.h * 4) {
+        return chain;
+    }
+
+    std::vector<unsigned char> pixels;
+    pixels.swap(base.data);
+    const Texture shell = base;
+    pixels.swap(base.data);
+
+    // Reserved up front so `previous` stays valid across push_back.
+    const Texture* previous = &base;
+    chain.reserve(levelCount(base.w, base.h) - 1);
+    while (std::max(previous->w, previous->h) / 2 >= std::max(1, minSize)) {
+        chain.push_back(downsample(*previous, shell));
+        previous = &chain.back();
+    }
+    return chain;
+}
+
+size_t byteSize(const Texture& texture) {
+    return texture.data.size();
+}
+
+} // namespace Mipmap
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <render3d/texture.hpp>
+
+// Mip pyramids for RGBA8 textures. Each level halves the one above it with a
+// 2x2 box filter (an odd last row or column is folded into its neighbour),
+// down to 1x1. Large levels are filtered in parallel row bands.
+
+using namespace render3d;
+
+namespace Mipmap {
+
+    // Levels a w x h image has including itself: floor(log2(max(w, h))) + 1.
+    int levelCount(int width, int height);
+
+    // Levels 1.. of `base`'s pyramid, stopping before the longer side would
+    // drop below `minSize`. Level 0 is `base` itself and is not copied.
+    //
+    // Every level inherits base's sampling settings: base's pixels are moved
+    // aside for a moment so its pixel-less shell can be cloned cheaply. base
+    // is unchanged on return.
+    std::vector<Texture> buildChain(Texture& base, int minSize = 1);
+
+    // Decoded RGBA8 bytes held by the texture.
+    size_t byteSize(const Texture& texture);
+
+} // namespace Mipmap
@@ -0,0 +1,545 @@
+#include "obj_parser.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <set>
+#include <utility>
+
+#include "mapped_file.hpp"
+#include "parallel_for.hpp"
+
+namespace {
+
+    // Below this size a chunk costs more to schedule than to parse.
+    constexpr size_t MIN_CHUNK_BYTES = 256 * 1024;
+    constexpr size_t CHUNKS_PER_WORKER = 4;
+
+    enum Component : uint32_t { POSITION = 0, TEXCOORD = 1, NORMAL = 2 };
+
+    struct MaterialSwitch {
+        size_t firstFace;
+        std::string name;
+    };
+
+    struct Chunk {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+
+        std::vector<float> positions;
+        std::vector<float> texcoords;
+        std::vector<float> normals;
+
+        // Corners of the (untriangulated) faces. Absolute OBJ indices are
+        // stored resolved; relative ones are stored against this chunk's
+        // element counts and listed in `relative` (corner * 3 + component)
+        // until the chunk's global offsets are known.
+        std::vector<tinyobj::index_t> corners;
+        std::vector<uint32_t> relative;
+        std::vector<uint8_t> faceSizes;
+        std::vector<MaterialSwitch> materialSwitches;
+        std::vector<std::vector<std::string>> libraries;
+
+        size_t positionBase = 0;
+        size_t texcoordBase = 0;
+        size_t normalBase = 0;
+
+        std::vector<tinyobj::index_t> triangles;
+        std::vector<int> triangleMaterials;
+
+        bool failed = false;
+        std::string error;
+    };
+
+    inline bool isSpace(char c) { return c == ' ' || c == '\t'; }
+    inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+    inline bool isDelimiter(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+    void skipSpaces(const char*& p, const char* end) {
+        while (p < end && isSpace(*p)) ++p;
+    }
+
+    // Same grammar and arithmetic as tinyobj's tryParseDouble, so both import
+    // paths produce bit-identical floats.
+    bool parseDouble(const char* s, const char* end, double& result) {
+        if (s >= end) return false;
+
+        double mantissa = 0.0;
+        int exponent = 0;
+        bool negative = false;
+        const char* p = s;
+
+        if (*p == '+' || *p == '-') {
+            negative = (*p == '-');
+            ++p;
+            if (p >= end) return false;
+        } else if (!isDigit(*p) && *p != '.') {
+            return false;
+        }
+
+        if (p < end && *p != '.') {
+            int read = 0;
+            while (p < end && isDigit(*p)) {
+                mantissa *= 10;
+                mantissa += static_cast<int>(*p - '0');
+                ++p;
+                ++read;
+            }
+            if (read == 0) return false;
+        }
+
+        if (p < end && *p == '.') {
+            static const double powLut[] = {
+                1.0, 0.1, 0.01, 0.001, 0.0001, 0.00001, 0.000001, 0.0000001,
+            };
+            constexpr int lutEntries = sizeof powLut / sizeof powLut[0];
+            ++p;
+            int read = 1;
+            while (p < end && isDigit(*p)) {
+                mantissa += static_cast<int>(*p - '0') *
+                            (read < lutEntries ? powLut[read] : std::pow(10.0, -read));
+                ++read;
+                ++p;
+            }
+        }
+
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            ++p;
+            bool negativeExponent = false;
+            if (p < end && (*p == '+' || *p == '-')) {
+                negativeExponent = (*p == '-');
+                ++p;
+            } else if (p >= end || !isDigit(*p)) {
+                return false;
+            }
+            int read = 0;
+            while (p < end && isDigit(*p)) {
+                if (exponent > 2147483647 / 10) return false;
+                exponent = exponent * 10 + static_cast<int>(*p - '0');
+                ++p;
+                ++read;
+            }
+            if (read == 0) return false;
+            if (negativeExponent) exponent = -exponent;
+        }
+
+        result = (negative ? -1 : 1) *
+                 (exponent ? std::ldexp(mantissa * std::pow(5.0, exponent), exponent) : mantissa);
+        return true;
+    }
+
+    float parseFloat(const char*& p, const char* end) {
+        skipSpaces(p, end);
+        const char* tokenEnd = p;
+        while (tokenEnd < end && !isDelimiter(*tokenEnd)) ++tokenEnd;
+        double value = 0.0;
+        parseDouble(p, tokenEnd, value);
+        p = tokenEnd;
+        return static_cast<float>(value);
+    }
+
+    // atoi() on a bounded range: optional sign, then digits.
+    int parseInt(const char*& p, const char* end) {
+        bool negative = false;
+        if (p < end && (*p == '+' || *p == '-')) {
+            negative = (*p == '-');
+            ++p;
+        }
+        int value = 0;
+        while (p < end && isDigit(*p)) {
+            value = value * 10 + (*p - '0');
+            ++p;
+        }
+        return negative ? -value : value;
+    }
+
+    void skipIndexField(const char*& p, const char* end) {
+        while (p < end && *p != '/' && !isDelimiter(*p)) ++p;
+    }
+
+    // Resolves one OBJ index against the chunk-local element count. Zero is
+    // invalid for positions and means "absent" for texcoords and normals.
+    bool resolveIndex(int raw, size_t localCount, bool allowZero,
+                      int& out, bool& isRelative) {
+        isRelative = false;
+        if (raw > 0) {
+            out = raw - 1;
+            return true;
+        }
+        if (raw == 0) {
+            out = -1;
+            return allowZero;
+        }
+        out = static_cast<int>(localCount) + raw;
+        isRelative = true;
+        return true;
+    }
+
+    bool parseFace(const char*& p, const char* end, Chunk& chunk) {
+        tinyobj::index_t corners[4];
+        uint32_t relativeMask = 0;
+        int count = 0;
+
+        const size_t positionCount = chunk.positions.size() / 3;
+        const size_t texcoordCount = chunk.texcoords.size() / 2;
+        const size_t normalCount = chunk.normals.size() / 3;
+
+        skipSpaces(p, end);
+        while (p < end && *p != '\n' && *p != '\r' && *p != '#') {
+            if (count == 4) {
+                chunk.error = "polygons with more than four corners";
+                return false;
+            }
+            tinyobj::index_t& corner = corners[count];
+            corner.vertex_index = corner.texcoord_index = corner.normal_index = -1;
+            bool isRelative = false;
+
+            if (!resolveIndex(parseInt(p, end), positionCount, false,
+                              corner.vertex_index, isRelative)) {
+                chunk.error = "zero vertex index";
+                return false;
+            }
+            if (isRelative) relativeMask |= 1u << (count * 3 + POSITION);
+            skipIndexField(p, end);
+
+            if (p < end && *p == '/') {
+                ++p;
+                if (p < end && *p == '/') {
+                    ++p;
+                    resolveIndex(parseInt(p, end), normalCount, true, corner.normal_index, isRelative);
+                    if (isRelative) relativeMask |= 1u << (count * 3 + NORMAL);
+                    skipIndexField(p, end);
+                } else {
+                    resolveIndex(parseInt(p, end), texcoordCount, true, corner.texcoord_index, isRelative);
+                    if (isRelative) relativeMask |= 1u << (count * 3 + TEXCOORD);
+                    skipIndexField(p, end);
+                    if (p < end && *p == '/') {
+                        ++p;
+                        resolveIndex(parseInt(p, end), normalCount, true, corner.normal_index, isRelative);
+                        if (isRelative) relativeMask |= 1u << (count * 3 + NORMAL);
+                        skipIndexField(p, end);
+                    }
+                }
+            }
+
+            ++count;
+            while (p < end && (isSpace(*p) || *p == '\r')) ++p;
+        }
+
+        // tinyobj drops degenerate faces with a warning.
+        if (count < 3) {
+            return true;
+        }
+
+        const uint32_t firstCorner = static_cast<uint32_t>(chunk.corners.size());
+        for (int c = 0; c < count; ++c) {
+            chunk.corners.push_back(corners[c]);
+        }
+        for (uint32_t bit = 0; relativeMask != 0; ++bit, relativeMask >>= 1) {
+            if (relativeMask & 1u) {
+                chunk.relative.push_back(firstCorner * 3 + bit);
+            }
+        }
+        chunk.faceSizes.push_back(static_cast<uint8_t>(count));
+        return true;
+    }
+
+    // First whitespace-separated word, as tinyobj's parseString reads it.
+    std::string parseWord(const char*& p, const char* end) {
+        skipSpaces(p, end);
+        const char* start = p;
+        while (p < end && !isDelimiter(*p)) ++p;
+        return std::string(start, p);
+    }
+
+    // `mtllib` arguments split on spaces, with '\' escaping the next character.
+    std::vector<std::string> parseLibraryNames(const char* p, const char* end) {
+        std::vector<std::string> names;
+        std::string name;
+        bool escaping = false;
+        for (; p < end && *p != '\n' && *p != '\r'; ++p) {
+            if (escaping) {
+                escaping = false;
+            } else if (*p == '\\') {
+                escaping = true;
+                continue;
+            } else if (*p == ' ') {
+                if (!name.empty()) names.push_back(name);
+                name.clear();
+                continue;
+            }
+            name += *p;
+        }
+        names.push_back(name);
+        return names;
+    }
+
+    void parseChunk(Chunk& chunk) {
+        const char* p = chunk.begin;
+        const char* end = chunk.end;
+
+        while (p < end) {
+            const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            if (!lineEnd) lineEnd = end;
+
+            const char* token = p;
+            p = lineEnd + (lineEnd < end ? 1 : 0);
+            skipSpaces(token, lineEnd);
+            if (token + 1 >= lineEnd) continue;
+
+            if (token[0] == 'v' && isSpace(token[1])) {
+                token += 2;
+                chunk.positions.push_back(parseFloat(token, lineEnd));
+                chunk.positions.push_back(parseFloat(token, lineEnd));
+                chunk.positions.push_back(parseFloat(token, lineEnd));
+            } else if (token[0] == 'v' && token[1] == 'n' && token + 2 < lineEnd && isSpace(token[2])) {
+                token += 3;
+                chunk.normals.push_back(parseFloat(token, lineEnd));
+                chunk.normals.push_back(parseFloat(token, lineEnd));
+                chunk.normals.push_back(parseFloat(token, lineEnd));
+            } else if (token[0] == 'v' && token[1] == 't' && token + 2 < lineEnd && isSpace(token[2])) {
+                token += 3;
+                chunk.texcoords.push_back(parseFloat(token, lineEnd));
+                chunk.texcoords.push_back(parseFloat(token, lineEnd));
+            } else if (token[0] == 'f' && isSpace(token[1])) {
+                token += 2;
+                if (!parseFace(token, lineEnd, chunk)) {
+                    chunk.failed = true;
+                    return;
+                }
+            } else if (lineEnd - token >= 6 && std::strncmp(token, "usemtl", 6) == 0) {
+                token += 6;
+                chunk.materialSwitches.push_back({chunk.faceSizes.size(), parseWord(token, lineEnd)});
+            } else if (lineEnd - token >= 7 && std::strncmp(token, "mtllib", 6) == 0 && isSpace(token[6])) {
+                chunk.libraries.push_back(parseLibraryNames(token + 7, lineEnd));
+            }
+        }
+    }
+
+    // Splits [data, data + size) into pieces of roughly equal size, each
+    // ending just after a newline. chunkBytes == 0 picks the size.
+    std::vector<Chunk> splitChunks(const char* data, size_t size, size_t chunkBytes) {
+        if (chunkBytes == 0) {
+            size_t target = std::max(1u, Parallel::workerCount(size / MIN_CHUNK_BYTES + 1));
+            target *= CHUNKS_PER_WORKER;
+            chunkBytes = std::max(MIN_CHUNK_BYTES, size / target + 1);
+        }
+
+        std::vector<Chunk> chunks;
+        const char* cursor = data;
+        const char* end = data + size;
+        while (cursor < end) {
+            const char* stop = cursor + std::min<size_t>(chunkBytes, end - cursor);
+            if (stop < end) {
+                const char* newline = static_cast<const char*>(std::memchr(stop, '\n', end - stop));
+                stop = newline ? newline + 1 : end;
+            }
+            Chunk& chunk = chunks.emplace_back();
+            chunk.begin = cursor;
+            chunk.end = stop;
+            cursor = stop;
+        }
+        return chunks;
+    }
+
+    // Loads the libraries named on each `mtllib` line, trying the names of a
+    // line in order until one loads, like tinyobj::LoadObj.
+    void loadMaterials(const std::vector<Chunk>& chunks, const std::string& mtlSearchPath,
+                       ObjParser::Result& result, std::map<std::string, int>& materialIds) {
+        tinyobj::MaterialFileReader reader(mtlSearchPath);
+        std::set<std::string> loaded;
+        for (const auto& chunk : chunks) {
+            for (const auto& names : chunk.libraries) {
+                bool found = false;
+                for (const auto& name : names) {
+                    if (loaded.count(name) > 0) {
+                        found = true;
+                        continue;
+                    }
+                    std::string warning;
+                    std::string error;
+                    bool ok = reader(name, &result.materials, &materialIds, &warning, &error);
+                    result.warning += warning;
+                    result.warning += error;
+                    if (ok) {
+                        found = true;
+                        loaded.insert(name);
+                        break;
+                    }
+                }
+                if (!found) {
+                    result.warning += "Failed to load material file(s). Use default material.\n";
+                }
+            }
+        }
+    }
+
+    // Applies the global offsets, validates every index, and splits quads
+    // along their shorter diagonal exactly as tinyobj does.
+    void triangulateChunk(Chunk& chunk, int firstMaterial,
+                          const std::map<std::string, int>& materialIds,
+                          const tinyobj::attrib_t& attrib) {
+        const int positionCount = static_cast<int>(attrib.vertices.size() / 3);
+        const int texcoordCount = static_cast<int>(attrib.texcoords.size() / 2);
+        const int normalCount = static_cast<int>(attrib.normals.size() / 3);
+
+        for (uint32_t slot : chunk.relative) {
+            tinyobj::index_t& corner = chunk.corners[slot / 3];
+            switch (slot % 3) {
+                case POSITION: corner.vertex_index += static_cast<int>(chunk.positionBase); break;
+                case TEXCOORD: corner.texcoord_index += static_cast<int>(chunk.texcoordBase); break;
+                case NORMAL:   corner.normal_index += static_cast<int>(chunk.normalBase); break;
+            }
+        }
+        for (const auto& corner : chunk.corners) {
+            if (corner.vertex_index < 0 || corner.vertex_index >= positionCount ||
+                corner.texcoord_index < -1 || corner.texcoord_index >= texcoordCount ||
+                corner.normal_index < -1 || corner.normal_index >= normalCount) {
+                chunk.error = "face index out of range";
+                chunk.failed = true;
+                return;
+            }
+        }
+
+        size_t triangleCount = 0;
+        for (uint8_t size : chunk.faceSizes) {
+            triangleCount += size - 2;
+        }
+        chunk.triangles.reserve(triangleCount * 3);
+        chunk.triangleMaterials.reserve(triangleCount);
+
+        const auto& v = attrib.vertices;
+        int material = firstMaterial;
+        size_t nextSwitch = 0;
+        size_t corner = 0;
+        for (size_t face = 0; face < chunk.faceSizes.size(); ++face) {
+            while (nextSwitch < chunk.materialSwitches.size() &&
+                   chunk.materialSwitches[nextSwitch].firstFace == face) {
+                auto it = materialIds.find(chunk.materialSwitches[nextSwitch].name);
+                material = it != materialIds.end() ? it->second : -1;
+                ++nextSwitch;
+            }
+
+            const tinyobj::index_t* c = &chunk.corners[corner];
+            if (chunk.faceSizes[face] == 3) {
+                chunk.triangles.insert(chunk.triangles.end(), c, c + 3);
+                chunk.triangleMaterials.push_back(material);
+            } else {
+                size_t vi0 = size_t(c[0].vertex_index);
+                size_t vi1 = size_t(c[1].vertex_index);
+                size_t vi2 = size_t(c[2].vertex_index);
+                size_t vi3 = size_t(c[3].vertex_index);
+                float e02x = v[vi2 * 3 + 0] - v[vi0 * 3 + 0];
+                float e02y = v[vi2 * 3 + 1] - v[vi0 * 3 + 1];
+                float e02z = v[vi2 * 3 + 2] - v[vi0 * 3 + 2];
+                float e13x = v[vi3 * 3 + 0] - v[vi1 * 3 + 0];
+                float e13y = v[vi3 * 3 + 1] - v[vi1 * 3 + 1];
+                float e13z = v[vi3 * 3 + 2] - v[vi1 * 3 + 2];
+                float sqr02 = e02x * e02x + e02y * e02y + e02z * e02z;
+                float sqr13 = e13x * e13x + e13y * e13y + e13z * e13z;
+                if (sqr02 < sqr13) {
+                    chunk.triangles.insert(chunk.triangles.end(), {c[0], c[1], c[2], c[0], c[2], c[3]});
+                } else {
+                    chunk.triangles.insert(chunk.triangles.end(), {c[0], c[1], c[3], c[1], c[2], c[3]});
+                }
+                chunk.triangleMaterials.push_back(material);
+                chunk.triangleMaterials.push_back(material);
+            }
+            corner += chunk.faceSizes[face];
+        }
+    }
+
+    template <typename T>
+    void appendAt(std::vector<T>& dst, size_t offset, const std::vector<T>& src) {
+        std::copy(src.begin(), src.end(), dst.begin() + offset);
+    }
+}
+
+namespace ObjParser {
+
+bool parse(const std::string& filename, const std::string& mtlSearchPath, Result& result,
+           size_t chunkBytes) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        result.error = "Cannot open " + filename;
+        return false;
+    }
+
+    std::vector<Chunk> chunks = splitChunks(file.data(), file.size(), chunkBytes);
+    result.chunks = chunks.size();
+    Parallel::forEach(chunks.size(), [&](size_t i) { parseChunk(chunks[i]); });
+    for (const auto& chunk : chunks) {
+        if (chunk.failed) {
+            result.error = chunk.error;
+            return false;
+        }
+    }
+
+    std::map<std::string, int> materialIds;
+    loadMaterials(chunks, mtlSearchPath, result, materialIds);
+
+    // Prefix sums give every chunk its global element offsets.
+    size_t positionFloats = 0;
+    size_t texcoordFloats = 0;
+    size_t normalFloats = 0;
+    for (auto& chunk : chunks) {
+        chunk.positionBase = positionFloats / 3;
+        chunk.texcoordBase = texcoordFloats / 2;
+        chunk.normalBase = normalFloats / 3;
+        positionFloats += chunk.positions.size();
+        texcoordFloats += chunk.texcoords.size();
+        normalFloats += chunk.normals.size();
+    }
+
+    auto& attrib = result.attrib;
+    attrib.vertices.resize(positionFloats);
+    attrib.texcoords.resize(texcoordFloats);
+    attrib.normals.resize(normalFloats);
+    Parallel::forEach(chunks.size(), [&](size_t i) {
+        Chunk& chunk = chunks[i];
+        appendAt(attrib.vertices, chunk.positionBase * 3, chunk.positions);
+        appendAt(attrib.texcoords, chunk.texcoordBase * 2, chunk.texcoords);
+        appendAt(attrib.normals, chunk.normalBase * 3, chunk.normals);
+        std::vector<float>().swap(chunk.positions);
+        std::vector<float>().swap(chunk.texcoords);
+        std::vector<float>().swap(chunk.normals);
+    });
+
+    // `usemtl` stays in effect across chunk boundaries.
+    std::vector<int> firstMaterial(chunks.size(), -1);
+    for (size_t i = 1; i < chunks.size(); ++i) {
+        const auto& previous = chunks[i - 1];
+        firstMaterial[i] = firstMaterial[i - 1];
+        if (!previous.materialSwitches.empty()) {
+            auto it = materialIds.find(previous.materialSwitches.back().name);
+            firstMaterial[i] = it != materialIds.end() ? it->second : -1;
+        }
+    }
+
+    Parallel::forEach(chunks.size(), [&](size_t i) {
+        triangulateChunk(chunks[i], firstMaterial[i], materialIds, attrib);
+    });
+
+    std::vector<size_t> triangleBase(chunks.size() + 1, 0);
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        if (chunks[i].failed) {
+            result.error = chunks[i].error;
+            return false;
+        }
+        triangleBase[i + 1] = triangleBase[i] + chunks[i].triangleMaterials.size();
+    }
+
+    tinyobj::shape_t& shape = result.shapes.emplace_back();
+    shape.mesh.indices.resize(triangleBase.back() * 3);
+    shape.mesh.material_ids.resize(triangleBase.back());
+    shape.mesh.num_face_vertices.assign(triangleBase.back(), 3);
+    Parallel::forEach(chunks.size(), [&](size_t i) {
+        appendAt(shape.mesh.indices, triangleBase[i] * 3, chunks[i].triangles);
+        appendAt(shape.mesh.material_ids, triangleBase[i], chunks[i].triangleMaterials);
+    });
+    return true;
+}
+
+} // namespace ObjParser
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "../vendor/tinyobjloader/tiny_obj_loader.h"
+
+// Multithreaded OBJ reader. The file is mapped, split at line boundaries into
+// chunks that are parsed in parallel, and the chunks are merged with global
+// index fix-up (including negative, relative indices) and `usemtl` spans
+// carried across chunk boundaries.
+//
+// The result uses tinyobj's types and matches what tinyobj::ObjReader produces
+// with triangulation enabled, except that all groups and objects are merged
+// into a single shape (file order is kept) and smoothing groups, lines and
+// points are not tracked.
+
+namespace ObjParser {
+
+    struct Result {
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string warning;
+        std::string error;
+        size_t chunks = 0;  // pieces the file was split into
+    };
+
+    // Returns false if the file cannot be read or is not handled by the fast
+    // path (polygons with more than four corners, out-of-range indices); the
+    // caller should then parse it with tinyobj, which reports the details.
+    // A non-zero chunkBytes replaces the chunk size picked from the file size
+    // and worker count, so tests can split small files at many boundaries.
+    bool parse(const std::string& filename, const std::string& mtlSearchPath, Result& result,
+               size_t chunkBytes = 0);
+
+} // namespace ObjParser
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Minimal fork/join helper for load-time work (texture decoding, parsing).
+// Items are handed out one at a time from a shared counter, so uneven items
+// such as large and small images balance across the workers.
+
+namespace Parallel {
+
+    // Number of threads forEach() would use for `count` items, including the
+    // calling thread.
+    inline unsigned workerCount(size_t count) {
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+        (void)count;
+        return 1;
+#else
+        unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+        return static_cast<unsigned>(std::min<size_t>(hardware, count));
+#endif
+    }
+
+    // Runs fn(i) for every i in [0, count) and returns once all calls finished.
+    // The calling thread takes part in the work. fn must not throw.
+    template <typename Fn>
+    void forEach(size_t count, Fn&& fn) {
+        unsigned workers = workerCount(count);
+        if (workers <= 1) {
+            for (size_t i = 0; i < count; ++i) {
+                fn(i);
+            }
+            return;
+        }
+
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                fn(i);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(workers - 1);
+        for (unsigned t = 1; t < workers; ++t) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+} // namespace Parallel
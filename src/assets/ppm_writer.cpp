@@ -0,0 +1,31 @@
+#include "ppm_writer.hpp"
+
+#include <cstdio>
+#include <vector>
+
+namespace PpmWriter {
+
+bool write(const std::string& path, const uint32_t* pixels, int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    bool ok = std::fprintf(file, "P6\n%d %d\n255\n", width, height) > 0;
+    std::vector<unsigned char> row(static_cast<size_t>(width) * 3);
+    for (int y = 0; y < height && ok; ++y) {
+        const uint32_t* source = pixels + static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; ++x) {
+            row[x * 3 + 0] = static_cast<unsigned char>(source[x] >> 16);
+            row[x * 3 + 1] = static_cast<unsigned char>(source[x] >> 8);
+            row[x * 3 + 2] = static_cast<unsigned char>(source[x]);
+        }
+        ok = std::fwrite(row.data(), 1, row.size(), file) == row.size();
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+} // namespace PpmWriter
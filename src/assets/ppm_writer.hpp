@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Binary PPM (P6) output for frames rendered without a window. The renderer
+// writes 0xAARRGGBB pixels (SDL's ARGB8888); alpha is dropped. PPM needs no
+// encoder, and any image viewer or `convert` turns it into PNG.
+
+namespace PpmWriter {
+
+    // Writes a width x height frame, rows top to bottom. False if the file
+    // cannot be written.
+    bool write(const std::string& path, const uint32_t* pixels, int width, int height);
+
+} // namespace PpmWriter
@@ -1,11 +1,11 @@
 #include "prefab_factory.hpp"
+#include <algorithm>
 #include <cmath>
 #include <filesystem>
-#include <fstream>
 #include <iostream>
 #include <map>
-#include <regex>
-#include <tuple>
+#include <memory>
+#include <utility>
 #include <vector>
 #include <render3d/constants.hpp>
 #include <render3d/material.hpp>
@@ -13,6 +13,12 @@
 #include <render3d/ecs/material_system.hpp>
 #include <render3d/ecs/mesh_system.hpp>
 #include <render3d/ecs/transform_system.hpp>
+#include "asc_parser.hpp"
+#include "mapped_file.hpp"
+#include "mesh_cache.hpp"
+#include "obj_parser.hpp"
+#include "parallel_for.hpp"
+#include "vertex_dedup.hpp"
 #include "texture_loader.hpp"
 #include "../vendor/tinyobjloader/tiny_obj_loader.h"
 
@@ -63,6 +69,163 @@ namespace {
         }
     }
 
+    std::filesystem::path resolveTexturePath(const std::filesystem::path& basePath,
+                                             const std::string& name) {
+        std::string normalized = name;
+        std::replace(normalized.begin(), normalized.end(), '\\', '/');
+        return basePath / normalized;
+    }
+
+    // Converts the MTL materials of an OBJ into MaterialComponent entries.
+    // Texture files are checked serially, so missing-file reports keep their
+    // order, then every distinct file is decoded on the worker pool and the
+    // results are joined before the material map is filled in.
+    void addObjMaterials(const std::vector<tinyobj::material_t>& mats,
+                         const std::filesystem::path& basePath,
+                         MaterialComponent& material) {
+        enum class TextureMap { Diffuse, Specular, SpecularHighlight };
+        struct TextureSlot {
+            size_t material;
+            TextureMap map;
+            size_t job;
+        };
+
+        std::vector<std::string> jobPaths;
+        std::map<std::string, size_t> jobByPath;
+        std::vector<TextureSlot> slots;
+
+        auto request = [&](size_t matIndex, const std::string& texname,
+                           TextureMap map, bool reportMissing) {
+            if (texname.empty()) {
+                return;
+            }
+            std::filesystem::path texPath = resolveTexturePath(basePath, texname);
+            if (!std::filesystem::exists(texPath)) {
+                if (reportMissing) {
+                    std::cerr << "Texture not found: " << texPath << "\n";
+                }
+                return;
+            }
+            auto [it, inserted] = jobByPath.insert({texPath.string(), jobPaths.size()});
+            if (inserted) {
+                jobPaths.push_back(texPath.string());
+            }
+            slots.push_back({matIndex, map, it->second});
+        };
+
+        for (size_t i = 0; i < mats.size(); ++i) {
+            request(i, mats[i].diffuse_texname, TextureMap::Diffuse, true);
+            request(i, mats[i].specular_texname, TextureMap::Specular, false);
+            request(i, mats[i].specular_highlight_texname, TextureMap::SpecularHighlight, false);
+        }
+
+        std::vector<std::shared_ptr<const Texture>> decoded(jobPaths.size());
+        Parallel::forEach(jobPaths.size(), [&](size_t job) {
+            decoded[job] = TextureLoader::loadShared(jobPaths[job]);
+        });
+
+        std::vector<Material> built(mats.size());
+        for (size_t i = 0; i < mats.size(); ++i) {
+            const auto& mat = mats[i];
+            Material& m = built[i];
+
+            m.Ns = mat.shininess;
+            m.Ka = { mat.ambient[0], mat.ambient[1], mat.ambient[2] };
+            m.Kd = { mat.diffuse[0], mat.diffuse[1], mat.diffuse[2] };
+            m.Ks = { mat.specular[0], mat.specular[1], mat.specular[2] };
+            m.Ke = { mat.emission[0], mat.emission[1], mat.emission[2] };
+            m.Ni = mat.ior;
+            m.d = mat.dissolve;
+            m.illum = mat.illum;
+        }
+
+        for (const auto& slot : slots) {
+            const auto& texture = decoded[slot.job];
+            if (!texture) {
+                continue;
+            }
+            Material& m = built[slot.material];
+            switch (slot.map) {
+                case TextureMap::Diffuse:           m.map_Kd = *texture; break;
+                case TextureMap::Specular:          m.map_Ks = *texture; break;
+                case TextureMap::SpecularHighlight: m.map_Ns = *texture; break;
+            }
+        }
+
+        for (size_t i = 0; i < mats.size(); ++i) {
+            material.materials[mats[i].name] = std::move(built[i]);
+        }
+    }
+
+
+    // Reads the MTL libraries an OBJ names without parsing the OBJ itself;
+    // used when the geometry comes from the mesh cache.
+    std::vector<tinyobj::material_t> loadMaterialLibraries(const std::vector<std::string>& libraries,
+                                                           const std::filesystem::path& basePath) {
+        std::vector<tinyobj::material_t> mats;
+        std::map<std::string, int> materialIds;
+        tinyobj::MaterialFileReader reader(basePath.string());
+        for (const auto& library : libraries) {
+            std::string warning;
+            std::string error;
+            if (!reader(library, &mats, &materialIds, &warning, &error)) {
+                std::cerr << "OBJ warning: " << warning << error << "\n";
+            }
+        }
+        return mats;
+    }
+
+    // Fallback material for OBJ faces without a usemtl.
+    void addDefaultObjMaterial(MaterialComponent& material) {
+        MaterialProperties properties = MaterialSystem::getMaterialProperties(MaterialType::Metal);
+        material.materials.insert({"default", initMaterialWithTexture(
+            properties,
+            slib::vec3{0.1f, 0.1f, 0.1f},
+            slib::vec3{0.8f, 0.8f, 0.8f},
+            slib::vec3{1.0f, 1.0f, 1.0f},
+            std::string(RES_PATH) + "checker-map_tho.png",
+            TextureFilter::NEIGHBOUR
+        )});
+    }
+
+    // ASC files carry no materials; faces use "blue".
+    void addAscMaterials(MaterialComponent& material) {
+        MaterialProperties properties = MaterialSystem::getMaterialProperties(MaterialType::Metal);
+        std::string mtlPath = "checker-map_tho.png";
+
+        Material mat = initMaterialWithTexture(
+            properties,
+            slib::vec3{0x00, 0x00, 0x00},
+            slib::vec3{0x00, 0x58, 0xfc},
+            slib::vec3{0xff, 0xff, 0xff},
+            std::string(RES_PATH + mtlPath),
+            TextureFilter::NEIGHBOUR
+        );
+        material.materials.insert({"blue", std::move(mat)});
+
+        mat = initMaterialWithTexture(
+            properties,
+            slib::vec3{0x00, 0x00, 0x00},
+            slib::vec3{0xff, 0xff, 0xff},
+            slib::vec3{0xff, 0xff, 0xff},
+            std::string(RES_PATH + mtlPath),
+            TextureFilter::NEIGHBOUR
+        );
+        material.materials.insert({"white", std::move(mat)});
+    }
+
+    // Parses an OBJ with the multithreaded reader. Files outside its fast
+    // path (n-gons, bad indices) go through tinyobj, which also reports why.
+    bool readObj(const std::string& filename, const std::filesystem::path& basePath,
+                 ObjParser::Result& obj) {
+        if (ObjParser::parse(filename, basePath.string(), obj)) {
+            return true;
+        }
+        obj = ObjParser::Result{};
+        return tinyobj::LoadObj(&obj.attrib, &obj.shapes, &obj.materials,
+                                &obj.warning, &obj.error, filename.c_str(),
+                                basePath.string().c_str(), true);
+    }
 }
 
 namespace PrefabFactory {
@@ -102,7 +265,7 @@ namespace PrefabFactory {
             slib::vec3{0xff, 0xff, 0xff},
             std::string(RES_PATH + mtlPath)
         );
-        material.materials.insert({materialKey, mat});
+        material.materials.insert({materialKey, std::move(mat)});
 
         for (int baseIndex = 0; baseIndex < 4 * 6; baseIndex += 4) {
             FaceData face;
@@ -138,7 +301,7 @@ namespace PrefabFactory {
             slib::vec3{0xaa, 0xaa, 0xaa},
             slib::vec3{0xff, 0xff, 0xff}
         );
-        material.materials.insert({materialKey, mat});
+        material.materials.insert({materialKey, std::move(mat)});
 
         FaceData face;
         face.face.vertexIndices = { 0, 1, 2, 3 };
@@ -312,7 +475,7 @@ namespace PrefabFactory {
             std::string(RES_PATH + mtlPath),
             TextureFilter::BILINEAR_INT
         );
-        material.materials.insert({"red", mat});
+        material.materials.insert({"red", std::move(mat)});
 
         mat = initMaterialWithTexture(
             properties,
@@ -322,7 +485,7 @@ namespace PrefabFactory {
             std::string(RES_PATH + mtlPath),
             TextureFilter::BILINEAR_INT
         );
-        material.materials.insert({"white", mat});
+        material.materials.insert({"white", std::move(mat)});
 
         std::vector<FaceData> faces;
         for (int i = 0; i < lat; i++) {
@@ -439,11 +602,11 @@ namespace PrefabFactory {
             Material mat = initMaterialWithTexture(props,
                 slib::vec3{0x00, 0x58, 0xfc}, slib::vec3{0x00, 0x58, 0xfc}, slib::vec3{0x00, 0x58, 0xfc},
                 path, TextureFilter::NEIGHBOUR);
-            material.materials.insert({"blue", mat});
+            material.materials.insert({"blue", std::move(mat)});
             mat = initMaterialWithTexture(props,
                 slib::vec3{0xff, 0xff, 0xff}, slib::vec3{0xff, 0xff, 0xff}, slib::vec3{0xff, 0xff, 0xff},
                 path, TextureFilter::NEIGHBOUR);
-            material.materials.insert({"white", mat});
+            material.materials.insert({"white", std::move(mat)});
         }
 
         const uint16_t quads[6][4] = {
@@ -519,7 +682,7 @@ namespace PrefabFactory {
         );
         mat.illum = 1;
         mat.Ke = { props.k_a * 0xff, props.k_a * 0xff, props.k_a * 0xff };
-        material.materials.insert({"white", mat});
+        material.materials.insert({"white", std::move(mat)});
 
         const uint16_t F[20][3] = {
             {0,11,5}, {0,5,1}, {0,1,7}, {0,7,10}, {0,10,11},
@@ -569,7 +732,7 @@ namespace PrefabFactory {
             slib::vec3{0x00, 0x58, 0xfc},
             slib::vec3{0x00, 0x58, 0xfc}
         );
-        material.materials.insert({"blue", mat});
+        material.materials.insert({"blue", std::move(mat)});
 
         mat = initMaterialWithTexture(
             properties,
@@ -577,7 +740,7 @@ namespace PrefabFactory {
             slib::vec3{0xff, 0xff, 0xff},
             slib::vec3{0xff, 0xff, 0xff}
         );
-        material.materials.insert({"white", mat});
+        material.materials.insert({"white", std::move(mat)});
 
         std::vector<FaceData> faces;
 
@@ -615,153 +778,150 @@ namespace PrefabFactory {
         MeshSystem::updateRadius(mesh);
     }
 
+    void restoreObj(const std::string& filename, const std::vector<std::string>& materialLibraries,
+                    MeshComponent& mesh, MaterialComponent& material, TransformComponent& transform) {
+        std::filesystem::path basePath = std::filesystem::path(filename).parent_path();
+        addDefaultObjMaterial(material);
+        addObjMaterials(loadMaterialLibraries(materialLibraries, basePath), basePath, material);
+
+        MeshSystem::updateFaceNormals(mesh);
+        MeshSystem::updateRadius(mesh);
+        TransformSystem::scaleToRadius(transform, mesh.radius, 400.0f);
+    }
+
+    void restoreAsc(MeshComponent& mesh, MaterialComponent& material) {
+        addAscMaterials(material);
+        MeshSystem::updateFaceNormals(mesh);
+        MeshSystem::updateRadius(mesh);
+    }
+
     bool buildObj(const std::string& filename, MeshComponent& mesh,
-                  MaterialComponent& material, TransformComponent& transform) {
+                  MaterialComponent& material, TransformComponent& transform,
+                  bool useMeshCache) {
         std::filesystem::path filePath(filename);
         std::filesystem::path basePath = filePath.parent_path();
 
-        tinyobj::ObjReaderConfig config;
-        config.triangulate = true;
-        config.mtl_search_path = basePath.string();
+        MeshCache::SourceInfo source;
+        if (useMeshCache && MeshCache::isEnabled()) {
+            source = MeshCache::describeSource(filename);
+        }
+        const std::string cachePath = MeshCache::cachePathFor(filename);
+
+        bool cachedNormals = false;
+        if (source.valid && MeshCache::load(cachePath, source.hash, mesh, cachedNormals)) {
+            restoreObj(filename, source.materialLibraries, mesh, material, transform);
+
+            // Import logs go to stderr: --bench and --memory-report may be
+            // writing JSON to stdout.
+            std::clog << "Loaded OBJ (mesh cache): " << filename << "\n";
+            std::clog << "  Final vertices: " << mesh.vertexData.size() << "\n";
+            std::clog << "  Faces: " << mesh.faceData.size() << "\n";
+            std::clog << "  Materials: " << material.materials.size() << "\n";
+            return cachedNormals;
+        }
 
-        tinyobj::ObjReader reader;
-        if (!reader.ParseFromFile(filename, config)) {
-            std::cerr << "Failed to parse OBJ file: " << reader.Error() << "\n";
+        ObjParser::Result obj;
+        if (!readObj(filename, basePath, obj)) {
+            std::cerr << "Failed to parse OBJ file: " << obj.error << "\n";
             return false;
         }
-        if (!reader.Warning().empty()) {
-            std::cerr << "OBJ warning: " << reader.Warning() << "\n";
+        if (!obj.warning.empty()) {
+            std::cerr << "OBJ warning: " << obj.warning << "\n";
         }
 
-        const auto& attrib = reader.GetAttrib();
-        const auto& shapes = reader.GetShapes();
-        const auto& mats = reader.GetMaterials();
+        const auto& attrib = obj.attrib;
+        const auto& shapes = obj.shapes;
+        const auto& mats = obj.materials;
 
         bool hasLoadedNormals = !attrib.normals.empty();
         bool hasTexCoords = !attrib.texcoords.empty();
 
-        MaterialProperties properties = MaterialSystem::getMaterialProperties(MaterialType::Metal);
-        std::string defaultTexturePath = "checker-map_tho.png";
-
-        Material defaultMaterial = initMaterialWithTexture(
-            properties,
-            slib::vec3{0.1f, 0.1f, 0.1f},
-            slib::vec3{0.8f, 0.8f, 0.8f},
-            slib::vec3{1.0f, 1.0f, 1.0f},
-            std::string(RES_PATH + defaultTexturePath),
-            TextureFilter::NEIGHBOUR
-        );
-        material.materials.insert({"default", defaultMaterial});
-
-        for (size_t i = 0; i < mats.size(); ++i) {
-            const auto& mat = mats[i];
-            Material m{};
+        addDefaultObjMaterial(material);
+        addObjMaterials(mats, basePath, material);
 
-            m.Ns = mat.shininess;
-            m.Ka = { mat.ambient[0], mat.ambient[1], mat.ambient[2] };
-            m.Kd = { mat.diffuse[0], mat.diffuse[1], mat.diffuse[2] };
-            m.Ks = { mat.specular[0], mat.specular[1], mat.specular[2] };
-            m.Ke = { mat.emission[0], mat.emission[1], mat.emission[2] };
-            m.Ni = mat.ior;
-            m.d = mat.dissolve;
-            m.illum = mat.illum;
-
-                auto resolveTexPath = [&](const std::string& name) {
-                std::string normalized = name;
-                std::replace(normalized.begin(), normalized.end(), '\\', '/');
-                return basePath / normalized;
-            };
-
-            if (!mat.diffuse_texname.empty()) {
-                std::filesystem::path texPath = resolveTexPath(mat.diffuse_texname);
-                if (std::filesystem::exists(texPath)) {
-                    m.map_Kd = TextureLoader::load(texPath.string());
-                } else {
-                    std::cerr << "Texture not found: " << texPath << "\n";
-                }
-            }
-
-            if (!mat.specular_texname.empty()) {
-                std::filesystem::path texPath = resolveTexPath(mat.specular_texname);
-                if (std::filesystem::exists(texPath)) {
-                    m.map_Ks = TextureLoader::load(texPath.string());
-                }
-            }
+        size_t cornerCount = 0;
+        size_t faceCount = 0;
+        for (const auto& shape : shapes) {
+            cornerCount += shape.mesh.indices.size();
+            faceCount += shape.mesh.num_face_vertices.size();
+        }
 
-            if (!mat.specular_highlight_texname.empty()) {
-                std::filesystem::path texPath = resolveTexPath(mat.specular_highlight_texname);
-                if (std::filesystem::exists(texPath)) {
-                    m.map_Ns = TextureLoader::load(texPath.string());
+        // Pass 1: map every corner to its final vertex index. New indices are
+        // handed out in order of first appearance, and the table is sized
+        // once from the corner count, so this pass does not allocate per corner.
+        VertexDedupTable vertexMap(cornerCount);
+        std::vector<int> cornerVertex(cornerCount);
+        {
+            size_t corner = 0;
+            for (const auto& shape : shapes) {
+                for (const auto& idx : shape.mesh.indices) {
+                    cornerVertex[corner++] = vertexMap.findOrInsert(
+                        idx.vertex_index, idx.texcoord_index, idx.normal_index,
+                        static_cast<int>(vertexMap.size()));
                 }
             }
-
-            material.materials[mat.name] = m;
         }
 
-        std::map<std::tuple<int, int, int>, int> vertexMap;
-        std::vector<VertexData> finalVertices;
+        // Pass 2: both outputs now have exact sizes. A corner whose index
+        // equals the number of vertices emitted so far is a first occurrence.
+        std::vector<VertexData> finalVertices(vertexMap.size());
         std::vector<FaceData> faces;
+        faces.reserve(faceCount);
 
+        size_t corner = 0;
+        size_t emitted = 0;
         for (const auto& shape : shapes) {
             const auto& m = shape.mesh;
             size_t indexOffset = 0;
             for (size_t f = 0; f < m.num_face_vertices.size(); ++f) {
                 int faceVertCount = m.num_face_vertices[f];
 
-                FaceData faceData;
+                FaceData& faceData = faces.emplace_back();
                 int matId = m.material_ids[f];
                 if (matId >= 0 && matId < static_cast<int>(mats.size())) {
                     faceData.face.materialKey = mats[matId].name;
                 } else {
                     faceData.face.materialKey = "default";
                 }
+                faceData.face.vertexIndices.reserve(faceVertCount);
+
+                for (int v = 0; v < faceVertCount; ++v, ++corner) {
+                    int finalIndex = cornerVertex[corner];
+                    faceData.face.vertexIndices.push_back(finalIndex);
+                    if (static_cast<size_t>(finalIndex) != emitted) {
+                        continue;
+                    }
+                    ++emitted;
 
-                for (int v = 0; v < faceVertCount; ++v) {
                     const auto& idx = m.indices[indexOffset + v];
                     int posIdx = idx.vertex_index;
                     int texIdx = idx.texcoord_index;
                     int normIdx = idx.normal_index;
+                    VertexData& vd = finalVertices[finalIndex];
 
-                    auto key = std::make_tuple(posIdx, texIdx, normIdx);
+                    if (posIdx >= 0) {
+                        vd.vertex.x = attrib.vertices[3 * posIdx + 0];
+                        vd.vertex.y = attrib.vertices[3 * posIdx + 1];
+                        vd.vertex.z = attrib.vertices[3 * posIdx + 2];
+                    }
 
-                    int finalIndex;
-                    auto it = vertexMap.find(key);
-                    if (it != vertexMap.end()) {
-                        finalIndex = it->second;
+                    if (texIdx >= 0) {
+                        vd.texCoord.x = attrib.texcoords[2 * texIdx + 0];
+                        // OBJ V=0 is bottom; stb_image row 0 is top — flip to match
+                        vd.texCoord.y = 1.0f - attrib.texcoords[2 * texIdx + 1];
                     } else {
-                        VertexData vd;
-
-                        if (posIdx >= 0) {
-                            vd.vertex.x = attrib.vertices[3 * posIdx + 0];
-                            vd.vertex.y = attrib.vertices[3 * posIdx + 1];
-                            vd.vertex.z = attrib.vertices[3 * posIdx + 2];
-                        }
-
-                        if (texIdx >= 0) {
-                            vd.texCoord.x = attrib.texcoords[2 * texIdx + 0];
-                            // OBJ V=0 is bottom; stb_image row 0 is top — flip to match
-                            vd.texCoord.y = 1.0f - attrib.texcoords[2 * texIdx + 1];
-                        } else {
-                            vd.texCoord = { 0.0f, 0.0f };
-                        }
-
-                        if (normIdx >= 0) {
-                            vd.normal.x = attrib.normals[3 * normIdx + 0];
-                            vd.normal.y = attrib.normals[3 * normIdx + 1];
-                            vd.normal.z = attrib.normals[3 * normIdx + 2];
-                        } else {
-                            vd.normal = { 0.0f, 0.0f, 0.0f };
-                        }
-
-                        finalIndex = static_cast<int>(finalVertices.size());
-                        finalVertices.push_back(vd);
-                        vertexMap[key] = finalIndex;
+                        vd.texCoord = { 0.0f, 0.0f };
                     }
 
-                    faceData.face.vertexIndices.push_back(finalIndex);
+                    if (normIdx >= 0) {
+                        vd.normal.x = attrib.normals[3 * normIdx + 0];
+                        vd.normal.y = attrib.normals[3 * normIdx + 1];
+                        vd.normal.z = attrib.normals[3 * normIdx + 2];
+                    } else {
+                        vd.normal = { 0.0f, 0.0f, 0.0f };
+                    }
                 }
 
-                faces.push_back(faceData);
                 indexOffset += faceVertCount;
             }
         }
@@ -790,14 +950,14 @@ namespace PrefabFactory {
             }
         }
 
-        std::cout << "Loaded OBJ: " << filename << "\n";
-        std::cout << "  Positions: " << attrib.vertices.size() / 3 << "\n";
-        std::cout << "  Texture coords: " << attrib.texcoords.size() / 2 << "\n";
-        std::cout << "  Normals: " << attrib.normals.size() / 3
+        std::clog << "Loaded OBJ: " << filename << "\n";
+        std::clog << "  Positions: " << attrib.vertices.size() / 3 << "\n";
+        std::clog << "  Texture coords: " << attrib.texcoords.size() / 2 << "\n";
+        std::clog << "  Normals: " << attrib.normals.size() / 3
                   << (hasLoadedNormals ? " (using file normals)" : " (will calculate)") << "\n";
-        std::cout << "  Final vertices: " << finalVertices.size() << "\n";
-        std::cout << "  Faces: " << faces.size() << "\n";
-        std::cout << "  Materials: " << material.materials.size() << "\n";
+        std::clog << "  Final vertices: " << finalVertices.size() << "\n";
+        std::clog << "  Faces: " << faces.size() << "\n";
+        std::clog << "  Materials: " << material.materials.size() << "\n";
 
         mesh.vertexData = std::move(finalVertices);
         mesh.faceData = std::move(faces);
@@ -809,107 +969,48 @@ namespace PrefabFactory {
         MeshSystem::updateRadius(mesh);
         TransformSystem::scaleToRadius(transform, mesh.radius, 400.0f);
 
+        if (source.valid) {
+            MeshCache::save(cachePath, source.hash, mesh, hasLoadedNormals);
+        }
+
         return hasLoadedNormals;
     }
 
     void buildAsc(const std::string& filename, MeshComponent& mesh,
-                  MaterialComponent& material) {
-        std::ifstream file(filename);
-        if (!file.is_open()) {
+                  MaterialComponent& material, bool useMeshCache) {
+        MappedFile file;
+        if (!file.open(filename)) {
             std::cerr << "Failed to open file.\n";
             return;
         }
 
-        std::string line;
-        bool readingVertices = false;
-        bool readingFaces = false;
-
-        std::vector<VertexData> vertices;
-        std::vector<FaceData> faces;
+        addAscMaterials(material);
 
-        MaterialProperties properties = MaterialSystem::getMaterialProperties(MaterialType::Metal);
-        std::string mtlPath = "checker-map_tho.png";
-
-        Material mat = initMaterialWithTexture(
-            properties,
-            slib::vec3{0x00, 0x00, 0x00},
-            slib::vec3{0x00, 0x58, 0xfc},
-            slib::vec3{0xff, 0xff, 0xff},
-            std::string(RES_PATH + mtlPath),
-            TextureFilter::NEIGHBOUR
-        );
-        material.materials.insert({"blue", mat});
-
-        mat = initMaterialWithTexture(
-            properties,
-            slib::vec3{0x00, 0x00, 0x00},
-            slib::vec3{0xff, 0xff, 0xff},
-            slib::vec3{0xff, 0xff, 0xff},
-            std::string(RES_PATH + mtlPath),
-            TextureFilter::NEIGHBOUR
-        );
-        material.materials.insert({"white", mat});
-
-        while (std::getline(file, line)) {
-            line.erase(0, line.find_first_not_of(" \t\r\n"));
-            line.erase(line.find_last_not_of(" \t\r\n") + 1);
-
-            if (line.empty())
-                continue;
-
-            if (line.find("Vertex list:") != std::string::npos) {
-                readingVertices = true;
-                readingFaces = false;
-                continue;
-            }
-
-            if (line.find("Face list:") != std::string::npos) {
-                readingVertices = false;
-                readingFaces = true;
-                continue;
-            }
-
-            if (readingVertices) {
-                if (line.find("Vertex") != std::string::npos) {
-                    VertexData vertexData;
-                    std::regex vertexRegex(R"(Vertex\s+\d+:\s+X:\s+([-.\dEe]+)\s+Y:\s+([-.\dEe]+)\s+Z:\s+([-.\dEe]+))");
-                    std::smatch match;
-
-                    if (std::regex_search(line, match, vertexRegex)) {
-                        vertexData.vertex.x = std::stof(match[1]);
-                        vertexData.vertex.y = std::stof(match[2]);
-                        vertexData.vertex.z = std::stof(match[3]);
-                        vertices.push_back(vertexData);
-                    }
-                }
-            }
+        MeshCache::SourceInfo source;
+        if (useMeshCache && MeshCache::isEnabled()) {
+            source = MeshCache::describeSource(filename);
+        }
+        const std::string cachePath = MeshCache::cachePathFor(filename);
 
-            if (readingFaces) {
-                if (line.find("Face") != std::string::npos) {
-                    std::regex faceRegex(R"(Face\s+\d+:\s+A:(\d+)\s+B:(\d+)\s+C:(\d+))");
-                    std::smatch match;
-
-                    if (std::regex_search(line, match, faceRegex)) {
-                        FaceData faceData;
-                        faceData.face.vertexIndices.push_back(std::stoi(match[1]));
-                        faceData.face.vertexIndices.push_back(std::stoi(match[2]));
-                        faceData.face.vertexIndices.push_back(std::stoi(match[3]));
-                        faceData.face.materialKey = "blue";
-                        faces.push_back(faceData);
-                    }
-                }
-            }
+        bool cachedNormals = false;
+        if (source.valid && MeshCache::load(cachePath, source.hash, mesh, cachedNormals)) {
+            std::clog << "Loaded ASC (mesh cache): " << filename << "\n";
+            MeshSystem::updateFaceNormals(mesh);
+            MeshSystem::updateRadius(mesh);
+            return;
         }
 
+        AscParser::Result parsed;
+        AscParser::parse(file.data(), file.size(), parsed);
         file.close();
+        for (auto& face : parsed.faces) {
+            face.face.materialKey = "blue";
+        }
 
-        int num_vertex = static_cast<int>(vertices.size());
-        int num_faces = static_cast<int>(faces.size());
-
-        std::cout << "Total vertices: " << num_vertex << "\n";
-        std::cout << "Total faces: " << num_faces << "\n";
+        std::clog << "Total vertices: " << parsed.vertices.size() << "\n";
+        std::clog << "Total faces: " << parsed.faces.size() << "\n";
 
-        mesh.vertexData = vertices;
+        mesh.vertexData = std::move(parsed.vertices);
 
         float x_min = 0.0f;
         float y_min = 0.0f;
@@ -928,11 +1029,15 @@ namespace PrefabFactory {
             vertex.texCoord.y = (vertex.vertex.y - y_min) / (y_max - y_min);
         }
 
-        mesh.faceData = faces;
+        mesh.faceData = std::move(parsed.faces);
 
         MeshSystem::updateFaceNormals(mesh);
         MeshSystem::updateVertexNormals(mesh);
         MeshSystem::updateRadius(mesh);
+
+        if (source.valid) {
+            MeshCache::save(cachePath, source.hash, mesh, false);
+        }
     }
 
 } // namespace PrefabFactory
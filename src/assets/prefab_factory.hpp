@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <vector>
 #include <render3d/ecs/mesh_component.hpp>
 #include <render3d/ecs/material_component.hpp>
 #include <render3d/ecs/transform_component.hpp>
@@ -23,9 +24,20 @@ namespace PrefabFactory {
     void buildIcosahedron(MeshComponent& mesh, MaterialComponent& material);
     void buildTest(MeshComponent& mesh, MaterialComponent& material);
 
+    // File importers. When useMeshCache is set the cooked "<file>.r3dmesh"
+    // written by MeshCache is used if it matches the source, and (re)written
+    // after a full import otherwise.
     bool buildObj(const std::string& filename, MeshComponent& mesh,
-                  MaterialComponent& material, TransformComponent& transform);
+                  MaterialComponent& material, TransformComponent& transform,
+                  bool useMeshCache = true);
     void buildAsc(const std::string& filename, MeshComponent& mesh,
-                  MaterialComponent& material);
+                  MaterialComponent& material, bool useMeshCache = true);
+
+    // Finish an imported solid whose cooked mesh (as MeshCache stores it) is
+    // already in `mesh`: add its materials and redo the post-processing a
+    // mesh cache hit does. `materialLibraries` are the OBJ's mtllib names.
+    void restoreObj(const std::string& filename, const std::vector<std::string>& materialLibraries,
+                    MeshComponent& mesh, MaterialComponent& material, TransformComponent& transform);
+    void restoreAsc(MeshComponent& mesh, MaterialComponent& material);
 
 } // namespace PrefabFactory
@@ -0,0 +1,218 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "json_string.hpp"
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    const Clock::time_point epoch = Clock::now();
+
+    // Zones the owning thread has open are only touched by it; finished ones
+    // are handed to endFrame() under the buffer's mutex, which is
+    // uncontended except while a frame is being closed.
+    struct ThreadBuffer {
+        uint32_t id = 0;
+        std::vector<Profiler::Zone> open;
+        std::mutex mutex;
+        std::vector<Profiler::Zone> finished;
+        std::atomic<bool> retired{false};  // its thread has exited
+    };
+
+    std::atomic<bool> recording{true};
+
+    std::mutex registryMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::map<uint32_t, std::string> threadNames;
+    uint32_t nextThreadId = 1;
+    std::deque<Profiler::Frame> kept;
+    uint64_t frameCounter = 0;
+    int64_t lastFrameEndNs = -1;
+
+    // Marks the buffer retired when its thread exits; endFrame() drops it
+    // once drained. Worker threads come and go with every Parallel::forEach.
+    struct BufferHolder {
+        std::shared_ptr<ThreadBuffer> buffer;
+        ~BufferHolder() {
+            if (buffer) {
+                buffer->retired = true;
+            }
+        }
+    };
+    thread_local BufferHolder holder;
+
+    ThreadBuffer& localBuffer() {
+        if (!holder.buffer) {
+            auto buffer = std::make_shared<ThreadBuffer>();
+            std::lock_guard<std::mutex> lock(registryMutex);
+            buffer->id = nextThreadId++;
+            buffers.push_back(buffer);
+            holder.buffer = std::move(buffer);
+        }
+        return *holder.buffer;
+    }
+
+    // A complete ("X") event; times in microseconds.
+    void appendEvent(std::string& out, const char* name, uint32_t thread, int64_t startNs,
+                     int64_t endNs) {
+        out += out.back() == '[' ? "\n  {\"name\": " : ",\n  {\"name\": ";
+        Json::appendString(out, name);
+        char text[128];
+        std::snprintf(text, sizeof(text),
+                      ", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+                      thread, startNs / 1000.0, (endNs - startNs) / 1000.0);
+        out += text;
+    }
+
+}
+
+namespace Profiler {
+
+void setEnabled(bool enabled) {
+    recording = enabled;
+}
+
+bool enabled() {
+    return recording;
+}
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count();
+}
+
+void beginZone(const char* name) {
+    ThreadBuffer& buffer = localBuffer();
+    Zone zone;
+    zone.name = name;
+    zone.thread = buffer.id;
+    zone.depth = static_cast<uint32_t>(buffer.open.size());
+    zone.startNs = nowNs();
+    buffer.open.push_back(zone);
+}
+
+void endZone() {
+    ThreadBuffer& buffer = localBuffer();
+    if (buffer.open.empty()) {
+        return;
+    }
+    Zone zone = buffer.open.back();
+    buffer.open.pop_back();
+    if (!recording) {
+        return;
+    }
+    zone.endNs = nowNs();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.finished.push_back(zone);
+}
+
+void endFrame() {
+    const int64_t now = nowNs();
+    const uint32_t thread = threadId();
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    const bool first = lastFrameEndNs < 0;
+    Frame frame;
+    frame.index = frameCounter++;
+    frame.thread = thread;
+    frame.startNs = first ? now : lastFrameEndNs;
+    frame.endNs = now;
+    lastFrameEndNs = now;
+
+    for (const auto& buffer : buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        frame.zones.insert(frame.zones.end(), buffer->finished.begin(), buffer->finished.end());
+        buffer->finished.clear();
+    }
+    // The first frame spans whatever was recorded before it, e.g. loading.
+    if (first) {
+        for (const Zone& zone : frame.zones) {
+            frame.startNs = std::min(frame.startNs, zone.startNs);
+        }
+    }
+    buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                                 [](const std::shared_ptr<ThreadBuffer>& buffer) {
+                                     return buffer->retired.load();
+                                 }),
+                  buffers.end());
+
+    if (!recording) {
+        return;
+    }
+    kept.push_back(std::move(frame));
+    while (kept.size() > kMaxFrames) {
+        kept.pop_front();
+    }
+}
+
+uint32_t threadId() {
+    return localBuffer().id;
+}
+
+void setThreadName(const char* name) {
+    const uint32_t id = threadId();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    threadNames[id] = name;
+}
+
+std::vector<Frame> frames(size_t last) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    const size_t count = std::min(last, kept.size());
+    return std::vector<Frame>(kept.end() - count, kept.end());
+}
+
+void clear() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    kept.clear();
+    for (const auto& buffer : buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->finished.clear();
+    }
+    lastFrameEndNs = -1;
+}
+
+std::string toChromeTrace(const std::vector<Frame>& frames) {
+    std::string out = "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    std::map<uint32_t, std::string> names;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        names = threadNames;
+    }
+    for (const auto& [thread, name] : names) {
+        out += out.back() == '[' ? "\n  {\"name\": \"thread_name\"" : ",\n  {\"name\": \"thread_name\"";
+        out += ", \"ph\": \"M\", \"pid\": 1, \"tid\": " + std::to_string(thread) +
+               ", \"args\": {\"name\": ";
+        Json::appendString(out, name);
+        out += "}}";
+    }
+    for (const Frame& frame : frames) {
+        const std::string name = "Frame " + std::to_string(frame.index);
+        appendEvent(out, name.c_str(), frame.thread, frame.startNs, frame.endNs);
+        for (const Zone& zone : frame.zones) {
+            appendEvent(out, zone.name, zone.thread, zone.startNs, zone.endNs);
+        }
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+bool writeChromeTrace(const std::string& path, size_t lastFrames) {
+    const std::string json = toChromeTrace(frames(lastFrames));
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    const bool written = std::fwrite(json.data(), 1, json.size(), file) == json.size();
+    return std::fclose(file) == 0 && written;
+}
+
+} // namespace Profiler
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Process-wide frame profiler. PROFILE_ZONE("name") times the enclosing
+// scope; zones opened inside it nest under it. Each thread records into its
+// own buffer, so zones on loader and worker threads cost no more than those
+// on the render thread. PROFILE_FRAME() closes the frame: the zones every
+// thread finished since the previous call are gathered into it, and the last
+// kMaxFrames frames are kept for the UI and for Chrome trace export (open
+// the file in Perfetto or chrome://tracing).
+//
+// The macros expand to nothing unless PROFILER_ENABLED is defined (CMake
+// option ENABLE_PROFILER), so release builds carry no timing calls. The
+// functions below stay available either way and simply see no zones.
+
+namespace Profiler {
+
+    struct Zone {
+        const char* name = "";  // must outlive the profiler: a string literal
+        uint32_t thread = 0;    // threadId() of the recording thread
+        uint32_t depth = 0;     // zones open around it on its thread
+        int64_t startNs = 0;    // since the profiler's epoch
+        int64_t endNs = 0;
+    };
+
+    struct Frame {
+        uint64_t index = 0;
+        uint32_t thread = 0;  // the thread that closed it
+        int64_t startNs = 0;
+        int64_t endNs = 0;
+        std::vector<Zone> zones;  // in the order they finished, per thread
+
+        double ms() const { return (endNs - startNs) / 1e6; }
+    };
+
+    constexpr size_t kMaxFrames = 300;
+
+    constexpr bool compiledIn() {
+#ifdef PROFILER_ENABLED
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Recording can be paused at run time; zones open when it is turned off
+    // are dropped.
+    void setEnabled(bool enabled);
+    bool enabled();
+
+    int64_t nowNs();
+
+    void beginZone(const char* name);
+    void endZone();
+    void endFrame();
+
+    // Small sequential id of the calling thread; also its Chrome trace tid.
+    uint32_t threadId();
+    // Label shown for the calling thread in exported traces.
+    void setThreadName(const char* name);
+
+    // Copies of the kept frames, oldest first; at most `last` of them.
+    std::vector<Frame> frames(size_t last = kMaxFrames);
+
+    // Drops kept frames and the zones not yet gathered into one.
+    void clear();
+
+    // The frames as a Chrome trace_event JSON object, frames included as
+    // zones of their own.
+    std::string toChromeTrace(const std::vector<Frame>& frames);
+    bool writeChromeTrace(const std::string& path, size_t lastFrames = kMaxFrames);
+
+    class Scope {
+    public:
+        explicit Scope(const char* name) : active(enabled()) {
+            if (active) {
+                beginZone(name);
+            }
+        }
+        ~Scope() {
+            if (active) {
+                endZone();
+            }
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        bool active;
+    };
+
+} // namespace Profiler
+
+#ifdef PROFILER_ENABLED
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ::Profiler::Scope PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_FRAME() ::Profiler::endFrame()
+#define PROFILE_THREAD(name) ::Profiler::setThreadName(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#endif
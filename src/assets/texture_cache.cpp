@@ -0,0 +1,96 @@
+#include "texture_cache.hpp"
+
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include "texture_loader.hpp"
+
+
+using namespace render3d;
+
+namespace {
+
+    struct Entry {
+        std::shared_ptr<const Texture> texture;
+        size_t bytes = 0;
+    };
+
+    using Key = std::pair<std::string, TextureFilter>;
+
+    std::mutex cacheMutex;
+    std::map<Key, Entry> entries;
+    TextureCache::Stats counters;
+
+    std::string canonicalPath(const std::string& filename) {
+        std::error_code ec;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(filename, ec);
+        if (ec) {
+            return std::filesystem::path(filename).lexically_normal().generic_string();
+        }
+        return canonical.generic_string();
+    }
+
+}
+
+namespace TextureCache {
+
+std::shared_ptr<const Texture> acquire(const std::string& filename, TextureFilter filter) {
+    Key key{canonicalPath(filename), filter};
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            ++counters.hits;
+            return it->second.texture;
+        }
+    }
+
+    // Decode outside the lock so independent files can load concurrently.
+    size_t bytes = 0;
+    Texture decoded = TextureLoader::decode(filename, filter, &bytes);
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    ++counters.misses;
+    if (bytes == 0) {
+        return nullptr;
+    }
+
+    auto texture = std::make_shared<const Texture>(std::move(decoded));
+    auto [it, inserted] = entries.insert({std::move(key), Entry{texture, bytes}});
+    if (!inserted) {
+        // Another thread decoded the same file meanwhile; keep the first copy.
+        return it->second.texture;
+    }
+    counters.bytes += bytes;
+    return texture;
+}
+
+Stats stats() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    Stats result = counters;
+    result.entries = entries.size();
+    return result;
+}
+
+void purgeUnused() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->second.texture.use_count() == 1) {
+            counters.bytes -= it->second.bytes;
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void clear() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    entries.clear();
+    counters = {};
+}
+
+} // namespace TextureCache
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <render3d/texture.hpp>
+
+// Process-wide cache of decoded textures, keyed by canonical path + filter, so
+// a file that many materials reference is decoded once per scene build.
+// render3d::Material holds its textures by value, so each material still
+// copies the pixels out; SceneLoader purges the cache after every build so it
+// does not keep one more copy for the life of the process. Handles are
+// immutable so they can be handed out freely across threads.
+
+using namespace render3d;
+
+namespace TextureCache {
+
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t entries = 0;
+        size_t bytes = 0;  // decoded RGBA8 bytes retained on top of the materials' copies
+    };
+
+    // Returns the shared texture for (filename, filter), decoding it on first
+    // use. Returns nullptr if the image cannot be loaded; failures are not
+    // cached so a file that appears later is picked up on the next call.
+    std::shared_ptr<const Texture> acquire(const std::string& filename,
+                                           TextureFilter filter = TextureFilter::NEIGHBOUR);
+
+    Stats stats();
+
+    // Drops entries that are no longer referenced outside the cache. Loads
+    // still holding a handle on another thread keep theirs.
+    void purgeUnused();
+
+    // Drops every entry and resets the counters.
+    void clear();
+
+} // namespace TextureCache
@@ -4,6 +4,7 @@
 #include <utility>
 #include <vector>
 
+#include "texture_cache.hpp"
 #include "../vendor/nothings/stb_image.h"
 
 
@@ -12,20 +13,41 @@ using namespace render3d;
 namespace TextureLoader {
 
 Texture load(const std::string& filename, TextureFilter filter) {
+    std::shared_ptr<const Texture> shared = TextureCache::acquire(filename, filter);
+    if (!shared) {
+        return {};
+    }
+    return *shared;
+}
+
+std::shared_ptr<const Texture> loadShared(const std::string& filename, TextureFilter filter) {
+    return TextureCache::acquire(filename, filter);
+}
+
+Texture decode(const std::string& filename, TextureFilter filter, size_t* decodedBytes) {
+    if (decodedBytes) {
+        *decodedBytes = 0;
+    }
+
     int width = 0;
     int height = 0;
     int channels = 0;
     unsigned char* imageData = stbi_load(filename.c_str(), &width, &height, &channels, 4);
 
     if (!imageData) {
-        std::cout << "Failed to load image: " << filename
+        std::cerr << "Failed to load image: " << filename
                   << " - " << stbi_failure_reason() << std::endl;
         return {};
     }
 
-    std::vector<unsigned char> image(imageData, imageData + (width * height * 4));
+    size_t byteCount = static_cast<size_t>(width) * height * 4;
+    std::vector<unsigned char> image(imageData, imageData + byteCount);
     stbi_image_free(imageData);
 
+    if (decodedBytes) {
+        *decodedBytes = byteCount;
+    }
+
     Texture texture{width, height, std::move(image)};
     texture.setFilter(filter);
     return texture;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <render3d/texture.hpp>
 
@@ -10,9 +12,20 @@ using namespace render3d;
 
 namespace TextureLoader {
 
-    // Loads an RGBA8 image from disk. Returns an empty (invalid) Texture on
-    // failure. The given sampling filter is applied to the result.
+    // Loads an RGBA8 image through the shared TextureCache, so each file is
+    // decoded once per scene build. Returns an empty (invalid) Texture on failure.
+    // The given sampling filter is applied to the result.
     Texture load(const std::string& filename,
                  TextureFilter filter = TextureFilter::NEIGHBOUR);
 
+    // Same as load(), but returns the cache's shared handle instead of a copy.
+    // Returns nullptr on failure.
+    std::shared_ptr<const Texture> loadShared(const std::string& filename,
+                                              TextureFilter filter = TextureFilter::NEIGHBOUR);
+
+    // Decodes the file directly, bypassing the cache. On success the decoded
+    // size in bytes is written to decodedBytes (0 on failure).
+    Texture decode(const std::string& filename, TextureFilter filter,
+                   size_t* decodedBytes = nullptr);
+
 } // namespace TextureLoader
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Open-addressing map from an OBJ corner (position, texcoord, normal index
+// triple) to its final vertex index. The table is sized once from the corner
+// count of the file, so deduplicating a mesh performs a single allocation
+// instead of one tree node per unique corner.
+
+class VertexDedupTable {
+public:
+    // Sizes the table for up to maxCorners distinct corners at <= 50% load.
+    explicit VertexDedupTable(size_t maxCorners) {
+        size_t capacity = 16;
+        while (capacity < maxCorners * 2) {
+            capacity <<= 1;
+        }
+        slots.assign(capacity, Slot{});
+        mask = capacity - 1;
+    }
+
+    // Returns the index stored for the corner, or inserts nextIndex and
+    // returns it. Passing size() as nextIndex numbers vertices in order of
+    // first appearance, so a result equal to it marks a new vertex. Inserting
+    // more than maxCorners distinct corners is not supported.
+    int findOrInsert(int pos, int tex, int norm, int nextIndex) {
+        size_t i = hash(pos, tex, norm) & mask;
+        for (;;) {
+            Slot& slot = slots[i];
+            if (slot.index < 0) {
+                slot = Slot{pos, tex, norm, nextIndex};
+                ++count;
+                return nextIndex;
+            }
+            if (slot.pos == pos && slot.tex == tex && slot.norm == norm) {
+                return slot.index;
+            }
+            i = (i + 1) & mask;
+        }
+    }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return slots.size(); }
+
+    // Home slot hash of a corner; public so tests can build collision chains.
+    static size_t hash(int pos, int tex, int norm) {
+        uint64_t h = static_cast<uint32_t>(pos) * 0x9E3779B97F4A7C15ull;
+        h ^= static_cast<uint32_t>(tex) * 0xC2B2AE3D27D4EB4Full + (h << 6) + (h >> 2);
+        h ^= static_cast<uint32_t>(norm) * 0x165667B19E3779F9ull + (h << 6) + (h >> 2);
+        return static_cast<size_t>(h ^ (h >> 29));
+    }
+
+private:
+    struct Slot {
+        int pos = 0;
+        int tex = 0;
+        int norm = 0;
+        int index = -1;
+    };
+
+    std::vector<Slot> slots;
+    size_t mask = 0;
+    size_t count = 0;
+};
@@ -0,0 +1,145 @@
+#include "bench_runner.hpp"
+
+#include "assets/profiler.hpp"
+#include "scenes/mesh_lod.hpp"
+#include "scenes/scene_factory.hpp"
+#include "scenes/texture_lod.hpp"
+#include <render3d/renderer.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+using namespace render3d;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(Clock::time_point start, Clock::time_point end) {
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+} // namespace
+
+int BenchRunner::run() {
+  result = BenchReport::Report{};
+  result.warmupFrames = config.warmupFrames;
+  result.frames = config.frames;
+  result.timestep = config.fixedTimestep;
+  result.width = config.screen.width;
+  result.height = config.screen.height;
+  PROFILE_THREAD("Main");
+
+  std::vector<int> scenes = config.benchScenes;
+  if (scenes.empty()) {
+    for (int i = 0; i < SceneFactory::sceneCount(); ++i) {
+      scenes.push_back(i);
+    }
+  }
+  for (int index : scenes) {
+    if (!runScene(index)) {
+      return 1;
+    }
+  }
+
+  const std::string json = BenchReport::toJson(result);
+  if (config.benchOutput == "-") {
+    std::fputs(json.c_str(), stdout);
+  } else {
+    std::ofstream file(config.benchOutput, std::ios::binary);
+    if (!(file << json)) {
+      std::fprintf(stderr, "Error: cannot write %s\n", config.benchOutput.c_str());
+      return 1;
+    }
+  }
+  if (!config.tracePath.empty() && !Profiler::writeChromeTrace(config.tracePath)) {
+    std::fprintf(stderr, "Error: cannot write %s\n", config.tracePath.c_str());
+    return 1;
+  }
+  return config.baselinePath.empty() ? 0 : compareWithBaseline();
+}
+
+bool BenchRunner::runScene(int index) {
+  auto scene = SceneFactory::createSceneByIndex(index, config.screen);
+  if (!scene) {
+    std::fprintf(stderr, "Error: no scene at index %d\n", index);
+    return false;
+  }
+  scene->setup();
+  TextureLod textureLod;
+  MeshLod meshLod;
+  textureLod.build(*scene);
+  meshLod.build(*scene);
+  Renderer renderer;
+
+  BenchReport::SceneResult measured;
+  measured.name = SceneFactory::allSceneNames()[index];
+  measured.frames = config.frames;
+  std::vector<double> frameMs, updateMs, lodMs, drawMs;
+  frameMs.reserve(config.frames);
+  updateMs.reserve(config.frames);
+  lodMs.reserve(config.frames);
+  drawMs.reserve(config.frames);
+
+  for (int frame = 0; frame < config.warmupFrames + config.frames; ++frame) {
+    const auto start = Clock::now();
+    {
+      PROFILE_ZONE("Scene::update");
+      scene->update(config.fixedTimestep);
+    }
+    const auto updated = Clock::now();
+    textureLod.update(*scene);
+    meshLod.update(*scene);
+    const auto selected = Clock::now();
+    {
+      PROFILE_ZONE("Renderer::drawScene");
+      renderer.drawScene(*scene);
+    }
+    const auto drawn = Clock::now();
+    PROFILE_FRAME();
+
+    if (frame < config.warmupFrames) {
+      continue;
+    }
+    frameMs.push_back(msSince(start, drawn));
+    updateMs.push_back(msSince(start, updated));
+    lodMs.push_back(msSince(updated, selected));
+    drawMs.push_back(msSince(selected, drawn));
+    measured.counters.add(*scene);
+  }
+
+  measured.frameMs = BenchReport::summarize(frameMs);
+  measured.updateMs = BenchReport::summarize(updateMs);
+  measured.lodMs = BenchReport::summarize(lodMs);
+  measured.drawMs = BenchReport::summarize(drawMs);
+  std::fprintf(stderr, "%s: median %.3f ms, p95 %.3f ms, p99 %.3f ms\n",
+               measured.name.c_str(), measured.frameMs.median, measured.frameMs.p95,
+               measured.frameMs.p99);
+  result.scenes.push_back(std::move(measured));
+  return true;
+}
+
+int BenchRunner::compareWithBaseline() const {
+  std::ifstream file(config.baselinePath, std::ios::binary);
+  std::stringstream text;
+  text << file.rdbuf();
+  std::map<std::string, BenchReport::Baseline> baseline;
+  if (!file || !BenchReport::parseBaseline(text.str(), baseline)) {
+    std::fprintf(stderr, "Error: cannot read baseline %s\n", config.baselinePath.c_str());
+    return 1;
+  }
+
+  const auto regressions =
+      BenchReport::compare(result, baseline, config.regressionThreshold);
+  for (const auto &regression : regressions) {
+    std::fprintf(stderr, "Regression: %s %s %.3f ms -> %.3f ms (+%.1f%%)\n",
+                 regression.scene.c_str(), regression.metric, regression.baselineMs,
+                 regression.currentMs, (regression.ratio() - 1.0) * 100.0);
+  }
+  return regressions.empty() ? 0 : 3;
+}
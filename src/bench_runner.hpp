@@ -0,0 +1,29 @@
+#pragma once
+
+#include "app_config.hpp"
+#include "scenes/bench_report.hpp"
+
+
+// Benchmark mode (--bench). Loads each of config.benchScenes (every YAML scene
+// when empty) and, like HeadlessRunner, steps and draws it without a window,
+// so frames are never held back by vsync. config.warmupFrames frames are
+// drawn first and discarded, then config.frames frames are timed stage by
+// stage. The report is written as JSON to config.benchOutput and, when
+// config.baselinePath is set, compared against that earlier report.
+class BenchRunner {
+public:
+  explicit BenchRunner(const AppConfig &config) : config(config) {}
+
+  // Exit codes: 0 success, 1 a scene or file failed, 3 a scene regressed
+  // past config.regressionThreshold.
+  int run();
+
+  const BenchReport::Report &report() const { return result; }
+
+private:
+  bool runScene(int index);
+  int compareWithBaseline() const;
+
+  AppConfig config;
+  BenchReport::Report result;
+};
@@ -0,0 +1,84 @@
+#include "headless_runner.hpp"
+
+#include "assets/ppm_writer.hpp"
+#include "assets/profiler.hpp"
+#include "scenes/mesh_lod.hpp"
+#include "scenes/scene_factory.hpp"
+#include "scenes/texture_lod.hpp"
+#include <render3d/renderer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+
+using namespace render3d;
+
+int HeadlessRunner::run() {
+  PROFILE_THREAD("Main");
+  auto scene = SceneFactory::createSceneByIndex(config.startScene, config.screen);
+  if (!scene) {
+    std::fprintf(stderr, "Error: no scene at index %d\n", config.startScene);
+    return 1;
+  }
+  scene->setup();
+  TextureLod textureLod;
+  MeshLod meshLod;
+  textureLod.build(*scene);
+  meshLod.build(*scene);
+  Renderer renderer;
+
+  frameMs.clear();
+  frameMs.reserve(config.frames);
+  int written = 0;
+  for (int frame = 0; frame < config.frames; ++frame) {
+    const auto start = std::chrono::steady_clock::now();
+    {
+      PROFILE_ZONE("Scene::update");
+      scene->update(config.fixedTimestep);
+    }
+    textureLod.update(*scene);
+    meshLod.update(*scene);
+    {
+      PROFILE_ZONE("Renderer::drawScene");
+      renderer.drawScene(*scene);
+    }
+    frameMs.push_back(std::chrono::duration<double, std::milli>(
+                          std::chrono::steady_clock::now() - start).count());
+
+    if (shouldSave(frame)) {
+      char number[16];
+      std::snprintf(number, sizeof(number), "_%04d.ppm", frame);
+      const std::string path = config.framePrefix + number;
+      if (!PpmWriter::write(path, scene->pixels.data(), scene->screen.width,
+                            scene->screen.height)) {
+        std::fprintf(stderr, "Error: cannot write %s\n", path.c_str());
+        return 1;
+      }
+      ++written;
+    }
+    PROFILE_FRAME();
+  }
+
+  double total = 0.0;
+  for (double ms : frameMs) {
+    total += ms;
+  }
+  std::printf("%s: %d frames at %dx%d, %.1f ms (%.3f ms/frame), %d written\n",
+              scene->name.c_str(), config.frames, scene->screen.width,
+              scene->screen.height, total, config.frames ? total / config.frames : 0.0,
+              written);
+  if (!config.tracePath.empty() && !Profiler::writeChromeTrace(config.tracePath)) {
+    std::fprintf(stderr, "Error: cannot write %s\n", config.tracePath.c_str());
+    return 1;
+  }
+  return 0;
+}
+
+// Negative entries count from the end: -1 is the last frame.
+bool HeadlessRunner::shouldSave(int frame) const {
+  return std::any_of(config.savedFrames.begin(), config.savedFrames.end(), [&](int saved) {
+    return saved == frame || (saved < 0 && config.frames + saved == frame);
+  });
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "app_config.hpp"
+
+#include <vector>
+
+
+// Renders the start scene without a window: no SDL video, no ImGui. The
+// scene is built through SceneFactory like the windowed app's, then stepped
+// with a fixed timestep and drawn into Scene::pixels config.frames times.
+// The frames listed in config.savedFrames are written as PPM files. This is
+// what automated runs on display-less machines use.
+class HeadlessRunner {
+public:
+  explicit HeadlessRunner(const AppConfig &config) : config(config) {}
+
+  // Returns the process exit code.
+  int run();
+
+  // Milliseconds each frame took to update and draw, in order.
+  const std::vector<double> &frameTimes() const { return frameMs; }
+
+private:
+  bool shouldSave(int frame) const;
+
+  AppConfig config;
+  std::vector<double> frameMs;
+};
@@ -1,7 +1,183 @@
 #include "application.hpp"
+#include "bench_runner.hpp"
+#include "headless_runner.hpp"
+#include "scenes/scene_factory.hpp"
 
-int main(int, char **) {
-  Application app;
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+
+void printUsage(const char *program) {
+  std::fprintf(stderr,
+               "Usage: %s [--scene INDEX|NAME] [--size WxH] [--memory-report FILE|-]\n"
+               "       [--pipelined] [--locked-upload] [--target-ms MS [--min-scale S]]\n"
+               "       [--headless [--frames N] [--timestep SECONDS]\n"
+               "        [--save-frame N]... [--output PREFIX]]\n"
+               "       [--bench [--scene INDEX|NAME]... [--frames N] [--warmup N]\n"
+               "        [--report FILE|-] [--baseline FILE] [--threshold PERCENT]]\n"
+               "       [--trace FILE]\n"
+               "  --scene          scene to show first (selector index or name)\n"
+               "  --memory-report  write the scene's memory use as JSON and exit\n"
+               "  --size           framebuffer size, e.g. 1920x1080 (window scale 1)\n"
+               "  --pipelined      draw on a render thread while updating the next frame\n"
+               "  --locked-upload  copy frames into the texture with SDL_LockTexture\n"
+               "  --target-ms      scale the resolution down to keep drawing under MS\n"
+               "  --min-scale      smallest resolution scale per axis (default 0.5)\n"
+               "  --headless       render without a window or UI, then exit\n"
+               "  --frames         frames to render headless (default 100)\n"
+               "  --timestep       seconds the scene advances per frame (default 1/60)\n"
+               "  --save-frame     write frame N as PREFIX_NNNN.ppm; -1 is the last\n"
+               "  --output         prefix of the written frames (default \"frame\")\n"
+               "  --bench          time each --scene (default: all) headless and\n"
+               "                   report frame-time percentiles as JSON, then exit\n"
+               "  --warmup         untimed frames before measuring (default 30)\n"
+               "  --report         file the benchmark JSON goes to (default stdout)\n"
+               "  --baseline       earlier benchmark JSON to compare against\n"
+               "  --threshold      allowed median/p95 slowdown in percent (default 10);\n"
+               "                   exceeding it exits with code 3\n"
+               "  --trace          write the last frames' profiler zones as a Chrome\n"
+               "                   trace on exit (builds with ENABLE_PROFILER)\n",
+               program);
+}
+
+bool parseInt(const char *text, int &value) {
+  char *end = nullptr;
+  long number = std::strtol(text, &end, 10);
+  value = static_cast<int>(number);
+  return end != text && *end == '\0';
+}
+
+bool parseDouble(const char *text, double &value) {
+  char *end = nullptr;
+  value = std::strtod(text, &end);
+  return end != text && *end == '\0';
+}
+
+// "WIDTHxHEIGHT", both positive.
+bool parseSize(const char *text, Screen &screen) {
+  int width = 0;
+  int height = 0;
+  char tail = '\0';
+  if (std::sscanf(text, "%dx%d%c", &width, &height, &tail) != 2 || width <= 0 ||
+      height <= 0) {
+    return false;
+  }
+  screen = Screen{width, height};
+  return true;
+}
+
+// Index into the scene selector, or the position of a scene name in it.
+bool parseScene(const char *text, int &index) {
+  if (parseInt(text, index)) {
+    return index >= 0 && index < SceneFactory::sceneCount();
+  }
+  const auto &names = SceneFactory::allSceneNames();
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (names[i] == text) {
+      index = static_cast<int>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool parseCommandLine(int argc, char **argv, AppConfig &config) {
+  double number = 0.0;
+  for (int i = 1; i < argc; ++i) {
+    const bool hasValue = i + 1 < argc;
+    if (std::strcmp(argv[i], "--scene") == 0 && hasValue) {
+      if (!parseScene(argv[++i], config.startScene)) {
+        std::fprintf(stderr, "Unknown scene: %s\n", argv[i]);
+        return false;
+      }
+      config.benchScenes.push_back(config.startScene);
+    } else if (std::strcmp(argv[i], "--memory-report") == 0 && hasValue) {
+      config.memoryReportPath = argv[++i];
+    } else if (std::strcmp(argv[i], "--size") == 0 && hasValue) {
+      if (!parseSize(argv[++i], config.screen)) {
+        return false;
+      }
+      config.windowScale = 1;
+    } else if (std::strcmp(argv[i], "--pipelined") == 0) {
+      config.pipelined = true;
+    } else if (std::strcmp(argv[i], "--locked-upload") == 0) {
+      config.lockedUpload = true;
+    } else if (std::strcmp(argv[i], "--target-ms") == 0 && hasValue) {
+      if (!parseDouble(argv[++i], number) || number <= 0.0) {
+        return false;
+      }
+      config.dynamicResolution = true;
+      config.targetRenderMs = static_cast<float>(number);
+    } else if (std::strcmp(argv[i], "--min-scale") == 0 && hasValue) {
+      if (!parseDouble(argv[++i], number) || number <= 0.0 || number > 1.0) {
+        return false;
+      }
+      config.minResolutionScale = static_cast<float>(number);
+    } else if (std::strcmp(argv[i], "--headless") == 0) {
+      config.headless = true;
+    } else if (std::strcmp(argv[i], "--frames") == 0 && hasValue) {
+      if (!parseInt(argv[++i], config.frames) || config.frames < 0) {
+        return false;
+      }
+    } else if (std::strcmp(argv[i], "--timestep") == 0 && hasValue) {
+      if (!parseDouble(argv[++i], number)) {
+        return false;
+      }
+      config.fixedTimestep = static_cast<float>(number);
+    } else if (std::strcmp(argv[i], "--save-frame") == 0 && hasValue) {
+      int frame = 0;
+      if (!parseInt(argv[++i], frame)) {
+        return false;
+      }
+      config.savedFrames.push_back(frame);
+    } else if (std::strcmp(argv[i], "--output") == 0 && hasValue) {
+      config.framePrefix = argv[++i];
+    } else if (std::strcmp(argv[i], "--bench") == 0) {
+      config.bench = true;
+    } else if (std::strcmp(argv[i], "--warmup") == 0 && hasValue) {
+      if (!parseInt(argv[++i], config.warmupFrames) || config.warmupFrames < 0) {
+        return false;
+      }
+    } else if (std::strcmp(argv[i], "--report") == 0 && hasValue) {
+      config.benchOutput = argv[++i];
+    } else if (std::strcmp(argv[i], "--baseline") == 0 && hasValue) {
+      config.baselinePath = argv[++i];
+    } else if (std::strcmp(argv[i], "--threshold") == 0 && hasValue) {
+      if (!parseDouble(argv[++i], number) || number < 0.0) {
+        return false;
+      }
+      config.regressionThreshold = number / 100.0;
+    } else if (std::strcmp(argv[i], "--trace") == 0 && hasValue) {
+      config.tracePath = argv[++i];
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  AppConfig config;
+  if (!parseCommandLine(argc, argv, config)) {
+    printUsage(argv[0]);
+    return 2;
+  }
+
+  if (config.bench) {
+    return BenchRunner(config).run();
+  }
+  if (config.headless) {
+    return HeadlessRunner(config).run();
+  }
+  Application app(config);
+  if (!config.memoryReportPath.empty()) {
+    return app.writeMemoryReport();
+  }
   if (!app.init()) {
     return -1;
   }
@@ -0,0 +1,105 @@
+#include "render_pipeline.hpp"
+
+#include "assets/profiler.hpp"
+
+#include <chrono>
+#include <utility>
+
+
+using namespace render3d;
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define RENDER_PIPELINE_SYNCHRONOUS 1
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+} // namespace
+
+RenderPipeline::~RenderPipeline() {
+  finish();
+  if (thread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    thread.join();
+  }
+}
+
+void RenderPipeline::submit(Scene &scene) {
+  finish();
+  submitted = &scene;
+#ifdef RENDER_PIPELINE_SYNCHRONOUS
+  const auto start = Clock::now();
+  renderer.drawScene(scene);
+  lastDrawMs = msSince(start);
+  drawn = true;
+#else
+  if (!thread.joinable()) {
+    thread = std::thread([this]() { loop(); });
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending = &scene;
+    drawn = false;
+  }
+  wake.notify_all();
+#endif
+}
+
+bool RenderPipeline::finish() {
+  if (!submitted) {
+    return false;
+  }
+  PROFILE_ZONE("Wait for render");
+  const auto start = Clock::now();
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    wake.wait(lock, [this]() { return drawn; });
+    counters.drawMs = lastDrawMs;
+  }
+  counters.waitMs = msSince(start);
+  counters.frames++;
+
+  if (front.size() != submitted->pixels.size()) {
+    front.assign(submitted->pixels.size(), 0);
+  }
+  std::swap(front, submitted->pixels);
+  frontSize = submitted->screen;
+  submitted = nullptr;
+  return true;
+}
+
+void RenderPipeline::loop() {
+  PROFILE_THREAD("Render");
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    wake.wait(lock, [this]() { return stopping || pending; });
+    if (stopping) {
+      return;
+    }
+    Scene *scene = pending;
+    pending = nullptr;
+    lock.unlock();
+
+    const auto start = Clock::now();
+    {
+      PROFILE_ZONE("Renderer::drawScene");
+      renderer.drawScene(*scene);
+    }
+    const double ms = msSince(start);
+
+    lock.lock();
+    lastDrawMs = ms;
+    drawn = true;
+    wake.notify_all();
+  }
+}
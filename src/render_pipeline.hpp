@@ -0,0 +1,71 @@
+#pragma once
+
+#include <render3d/renderer.hpp>
+#include <render3d/scene.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+using namespace render3d;
+
+// Draws scenes on a render thread so the main thread can present the
+// previous frame and prepare the next one meanwhile. The handoff is
+// explicit: submit() gives the scene to the render thread, and until
+// finish() returns the main thread must not touch it. finish() waits for the
+// frame, then swaps the drawn pixels into frontBuffer() and the previous
+// front buffer into the scene, where the next drawScene overwrites it. The
+// main thread uploads and presents frontBuffer() while the next frame draws.
+//
+// Application submits a clone of the scene on screen (RenderCopy), so
+// input, UI and Scene::update keep running on the original while the copy
+// is drawn.
+//
+// Without pthreads (Emscripten without -pthread), submit() draws on the
+// calling thread.
+class RenderPipeline {
+public:
+  explicit RenderPipeline(Renderer &renderer) : renderer(renderer) {}
+  ~RenderPipeline();
+
+  RenderPipeline(const RenderPipeline &) = delete;
+  RenderPipeline &operator=(const RenderPipeline &) = delete;
+
+  void submit(Scene &scene);
+
+  // Returns false when no frame was in flight.
+  bool finish();
+
+  bool inFlight() const { return submitted != nullptr; }
+
+  // Last finished frame and its size; empty before the first.
+  const std::vector<uint32_t> &frontBuffer() const { return front; }
+  Screen frontScreen() const { return frontSize; }
+
+  struct Stats {
+    uint64_t frames = 0;
+    double drawMs = 0.0;  // last frame's drawScene on the render thread
+    double waitMs = 0.0;  // last time finish() blocked the main thread
+  };
+  const Stats &stats() const { return counters; }
+
+private:
+  void loop();
+
+  Renderer &renderer;
+  Scene *submitted = nullptr;
+  std::vector<uint32_t> front;
+  Screen frontSize{0, 0};
+  Stats counters;
+
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable wake;
+  Scene *pending = nullptr;  // handed to the render thread, not yet drawn
+  bool drawn = false;
+  double lastDrawMs = 0.0;
+  bool stopping = false;
+};
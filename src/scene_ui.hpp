@@ -2,9 +2,23 @@
 
 #include "app_state.hpp"
 #include "assets/background_factory.hpp"
+#include "assets/cubemap_loader.hpp"
+#include "assets/profiler.hpp"
+#include "assets/texture_cache.hpp"
+#include "render_pipeline.hpp"
+#include "scenes/async_scene_loader.hpp"
+#include "scenes/memory_report.hpp"
+#include "scenes/mesh_lod.hpp"
 #include "scenes/scene_factory.hpp"
+#include "scenes/scene_loader.hpp"
+#include "scenes/scene_reloader.hpp"
+#include "scenes/texture_lod.hpp"
 #include "vendor/imgui/imgui.h"
 
+#include <algorithm>
+#include <cfloat>
+#include <string>
+#include <utility>
 #include <vector>
 
 
@@ -12,8 +26,7 @@ using namespace render3d;
 
 namespace SceneUI {
 
-inline void drawSceneSelector(AppState& state, Screen screen) {
-    int currentBackground = static_cast<int>(state.scene->backgroundType);
+inline void drawSceneSelector(AppState& state, AsyncSceneLoader& loader, Screen screen) {
     const auto& names = SceneFactory::allSceneNames();
     auto itemGetter = [](void* data, int idx) -> const char* {
         auto* v = static_cast<const std::vector<std::string>*>(data);
@@ -22,15 +35,23 @@ inline void drawSceneSelector(AppState& state, Screen screen) {
     if (ImGui::Combo("Scene", &state.currentSceneIndex, itemGetter,
                      const_cast<void*>(static_cast<const void*>(&names)),
                      SceneFactory::sceneCount())) {
-        auto newScene = SceneFactory::createSceneByIndex(state.currentSceneIndex, screen);
-        if (newScene) {
-            state.scene = std::move(newScene);
-            state.scene->setup();
-            state.scene->backgroundType = static_cast<BackgroundType>(currentBackground);
-            state.scene->setBackground(
-                BackgroundFactory::create(state.scene->backgroundType));
+        if (state.currentSceneIndex == state.loadedSceneIndex) {
+            loader.cancel();
+        } else {
+            loader.request(state.currentSceneIndex, screen, state.scene->backgroundType);
         }
     }
+
+    AsyncSceneLoader::Status status = loader.status();
+    if (status.loading) {
+        ImGui::ProgressBar(status.progress, ImVec2(-1.0f, 0.0f), status.stage.c_str());
+        if (ImGui::Button("Cancel loading")) {
+            loader.cancel();
+        }
+    } else if (!status.error.empty()) {
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Scene load failed: %s",
+                           status.error.c_str());
+    }
 }
 
 inline void drawSolidControls(Scene& scene) {
@@ -149,7 +170,7 @@ inline void drawSceneControls(Scene& scene) {
     if (ImGui::Combo("Background", &currentBackground, backgroundNames,
                      IM_ARRAYSIZE(backgroundNames))) {
       scene.backgroundType = static_cast<BackgroundType>(currentBackground);
-      scene.setBackground(BackgroundFactory::create(scene.backgroundType));
+      BackgroundFactory::setBackground(scene, BackgroundFactory::create(scene.backgroundType));
     }
 
     ImGui::Checkbox("Show Axis Helper", &scene.showAxes);
@@ -194,6 +215,269 @@ inline void drawStats(const Scene& scene) {
     ImGui::Text("Pixels rasterized: %u", scene.stats.pixelsRasterized);
     ImGui::Text("Draw calls: %u", scene.stats.drawCalls);
     ImGui::Text("Vertices processed: %u", scene.stats.verticesProcessed);
+
+    TextureCache::Stats textures = TextureCache::stats();
+    ImGui::Text("Texture cache: %zu hits, %zu misses", textures.hits, textures.misses);
+    ImGui::Text("Texture cache overhead: %zu textures, %.2f MB retained",
+                textures.entries, textures.bytes / (1024.0 * 1024.0));
+
+    CubeMapLoader::Stats skyboxes = CubeMapLoader::stats();
+    if (skyboxes.hits + skyboxes.misses > 0) {
+        ImGui::Text("Skybox load: %.1f ms%s, %zu cached (%.2f MB)", skyboxes.lastLoadMs,
+                    skyboxes.lastWasMemoized ? " (memoized)" : "", skyboxes.entries,
+                    skyboxes.bytes / (1024.0 * 1024.0));
+    }
+
+    MeshLibrary::Stats meshes = SceneLoader::lastMeshStats();
+    if (meshes.references > 0) {
+        ImGui::Text("Meshes: %zu unique for %zu solids", meshes.meshes, meshes.references);
+        ImGui::Text("Mesh memory: %.2f MB unique, %.2f MB referenced",
+                    meshes.uniqueBytes / (1024.0 * 1024.0),
+                    meshes.referencedBytes / (1024.0 * 1024.0));
+        if (meshes.optimized > 0 && meshes.optimizedTriangles > 0) {
+            ImGui::Text("Vertex cache: ACMR %.2f -> %.2f over %zu meshes",
+                        meshes.cacheMissesBefore / meshes.optimizedTriangles,
+                        meshes.cacheMissesAfter / meshes.optimizedTriangles, meshes.optimized);
+        }
+    }
+
+    BackgroundFactory::HdrStats hdr = BackgroundFactory::hdrStatsFor(scene);
+    if (!hdr.path.empty()) {
+        ImGui::Text("HDR panorama: %dx%d of %dx%d, %.2f MB (saved %.2f MB)",
+                    hdr.width, hdr.height, hdr.sourceWidth, hdr.sourceHeight,
+                    hdr.residentBytes / (1024.0 * 1024.0),
+                    (hdr.sourceBytes - hdr.residentBytes) / (1024.0 * 1024.0));
+        ImGui::Text("HDR load: %.1f ms%s, RGBE cache %.2f MB", hdr.loadMs,
+                    hdr.fromCache ? " (cached)" : "", hdr.compactBytes / (1024.0 * 1024.0));
+    }
+}
+
+// In pipelined mode the stats below describe the previous frame.
+inline void drawPipeline(AppState& state, const RenderPipeline& pipeline) {
+    ImGui::Checkbox("Pipelined render", &state.pipelined);
+    if (state.pipelined) {
+        const RenderPipeline::Stats& stats = pipeline.stats();
+        ImGui::Text("Render thread: draw %.2f ms, main thread waited %.2f ms",
+                    stats.drawMs, stats.waitMs);
+        if (!state.renderCopy.scene) {
+            ImGui::Text("No render copy of this scene yet: drawing on the main thread");
+        }
+    }
+}
+
+inline void drawUpload(AppState& state) {
+    ImGui::Checkbox("Upload via SDL_LockTexture", &state.lockedUpload);
+    const UploadStats& upload = state.upload;
+    ImGui::Text("Upload: %s%s, %.2f MB/frame, %.3f ms",
+                upload.locked ? "locked texture" : "SDL_UpdateTexture",
+                upload.padded ? " (padded rows)" : "", upload.bytes / (1024.0 * 1024.0),
+                upload.ms);
+}
+
+inline void drawResolution(AppState& state, Screen full) {
+    DynamicResolution& resolution = state.resolution;
+    ImGui::Checkbox("Dynamic resolution", &resolution.enabled);
+    if (resolution.enabled) {
+        ImGui::SliderFloat("Target draw ms", &resolution.targetMs, 2.0f, 50.0f, "%.1f");
+        ImGui::SliderFloat("Min scale", &resolution.minScale, 0.25f, 1.0f, "%.2f");
+    }
+    const Screen size = resolution.screenFor(full);
+    ImGui::Text("Resolution: %dx%d of %dx%d (scale %.2f), draw %.2f ms",
+                size.width, size.height, full.width, full.height, resolution.scale(),
+                resolution.smoothedMs());
+}
+
+inline void drawTextureLod(TextureLod& lod) {
+    const TextureLod::Stats& stats = lod.stats();
+    ImGui::Checkbox("Texture Mipmaps", &lod.enabled);
+    ImGui::Text("Mipmapped textures: %zu (%zu reduced)", stats.textures, stats.reduced);
+    ImGui::Text("Bound texels: %.2f of %.2f MB (+%.2f MB mips)",
+                stats.boundBytes / (1024.0 * 1024.0), stats.fullBytes / (1024.0 * 1024.0),
+                stats.chainBytes / (1024.0 * 1024.0));
+}
+
+inline void drawMeshLod(MeshLod& lod) {
+    const MeshLod::Stats& stats = lod.stats();
+    ImGui::Checkbox("Mesh LOD", &lod.enabled);
+    ImGui::Text("LOD meshes: %zu (%zu reduced), triangles %zu of %zu",
+                stats.meshes, stats.reduced, stats.boundTriangles, stats.fullTriangles);
+    for (size_t level = 0; level < stats.meshesPerLevel.size(); ++level) {
+        if (stats.meshesPerLevel[level] > 0) {
+            ImGui::Text("  LOD %zu: %zu meshes, %zu triangles", level,
+                        stats.meshesPerLevel[level], stats.trianglesPerLevel[level]);
+        }
+    }
+}
+
+inline void drawSceneCache(AsyncSceneLoader& loader) {
+    SceneCache::Stats stats = loader.cacheStats();
+    int budgetMb = static_cast<int>(loader.cacheBudget() >> 20);
+    if (ImGui::SliderInt("Scene cache (MB)", &budgetMb, 0, 4096)) {
+        loader.setCacheBudget(static_cast<size_t>(budgetMb) << 20);
+    }
+    ImGui::Checkbox("Prefetch neighbours", &loader.prefetch);
+    if (loader.isPrefetching()) {
+        ImGui::SameLine();
+        ImGui::TextUnformatted("(loading)");
+    }
+    ImGui::Text("Cached scenes: %zu, %.2f MB (%zu hits, %zu misses, %zu evicted)",
+                stats.scenes, stats.bytes / (1024.0 * 1024.0), stats.hits, stats.misses,
+                stats.evictions);
+}
+
+inline void drawHotReload(SceneReloader& reloader) {
+    ImGui::Checkbox("Hot Reload", &reloader.enabled);
+    if (reloader.trackedPath().empty())
+        return;
+    ImGui::SameLine();
+    ImGui::Text("(%zu files)", reloader.watchedFiles() + 1);
+    const SceneReloader::Result& result = reloader.lastResult();
+    if (!result.error.empty()) {
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Reload error: %s", result.error.c_str());
+    }
+    if (result.reloaded) {
+        ImGui::Text("Last reload: %.2f ms (%zu patched, %zu rebuilt, %zu added, %zu removed)",
+                    result.ms, result.patched, result.rebuilt, result.added, result.removed);
+    }
+}
+
+// Recollected every half second while the header is open: walking every face
+// of a large scene each frame would show up in the frame time it sits next to.
+inline void drawMemory(AppState& state, AsyncSceneLoader& loader) {
+    if (!ImGui::CollapsingHeader("Memory"))
+        return;
+    const bool stale = state.memoryReportTime < 0.0 ||
+                       ImGui::GetTime() - state.memoryReportTime > 0.5;
+    if (stale || ImGui::Button("Refresh")) {
+        SceneCache::Stats cache = loader.cacheStats();
+        state.memoryReport = MemoryReport::collect(*state.scene, &state.textureLod,
+                                                   &state.meshLod, &cache);
+        state.memoryReportTime = ImGui::GetTime();
+    }
+    const MemoryReport::Report& report = state.memoryReport;
+    const double mb = 1.0 / (1024.0 * 1024.0);
+    ImGui::Text("Total %.2f MB: entities %.2f MB, resources %.2f MB",
+                report.total() * mb, report.entityBytes * mb, report.resourceBytes * mb);
+
+    const ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg |
+                                  ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingFixedFit;
+    if (ImGui::BeginTable("entity_memory", 7, flags, ImVec2(0.0f, 200.0f))) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        for (const char* column : {"Entity", "Vertices", "Faces", "Indices", "Textures", "Light", "Total"})
+            ImGui::TableSetupColumn(column);
+        ImGui::TableHeadersRow();
+        for (const auto& entity : report.entities) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%u %s", static_cast<unsigned>(entity.entity), entity.name.c_str());
+            for (size_t bytes : {entity.vertices, entity.faces, entity.indices, entity.textures,
+                                 entity.light, entity.total()}) {
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f KB", bytes / 1024.0);
+            }
+        }
+        ImGui::EndTable();
+    }
+    for (const auto& resource : report.resources)
+        ImGui::Text("%s: %.2f MB", resource.name.c_str(), resource.bytes * mb);
+}
+
+// Frame times of the kept frames, then one frame's zones as a timeline: a
+// band per thread, a row per nesting depth, bars placed by time within the
+// frame. While recording, the latest frame is shown; pausing freezes the
+// kept frames so any of them can be picked.
+inline void drawProfiler(AppState& state, const std::string& tracePath) {
+    if (!ImGui::CollapsingHeader("Profiler"))
+        return;
+    if (!Profiler::compiledIn()) {
+        ImGui::TextUnformatted("Built without ENABLE_PROFILER");
+        return;
+    }
+    bool recording = Profiler::enabled();
+    if (ImGui::Checkbox("Record", &recording))
+        Profiler::setEnabled(recording);
+    ImGui::SameLine();
+    if (ImGui::Button("Export trace")) {
+        state.profilerStatus = Profiler::writeChromeTrace(tracePath)
+                                   ? "Wrote " + tracePath
+                                   : "Cannot write " + tracePath;
+    }
+    if (!state.profilerStatus.empty()) {
+        ImGui::SameLine();
+        ImGui::TextUnformatted(state.profilerStatus.c_str());
+    }
+
+    const std::vector<Profiler::Frame> frames = Profiler::frames();
+    if (frames.empty())
+        return;
+    std::vector<float> frameMs;
+    frameMs.reserve(frames.size());
+    for (const auto& frame : frames)
+        frameMs.push_back(static_cast<float>(frame.ms()));
+    ImGui::PlotLines("Frame ms", frameMs.data(), static_cast<int>(frameMs.size()), 0, nullptr,
+                     0.0f, FLT_MAX, ImVec2(0.0f, 60.0f));
+
+    const int last = static_cast<int>(frames.size()) - 1;
+    if (recording) {
+        state.profilerFrame = -1;
+    } else {
+        if (state.profilerFrame < 0 || state.profilerFrame > last)
+            state.profilerFrame = last;
+        ImGui::SliderInt("Frame", &state.profilerFrame, 0, last);
+    }
+    const Profiler::Frame& frame = frames[state.profilerFrame < 0 ? last : state.profilerFrame];
+    ImGui::Text("Frame %llu: %.3f ms, %zu zones", static_cast<unsigned long long>(frame.index),
+                frame.ms(), frame.zones.size());
+
+    // Rows: the thread's bands in id order, each as deep as its deepest zone.
+    std::vector<std::pair<uint32_t, uint32_t>> bands;  // thread, depth count
+    for (const auto& zone : frame.zones) {
+        auto it = std::find_if(bands.begin(), bands.end(),
+                               [&](const auto& band) { return band.first == zone.thread; });
+        if (it == bands.end())
+            bands.push_back({zone.thread, zone.depth + 1});
+        else
+            it->second = std::max(it->second, zone.depth + 1);
+    }
+    std::sort(bands.begin(), bands.end());
+    uint32_t rows = 0;
+    for (const auto& band : bands)
+        rows += band.second;
+
+    const float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+    const float width = std::max(ImGui::GetContentRegionAvail().x, 100.0f);
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImGui::InvisibleButton("profiler_timeline", ImVec2(width, std::max(rows, 1u) * rowHeight));
+    ImDrawList* draw = ImGui::GetWindowDrawList();
+    const double span = static_cast<double>(std::max<int64_t>(frame.endNs - frame.startNs, 1));
+    const ImVec2 mouse = ImGui::GetIO().MousePos;
+
+    for (const auto& zone : frame.zones) {
+        uint32_t row = zone.depth;
+        for (const auto& band : bands) {
+            if (band.first == zone.thread)
+                break;
+            row += band.second;
+        }
+        const double begin = std::clamp((zone.startNs - frame.startNs) / span, 0.0, 1.0);
+        const double end = std::clamp((zone.endNs - frame.startNs) / span, 0.0, 1.0);
+        const ImVec2 min(origin.x + static_cast<float>(begin) * width, origin.y + row * rowHeight);
+        const ImVec2 max(std::max(origin.x + static_cast<float>(end) * width, min.x + 1.0f),
+                         min.y + rowHeight - 1.0f);
+        // Hue from the name's address: the same literal keeps its color.
+        const float hue = (reinterpret_cast<uintptr_t>(zone.name) * 2654435761u % 360u) / 360.0f;
+        float r, g, b;
+        ImGui::ColorConvertHSVtoRGB(hue, 0.5f, 0.8f, r, g, b);
+        draw->AddRectFilled(min, max, ImGui::GetColorU32(ImVec4(r, g, b, 1.0f)));
+        const float textWidth = ImGui::CalcTextSize(zone.name).x;
+        if (max.x - min.x > textWidth + 4.0f)
+            draw->AddText(ImVec2(min.x + 2.0f, min.y + 2.0f), IM_COL32(0, 0, 0, 255), zone.name);
+        if (ImGui::IsItemHovered() && mouse.x >= min.x && mouse.x < max.x &&
+            mouse.y >= min.y && mouse.y < max.y) {
+            ImGui::SetTooltip("%s\n%.3f ms (thread %u)", zone.name,
+                              (zone.endNs - zone.startNs) / 1e6, zone.thread);
+        }
+    }
 }
 
 } // namespace SceneUI
@@ -0,0 +1,381 @@
+#include "async_scene_loader.hpp"
+
+#include <algorithm>
+#include <exception>
+
+#include "frame_state.hpp"
+#include "scene_factory.hpp"
+#include "../assets/background_factory.hpp"
+#include "../assets/profiler.hpp"
+
+using namespace render3d;
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define ASYNC_SCENE_LOADER_SYNCHRONOUS 1
+#endif
+
+AsyncSceneLoader::~AsyncSceneLoader() {
+    cancel();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (prefetching) {
+            prefetching->cancelled = true;
+        }
+    }
+    for (auto& worker : workers) {
+        worker.thread.join();
+    }
+}
+
+void AsyncSceneLoader::request(int index, Screen screen, BackgroundType background) {
+    reapFinishedThreads();
+
+    std::shared_ptr<Job> job;
+    std::vector<SceneCache::Entry> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (current) {
+            current->cancelled = true;
+        }
+        current.reset();
+        SceneCache::Entry previous;
+        previous.scene = std::move(ready);
+        previous.textureLod = std::move(readyTextureLod);
+        previous.meshLod = std::move(readyMeshLod);
+        previous.copy = std::move(readyCopy);
+        released.push_back(std::move(previous));
+        readyTextureLod = TextureLod{};
+        readyMeshLod = MeshLod{};
+        readyCopy = RenderCopy{};
+        readySources.clear();
+        requestedBackground = background;
+        state = Status{};
+        state.sceneIndex = index;
+
+        SceneCache::Entry cached;
+        if (cache.take(index, renderCopies, cached, released)) {
+            ready = std::move(cached.scene);
+            readyTextureLod = std::move(cached.textureLod);
+            readyMeshLod = std::move(cached.meshLod);
+            readyCopy = std::move(cached.copy);
+            readySources = std::move(cached.sources);
+            readyIndex = index;
+            state.progress = 1.0f;
+            state.stage = "Cached";
+        } else if (prefetching && prefetching->sceneIndex == index) {
+            // Already loading in the background: take over that load.
+            current = prefetching;
+            prefetching.reset();
+            state.loading = true;
+            state.stage = "Prefetching";
+        } else {
+            if (prefetching) {
+                // Leave the CPU to the requested scene; the neighbour is loaded
+                // again once it is done.
+                prefetching->cancelled = true;
+                prefetchQueue.push_front(prefetching->sceneIndex);
+                prefetching.reset();
+            }
+            job = std::make_shared<Job>();
+            job->sceneIndex = index;
+            job->screen = screen;
+            job->background = background;
+            current = job;
+            state.loading = true;
+            state.stage = "Queued";
+        }
+    }
+
+    release(std::move(released));
+    if (job) {
+        start(job);
+    }
+}
+
+void AsyncSceneLoader::adopt(int index, std::vector<SceneSnapshot::Dependency> sources) {
+    std::lock_guard<std::mutex> lock(mutex);
+    shownSources[index] = std::move(sources);
+}
+
+void AsyncSceneLoader::retire(int index, std::unique_ptr<Scene> scene, TextureLod textureLod,
+                              MeshLod meshLod, RenderCopy copy) {
+    if (!scene) {
+        discard(nullptr, TextureLod{}, MeshLod{}, std::move(copy));
+        return;
+    }
+    reapFinishedThreads();
+
+    std::vector<SceneCache::Entry> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = shownSources.find(index);
+        if (it != shownSources.end()) {
+            released = cache.store(index, std::move(it->second), std::move(scene),
+                                   std::move(textureLod), std::move(meshLod), std::move(copy));
+            shownSources.erase(it);
+        }
+    }
+    if (scene) {
+        // Without its files the entry could never be invalidated.
+        discard(std::move(scene), std::move(textureLod), std::move(meshLod), std::move(copy));
+    }
+    release(std::move(released));
+}
+
+void AsyncSceneLoader::discard(std::unique_ptr<Scene> scene, TextureLod textureLod,
+                               MeshLod meshLod, RenderCopy copy) {
+    reapFinishedThreads();
+
+    SceneCache::Entry entry;
+    entry.scene = std::move(scene);
+    entry.textureLod = std::move(textureLod);
+    entry.meshLod = std::move(meshLod);
+    entry.copy = std::move(copy);
+    std::vector<SceneCache::Entry> released;
+    released.push_back(std::move(entry));
+    release(std::move(released));
+}
+
+void AsyncSceneLoader::prefetchAround(int index, Screen screen, BackgroundType background) {
+    const int count = SceneFactory::sceneCount();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    shownIndex = index;
+    prefetchQueue.clear();
+#ifndef ASYNC_SCENE_LOADER_SYNCHRONOUS
+    if (!prefetch || count < 2) {
+        return;
+    }
+    prefetchScreen = screen;
+    prefetchBackground = background;
+    prefetchQueue.push_back((index + 1) % count);
+    if (count > 2) {
+        prefetchQueue.push_back((index + count - 1) % count);
+    }
+#endif
+}
+
+void AsyncSceneLoader::setCacheBudget(size_t bytes) {
+    reapFinishedThreads();
+
+    std::vector<SceneCache::Entry> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        released = cache.setBudget(bytes);
+    }
+    release(std::move(released));
+}
+
+SceneCache::Stats AsyncSceneLoader::cacheStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return cache.stats();
+}
+
+size_t AsyncSceneLoader::cacheBudget() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return cache.budget();
+}
+
+bool AsyncSceneLoader::isPrefetching() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return prefetching != nullptr;
+}
+
+void AsyncSceneLoader::start(const std::shared_ptr<Job>& job) {
+#ifdef ASYNC_SCENE_LOADER_SYNCHRONOUS
+    run(job);
+#else
+    workers.push_back({job, std::thread([this, job]() { run(job); })});
+#endif
+}
+
+void AsyncSceneLoader::startPrefetch() {
+    std::shared_ptr<Job> job;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!prefetch || current || prefetching || ready) {
+            return;
+        }
+        while (!prefetchQueue.empty() && !job) {
+            int index = prefetchQueue.front();
+            prefetchQueue.pop_front();
+            if (index != shownIndex && !cache.contains(index)) {
+                job = std::make_shared<Job>();
+                job->sceneIndex = index;
+                job->screen = prefetchScreen;
+                job->background = prefetchBackground;
+                prefetching = job;
+            }
+        }
+    }
+    if (job) {
+        start(job);
+    }
+}
+
+void AsyncSceneLoader::release(std::vector<SceneCache::Entry> entries) {
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [](const SceneCache::Entry& entry) {
+                                     return !entry.scene && !entry.copy.scene;
+                                 }),
+                  entries.end());
+    if (entries.empty()) {
+        return;
+    }
+#ifdef ASYNC_SCENE_LOADER_SYNCHRONOUS
+    entries.clear();
+#else
+    // A cached scene can hold hundreds of MB of meshes, textures and mip
+    // chains; freeing them must not stall the frame that evicted them.
+    auto job = std::make_shared<Job>();
+    workers.push_back({job, std::thread([job, entries = std::move(entries)]() mutable {
+        PROFILE_THREAD("Scene release");
+        entries.clear();
+        job->finished = true;
+    })});
+#endif
+}
+
+void AsyncSceneLoader::cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (current) {
+        current->cancelled = true;
+        current.reset();
+    }
+    state.loading = false;
+    state.progress = 0.0f;
+    state.stage.clear();
+}
+
+std::unique_ptr<Scene> AsyncSceneLoader::takeReady(int& sceneIndex, TextureLod* textureLod,
+                                                   MeshLod* meshLod, RenderCopy* copy) {
+    reapFinishedThreads();
+    startPrefetch();
+
+    std::unique_ptr<Scene> scene;
+    BackgroundType background{};
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!ready) {
+            return nullptr;
+        }
+        sceneIndex = readyIndex;
+        if (textureLod) {
+            *textureLod = std::move(readyTextureLod);
+        }
+        readyTextureLod = TextureLod{};
+        if (meshLod) {
+            *meshLod = std::move(readyMeshLod);
+        }
+        readyMeshLod = MeshLod{};
+        if (copy) {
+            *copy = std::move(readyCopy);
+        }
+        readyCopy = RenderCopy{};
+        shownSources[readyIndex] = std::move(readySources);
+        readySources.clear();
+        background = requestedBackground;
+        scene = std::move(ready);
+    }
+
+    // Cached scenes and adopted prefetches were built with the background
+    // selected back then.
+    if (scene->backgroundType != background) {
+        scene->backgroundType = background;
+        BackgroundFactory::setBackground(*scene, BackgroundFactory::create(background));
+    }
+    return scene;
+}
+
+AsyncSceneLoader::Status AsyncSceneLoader::status() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return state;
+}
+
+void AsyncSceneLoader::run(const std::shared_ptr<Job>& job) {
+    PROFILE_THREAD("Scene loader");
+    PROFILE_ZONE("Load scene");
+    LoadProgress progress;
+    progress.report = [this, job](float fraction, const std::string& stage) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (current == job) {
+            state.progress = fraction;
+            state.stage = stage;
+        }
+    };
+    progress.cancelled = [job]() { return job->cancelled.load(); };
+
+    std::unique_ptr<Scene> scene;
+    TextureLod textureLod;
+    MeshLod meshLod;
+    RenderCopy copy;
+    std::vector<SceneSnapshot::Dependency> sources;
+    std::string error;
+    try {
+        scene = SceneFactory::createSceneByIndex(job->sceneIndex, job->screen, &progress,
+                                                 &sources);
+        if (scene && !job->cancelled) {
+            scene->setup();
+            scene->backgroundType = job->background;
+            BackgroundFactory::setBackground(*scene, BackgroundFactory::create(job->background));
+            progress.update(1.0f, "Building mipmaps");
+            textureLod.build(*scene);
+            progress.update(1.0f, "Simplifying meshes");
+            meshLod.build(*scene);
+            if (renderCopies && !job->cancelled) {
+                progress.update(1.0f, "Copying scene for the render thread");
+                copy.scene = FrameState::clone(*scene);
+                copy.textureLod.build(*copy.scene);
+                copy.meshLod.build(*copy.scene);
+            }
+        } else if (!scene && !job->cancelled) {
+            error = "no scene at index " + std::to_string(job->sceneIndex);
+        }
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+
+    std::vector<SceneCache::Entry> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (prefetching == job) {
+            if (scene && !job->cancelled) {
+                released = cache.store(job->sceneIndex, std::move(sources), std::move(scene),
+                                       std::move(textureLod), std::move(meshLod),
+                                       std::move(copy));
+            }
+            prefetching.reset();
+        } else if (current == job && !job->cancelled) {
+            if (scene) {
+                ready = std::move(scene);
+                readyTextureLod = std::move(textureLod);
+                readyMeshLod = std::move(meshLod);
+                readyCopy = std::move(copy);
+                readySources = std::move(sources);
+                readyIndex = job->sceneIndex;
+                state.progress = 1.0f;
+                state.stage = "Ready";
+            }
+            state.loading = false;
+            state.error = error;
+            current.reset();
+        }
+    }
+
+    // An abandoned or evicted scene is released here, off the main thread.
+    released.clear();
+    scene.reset();
+    copy = RenderCopy{};
+    job->finished = true;
+}
+
+void AsyncSceneLoader::reapFinishedThreads() {
+    for (auto it = workers.begin(); it != workers.end();) {
+        if (it->job->finished) {
+            it->thread.join();
+            it = workers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <render3d/scene.hpp>
+#include "frame_state.hpp"
+#include "mesh_lod.hpp"
+#include "scene_cache.hpp"
+#include "scene_snapshot.hpp"
+#include "texture_lod.hpp"
+
+
+using namespace render3d;
+
+// Builds scenes on a background thread so the current scene keeps rendering
+// while the next one parses its YAML, imports meshes and decodes textures.
+// The application polls takeReady() at the start of a frame and swaps the
+// finished scene in there, outside any ImGui or render pass.
+//
+// Requesting a new scene cancels the one in flight; cancellation is checked
+// between solids, and an abandoned scene is discarded on its own thread.
+// Scenes handed back with retire() are kept in a SceneCache; requesting one
+// of those hands it over on the next takeReady() without loading anything.
+// After a scene is shown, prefetchAround() loads its neighbours in the
+// selector into the cache, one at a time and only while no requested load
+// is running. Requesting the scene being prefetched adopts that load.
+// Cached scenes are dropped once any file they were built from changes; the
+// loader remembers those files for every scene it hands out, and adopt()
+// records them for a scene loaded elsewhere, so retire() never reads the
+// YAML again. Scenes evicted from the cache are freed on a thread of their
+// own, like abandoned ones, rather than in the middle of a frame.
+//
+// With renderCopies set (the pipelined mode), every scene built is also
+// cloned on the loader thread (FrameState::clone) with LOD of its own, and
+// handed out and cached together with its copy. Cached scenes without one
+// are loaded again instead.
+//
+// Without thread support (Emscripten builds without pthreads) request()
+// loads synchronously, as scene selection did before, and nothing is
+// prefetched.
+//
+// All member functions are meant to be called from the main thread.
+
+class AsyncSceneLoader {
+public:
+    struct Status {
+        bool loading = false;
+        int sceneIndex = -1;
+        float progress = 0.0f;
+        std::string stage;
+        // Message of the last failed load, cleared by the next request.
+        std::string error;
+    };
+
+    AsyncSceneLoader() = default;
+    ~AsyncSceneLoader();
+
+    AsyncSceneLoader(const AsyncSceneLoader&) = delete;
+    AsyncSceneLoader& operator=(const AsyncSceneLoader&) = delete;
+
+    // Starts building scene `index`, or takes it from the cache. `background`
+    // replaces the background the scene file asks for, matching the
+    // background the user had selected.
+    void request(int index, Screen screen, BackgroundType background);
+
+    // Records the files scene `index` was built from when it was loaded
+    // without the loader (the start scene), so retire() can cache it.
+    void adopt(int index, std::vector<SceneSnapshot::Dependency> sources);
+
+    // Keeps a scene that is leaving the screen, and its render copy, for a
+    // later request(). A scene whose files are unknown (neither handed out
+    // nor adopted) is discarded instead.
+    void retire(int index, std::unique_ptr<Scene> scene, TextureLod textureLod, MeshLod meshLod,
+                RenderCopy copy = RenderCopy{});
+
+    // Frees a scene or render copy nobody needs any more on a worker thread.
+    void discard(std::unique_ptr<Scene> scene, TextureLod textureLod, MeshLod meshLod,
+                 RenderCopy copy = RenderCopy{});
+
+    // Queues the scenes before and after `index` for prefetching, replacing
+    // whatever was still queued. Does nothing while prefetch is off.
+    void prefetchAround(int index, Screen screen, BackgroundType background);
+
+    void setCacheBudget(size_t bytes);
+    SceneCache::Stats cacheStats() const;
+    size_t cacheBudget() const;
+    bool isPrefetching() const;
+
+    bool prefetch = true;
+    // Read by the loader thread when a scene is built.
+    std::atomic<bool> renderCopies{false};
+
+    // Abandons the load in flight, if any.
+    void cancel();
+
+    // Hands over a finished scene exactly once, with the index it was
+    // requested for; nullptr while none is ready. The scene's texture mip
+    // chains and mesh levels are built on the loader thread too and move into
+    // `textureLod` and `meshLod` when given (they are dropped otherwise), as
+    // does its render copy into `copy`.
+    std::unique_ptr<Scene> takeReady(int& sceneIndex, TextureLod* textureLod = nullptr,
+                                     MeshLod* meshLod = nullptr, RenderCopy* copy = nullptr);
+
+    Status status() const;
+
+private:
+    struct Job {
+        int sceneIndex = -1;
+        Screen screen{};
+        BackgroundType background{};
+        std::atomic<bool> cancelled{false};
+        std::atomic<bool> finished{false};
+    };
+
+    void run(const std::shared_ptr<Job>& job);
+    void reapFinishedThreads();
+    void startPrefetch();
+    void start(const std::shared_ptr<Job>& job);
+
+    // Frees cache entries on a worker thread (inline without threads).
+    void release(std::vector<SceneCache::Entry> entries);
+
+    mutable std::mutex mutex;
+    std::shared_ptr<Job> current;
+    std::unique_ptr<Scene> ready;
+    TextureLod readyTextureLod;
+    MeshLod readyMeshLod;
+    RenderCopy readyCopy;
+    std::vector<SceneSnapshot::Dependency> readySources;
+    int readyIndex = -1;
+    // Background of the last request(); scenes built or cached with another
+    // one get it in takeReady().
+    BackgroundType requestedBackground{};
+    Status state;
+
+    // Source files of the scenes handed out and not retired yet, by index.
+    std::map<int, std::vector<SceneSnapshot::Dependency>> shownSources;
+
+    SceneCache cache;
+    std::shared_ptr<Job> prefetching;
+    std::deque<int> prefetchQueue;
+    Screen prefetchScreen{};
+    BackgroundType prefetchBackground{};
+    int shownIndex = -1;
+
+    struct Worker {
+        std::shared_ptr<Job> job;
+        std::thread thread;
+    };
+    std::vector<Worker> workers;
+};
@@ -0,0 +1,273 @@
+#include "bench_report.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../assets/json_string.hpp"
+
+using namespace render3d;
+
+namespace {
+
+    void appendSummary(std::string& out, const char* key, const BenchReport::Summary& s) {
+        char text[192];
+        std::snprintf(text, sizeof(text),
+                      "\"%s\": {\"min\": %.4f, \"median\": %.4f, \"p95\": %.4f, "
+                      "\"p99\": %.4f, \"mean\": %.4f}",
+                      key, s.min, s.median, s.p95, s.p99, s.mean);
+        out += text;
+    }
+
+    // Reads the JSON subset toJson() writes (objects, arrays, strings and
+    // numbers) into a flat map from paths such as "scenes.0.frameMs.median"
+    // to the value's text.
+    class FlatReader {
+    public:
+        explicit FlatReader(const std::string& text) : text(text) {}
+
+        bool read(std::map<std::string, std::string>& values) {
+            out = &values;
+            skipSpace();
+            if (!value("")) {
+                return false;
+            }
+            skipSpace();
+            return pos == text.size();
+        }
+
+    private:
+        bool value(const std::string& path) {
+            skipSpace();
+            if (pos >= text.size()) {
+                return false;
+            }
+            const char c = text[pos];
+            if (c == '{') {
+                return object(path);
+            }
+            if (c == '[') {
+                return array(path);
+            }
+            std::string scalar;
+            if (c == '"') {
+                if (!string(scalar)) {
+                    return false;
+                }
+            } else {
+                const size_t start = pos;
+                while (pos < text.size() && (std::isalnum(static_cast<unsigned char>(text[pos])) ||
+                                             text[pos] == '-' || text[pos] == '+' || text[pos] == '.')) {
+                    ++pos;
+                }
+                if (pos == start) {
+                    return false;
+                }
+                scalar = text.substr(start, pos - start);
+            }
+            (*out)[path] = scalar;
+            return true;
+        }
+
+        bool object(const std::string& path) {
+            ++pos;  // '{'
+            skipSpace();
+            if (accept('}')) {
+                return true;
+            }
+            do {
+                skipSpace();
+                std::string key;
+                if (!string(key)) {
+                    return false;
+                }
+                skipSpace();
+                if (!accept(':') || !value(path.empty() ? key : path + "." + key)) {
+                    return false;
+                }
+                skipSpace();
+            } while (accept(','));
+            return accept('}');
+        }
+
+        bool array(const std::string& path) {
+            ++pos;  // '['
+            skipSpace();
+            if (accept(']')) {
+                return true;
+            }
+            size_t index = 0;
+            do {
+                const std::string item = std::to_string(index++);
+                if (!value(path.empty() ? item : path + "." + item)) {
+                    return false;
+                }
+                skipSpace();
+            } while (accept(','));
+            return accept(']');
+        }
+
+        // Only the escapes Json::appendString() writes are decoded.
+        bool string(std::string& result) {
+            if (!accept('"')) {
+                return false;
+            }
+            while (pos < text.size() && text[pos] != '"') {
+                if (text[pos] == '\\' && pos + 1 < text.size()) {
+                    ++pos;
+                    if (text[pos] == 'u' && pos + 5 <= text.size()) {
+                        const std::string hex = text.substr(pos + 1, 4);
+                        result += static_cast<char>(std::strtol(hex.c_str(), nullptr, 16));
+                        pos += 5;
+                        continue;
+                    }
+                }
+                result += text[pos++];
+            }
+            return accept('"');
+        }
+
+        bool accept(char c) {
+            if (pos < text.size() && text[pos] == c) {
+                ++pos;
+                return true;
+            }
+            return false;
+        }
+
+        void skipSpace() {
+            while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+                ++pos;
+            }
+        }
+
+        const std::string& text;
+        size_t pos = 0;
+        std::map<std::string, std::string>* out = nullptr;
+    };
+
+    bool readNumber(const std::map<std::string, std::string>& values, const std::string& path,
+                    double& number) {
+        auto it = values.find(path);
+        if (it == values.end()) {
+            return false;
+        }
+        char* end = nullptr;
+        number = std::strtod(it->second.c_str(), &end);
+        return end != it->second.c_str() && *end == '\0';
+    }
+
+}
+
+namespace BenchReport {
+
+void Counters::add(const Scene& scene) {
+    polysRendered += scene.stats.polysRendered;
+    pixelsRasterized += scene.stats.pixelsRasterized;
+    drawCalls += scene.stats.drawCalls;
+    verticesProcessed += scene.stats.verticesProcessed;
+}
+
+double percentile(std::vector<double> samples, double p) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * samples.size()));
+    rank = std::clamp<size_t>(rank, 1, samples.size());
+    std::nth_element(samples.begin(), samples.begin() + (rank - 1), samples.end());
+    return samples[rank - 1];
+}
+
+Summary summarize(const std::vector<double>& samples) {
+    Summary summary;
+    if (samples.empty()) {
+        return summary;
+    }
+    double total = 0.0;
+    for (double sample : samples) {
+        total += sample;
+    }
+    summary.min = *std::min_element(samples.begin(), samples.end());
+    summary.median = percentile(samples, 50.0);
+    summary.p95 = percentile(samples, 95.0);
+    summary.p99 = percentile(samples, 99.0);
+    summary.mean = total / samples.size();
+    return summary;
+}
+
+std::string toJson(const Report& report) {
+    char text[192];
+    std::snprintf(text, sizeof(text),
+                  "{\n  \"warmupFrames\": %d, \"frames\": %d, \"timestep\": %.6f, "
+                  "\"width\": %d, \"height\": %d,\n  \"scenes\": [",
+                  report.warmupFrames, report.frames, report.timestep, report.width,
+                  report.height);
+    std::string out = text;
+    for (size_t i = 0; i < report.scenes.size(); ++i) {
+        const SceneResult& scene = report.scenes[i];
+        out += i ? ",\n    {\"name\": " : "\n    {\"name\": ";
+        Json::appendString(out, scene.name);
+        out += ", \"frames\": " + std::to_string(scene.frames) + ",\n     ";
+        appendSummary(out, "frameMs", scene.frameMs);
+        out += ",\n     ";
+        appendSummary(out, "updateMs", scene.updateMs);
+        out += ",\n     ";
+        appendSummary(out, "lodMs", scene.lodMs);
+        out += ",\n     ";
+        appendSummary(out, "drawMs", scene.drawMs);
+        out += ",\n     \"stats\": {\"polysRendered\": " +
+               std::to_string(scene.counters.polysRendered) +
+               ", \"pixelsRasterized\": " + std::to_string(scene.counters.pixelsRasterized) +
+               ", \"drawCalls\": " + std::to_string(scene.counters.drawCalls) +
+               ", \"verticesProcessed\": " + std::to_string(scene.counters.verticesProcessed) +
+               "}}";
+    }
+    out += report.scenes.empty() ? "]\n}\n" : "\n  ]\n}\n";
+    return out;
+}
+
+bool parseBaseline(const std::string& json, std::map<std::string, Baseline>& baseline) {
+    std::map<std::string, std::string> values;
+    if (!FlatReader(json).read(values)) {
+        return false;
+    }
+    baseline.clear();
+    for (size_t i = 0;; ++i) {
+        const std::string prefix = "scenes." + std::to_string(i) + ".";
+        auto name = values.find(prefix + "name");
+        if (name == values.end()) {
+            break;
+        }
+        Baseline entry;
+        if (!readNumber(values, prefix + "frameMs.median", entry.median) ||
+            !readNumber(values, prefix + "frameMs.p95", entry.p95)) {
+            return false;
+        }
+        baseline[name->second] = entry;
+    }
+    return values.count("frames") > 0;
+}
+
+std::vector<Regression> compare(const Report& report,
+                                const std::map<std::string, Baseline>& baseline,
+                                double threshold) {
+    std::vector<Regression> regressions;
+    for (const SceneResult& scene : report.scenes) {
+        auto it = baseline.find(scene.name);
+        if (it == baseline.end()) {
+            continue;
+        }
+        auto check = [&](const char* metric, double before, double now) {
+            if (before > 0.0 && now > before * (1.0 + threshold)) {
+                regressions.push_back({scene.name, metric, before, now});
+            }
+        };
+        check("median", it->second.median, scene.frameMs.median);
+        check("p95", it->second.p95, scene.frameMs.p95);
+    }
+    return regressions;
+}
+
+} // namespace BenchReport
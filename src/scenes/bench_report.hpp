@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <render3d/scene.hpp>
+
+using namespace render3d;
+
+// Results of a benchmark run (--bench, see BenchRunner). For each scene the
+// measured frames' times are reduced to min/median/p95/p99/mean, the time of
+// each stage of a frame (scene update, LOD selection, drawing) to its median
+// and mean, and the Scene::stats counters drawScene leaves behind are summed
+// over the measured frames.
+//
+// A report written by toJson() can be read back with parseBaseline() and a
+// later run compared against it: a scene regresses when its median or p95
+// frame time grew by more than the threshold. Scenes missing from either side
+// are not compared.
+
+namespace BenchReport {
+
+    struct Summary {
+        double min = 0.0;
+        double median = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double mean = 0.0;
+    };
+
+    // Sums of Scene::stats over the measured frames.
+    struct Counters {
+        uint64_t polysRendered = 0;
+        uint64_t pixelsRasterized = 0;
+        uint64_t drawCalls = 0;
+        uint64_t verticesProcessed = 0;
+
+        void add(const Scene& scene);
+    };
+
+    struct SceneResult {
+        std::string name;
+        int frames = 0;          // measured, warm-up excluded
+        Summary frameMs;
+        Summary updateMs;        // Scene::update
+        Summary lodMs;           // TextureLod and MeshLod update
+        Summary drawMs;          // Renderer::drawScene
+        Counters counters;
+    };
+
+    struct Report {
+        int warmupFrames = 0;
+        int frames = 0;
+        float timestep = 0.0f;
+        int width = 0;
+        int height = 0;
+        std::vector<SceneResult> scenes;
+    };
+
+    // Nearest-rank percentile, `p` in [0, 100]; 0 for no samples.
+    double percentile(std::vector<double> samples, double p);
+
+    Summary summarize(const std::vector<double>& samples);
+
+    std::string toJson(const Report& report);
+
+    // Median and p95 frame time by scene name, read from toJson() output.
+    struct Baseline {
+        double median = 0.0;
+        double p95 = 0.0;
+    };
+    // Returns false when `json` is not a report this module wrote.
+    bool parseBaseline(const std::string& json, std::map<std::string, Baseline>& baseline);
+
+    struct Regression {
+        std::string scene;
+        const char* metric = "";  // "median" or "p95"
+        double baselineMs = 0.0;
+        double currentMs = 0.0;
+
+        double ratio() const { return baselineMs > 0.0 ? currentMs / baselineMs : 0.0; }
+    };
+
+    // Metrics of `report` slower than their baseline by more than
+    // `threshold` (0.1 = 10%).
+    std::vector<Regression> compare(const Report& report,
+                                    const std::map<std::string, Baseline>& baseline,
+                                    double threshold);
+
+} // namespace BenchReport
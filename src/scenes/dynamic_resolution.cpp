@@ -0,0 +1,67 @@
+#include "dynamic_resolution.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace render3d;
+
+namespace {
+
+    // Weight of the newest frame in the smoothed draw time.
+    constexpr double kSmoothing = 0.15;
+
+    // A single change moves the scale by at most this much, so one slow
+    // frame (a load hitch) cannot halve the resolution.
+    constexpr float kMaxChange = 0.25f;
+
+}
+
+bool DynamicResolution::update(double drawMs) {
+    const float lowest = std::clamp(minScale, kScaleStep, 1.0f);
+    float wanted = current;
+    if (!enabled) {
+        wanted = 1.0f;
+    } else {
+        averageMs = samples == 0 ? drawMs : averageMs + kSmoothing * (drawMs - averageMs);
+        ++samples;
+        ++framesSinceChange;
+        const bool outsideBand = averageMs > targetMs * kUpperBand ||
+                                 (averageMs < targetMs * kLowerBand && current < 1.0f);
+        if (outsideBand && framesSinceChange >= kCooldownFrames && averageMs > 0.0) {
+            float factor = static_cast<float>(std::sqrt(targetMs / averageMs));
+            wanted = current * std::clamp(factor, 1.0f - kMaxChange, 1.0f + kMaxChange);
+            wanted = std::round(wanted / kScaleStep) * kScaleStep;
+            // Just outside the band the factor rounds back to the current
+            // scale; move one step anyway.
+            if (averageMs > targetMs * kUpperBand) {
+                wanted = std::min(wanted, current - kScaleStep);
+            } else {
+                wanted = std::max(wanted, current + kScaleStep);
+            }
+        }
+        wanted = std::clamp(wanted, lowest, 1.0f);
+    }
+
+    if (std::fabs(wanted - current) < kScaleStep * 0.5f) {
+        return false;
+    }
+    current = wanted;
+    framesSinceChange = 0;
+    // The average describes the old size; start over from the next frame.
+    samples = 0;
+    return true;
+}
+
+void DynamicResolution::reset() {
+    averageMs = 0.0;
+    samples = 0;
+    framesSinceChange = 0;
+}
+
+Screen DynamicResolution::screenFor(Screen full) const {
+    auto side = [this](int length) {
+        int scaled = static_cast<int>(std::lround(length * current / 2.0f)) * 2;
+        return std::clamp(scaled, std::min(kMinSide, length), length);
+    };
+    return Screen{side(full.width), side(full.height)};
+}
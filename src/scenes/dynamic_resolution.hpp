@@ -0,0 +1,49 @@
+#pragma once
+
+#include <render3d/scene.hpp>
+
+using namespace render3d;
+
+// Picks the internal resolution that keeps the scene's draw time near a
+// target. update() takes each frame's Renderer::drawScene time; draw time
+// grows with the pixel count, so a smoothed time T moves the scale by
+// sqrt(target / T), quantized to kScaleStep. The scale only changes when T
+// leaves the band [target * kLowerBand, target * kUpperBand] and at most
+// once every kCooldownFrames, so it does not flicker between two sizes.
+//
+// The scale applies to both axes of the configured screen and never goes
+// above 1: render3d sizes some of a scene's buffers when the scene is
+// created, so the framebuffer may shrink below that size but not grow past
+// it. The presented image is stretched back to the window.
+
+class DynamicResolution {
+public:
+    // Feeds one frame's draw time. Returns true when scale() changed.
+    bool update(double drawMs);
+
+    // Drops the timing history, e.g. after a scene change; keeps the scale.
+    void reset();
+
+    float scale() const { return current; }
+    double smoothedMs() const { return averageMs; }
+
+    // `full` scaled by scale(), each side rounded to a multiple of 2 and at
+    // least kMinSide.
+    Screen screenFor(Screen full) const;
+
+    bool enabled = false;
+    float targetMs = 16.0f;
+    float minScale = 0.5f;
+
+    static constexpr float kScaleStep = 0.05f;
+    static constexpr float kLowerBand = 0.8f;
+    static constexpr float kUpperBand = 1.05f;
+    static constexpr int kCooldownFrames = 20;
+    static constexpr int kMinSide = 16;
+
+private:
+    float current = 1.0f;
+    double averageMs = 0.0;
+    int framesSinceChange = 0;
+    int samples = 0;
+};
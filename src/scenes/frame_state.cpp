@@ -0,0 +1,201 @@
+#include "frame_state.hpp"
+
+#include <utility>
+
+#include <render3d/ecs/light_component.hpp>
+#include <render3d/ecs/mesh_system.hpp>
+#include <render3d/ecs/name_component.hpp>
+#include <render3d/ecs/render_component.hpp>
+#include <render3d/ecs/transform_component.hpp>
+#include "../assets/background_factory.hpp"
+#include "../assets/profiler.hpp"
+
+using namespace render3d;
+
+namespace {
+
+    template <typename Store>
+    void copyComponent(const Store& from, Entity source, Store& to, Entity target) {
+        const auto* component = from.get(source);
+        auto* copy = to.get(target);
+        if (component && copy) {
+            *copy = *component;
+        }
+    }
+
+    // Gives `target` the component `source` has, or none if it has none.
+    template <typename Store>
+    void copyOrRemove(const Store& from, Entity source, Store& to, Entity target) {
+        const auto* component = from.get(source);
+        auto* copy = to.get(target);
+        if (component && copy) {
+            *copy = *component;
+        } else if (component) {
+            to.add(target, *component);
+        } else if (copy) {
+            to.remove(target);
+        }
+    }
+
+    // Shadow maps are render3d's own, sized on first use: the copy gets a
+    // fresh component rather than a copy of the other scene's maps.
+    void copyShadow(const Scene& from, Entity source, Scene& to, Entity target) {
+        const bool casts = from.registry.shadows().get(source) != nullptr;
+        const bool copied = to.registry.shadows().get(target) != nullptr;
+        if (casts && !copied) {
+            to.registry.shadows().add(target, ShadowComponent{});
+        } else if (!casts && copied) {
+            to.registry.shadows().remove(target);
+        }
+    }
+
+    void copyEntity(const Scene& from, Entity source, Scene& to, Entity target) {
+        copyOrRemove(from.registry.transforms(), source, to.registry.transforms(), target);
+        copyOrRemove(from.registry.meshes(), source, to.registry.meshes(), target);
+        copyOrRemove(from.registry.materials(), source, to.registry.materials(), target);
+        copyOrRemove(from.registry.renders(), source, to.registry.renders(), target);
+        copyOrRemove(from.registry.names(), source, to.registry.names(), target);
+        copyOrRemove(from.registry.lights(), source, to.registry.lights(), target);
+        copyShadow(from, source, to, target);
+        if (auto* mesh = to.registry.meshes().get(target)) {
+            MeshSystem::markBoundsDirty(*mesh);
+        }
+    }
+
+    void swapMaps(Material& a, Material& b) {
+        std::swap(a.map_Kd, b.map_Kd);
+        std::swap(a.map_Ks, b.map_Ks);
+        std::swap(a.map_Ns, b.map_Ns);
+    }
+
+    // Material properties without the texture maps: both sides' maps are
+    // parked while the material is assigned, then each side gets its own back.
+    void copyMaterialProperties(MaterialComponent& from, MaterialComponent& to) {
+        for (auto& [key, material] : from.materials) {
+            auto it = to.materials.find(key);
+            if (it == to.materials.end()) {
+                continue;
+            }
+            Material fromMaps;
+            Material toMaps;
+            swapMaps(fromMaps, material);
+            swapMaps(toMaps, it->second);
+            it->second = material;
+            swapMaps(it->second, toMaps);
+            swapMaps(material, fromMaps);
+        }
+    }
+
+    Entity entityAt(const Scene& scene, Entity entity, const Scene& other) {
+        for (size_t i = 0; i < scene.entities.size() && i < other.entities.size(); ++i) {
+            if (scene.entities[i] == entity) {
+                return other.entities[i];
+            }
+        }
+        return NULL_ENTITY;
+    }
+
+}
+
+namespace FrameState {
+
+std::unique_ptr<Scene> clone(const Scene& from) {
+    PROFILE_ZONE("FrameState::clone");
+    auto to = std::make_unique<Scene>(from.screen);
+    to->sceneType = from.sceneType;
+    to->name = from.name;
+    for (Entity source : from.entities) {
+        copyEntity(from, source, *to, to->createEntity());
+    }
+    to->Scene::setup();
+    to->backgroundType = from.backgroundType;
+    BackgroundFactory::setBackground(*to, BackgroundFactory::create(to->backgroundType));
+    copy(from, *to);
+    return to;
+}
+
+void copy(const Scene& from, Scene& to) {
+    PROFILE_ZONE("FrameState::copy");
+    to.camera = from.camera;
+    to.orbiting = from.orbiting;
+    to.selectedEntityIndex = from.selectedEntityIndex;
+    to.sceneCenter = from.sceneCenter;
+    to.sceneRadius = from.sceneRadius;
+
+    to.showAxes = from.showAxes;
+    to.depthSortEnabled = from.depthSortEnabled;
+    to.blinnPhong = from.blinnPhong;
+    to.shadowsEnabled = from.shadowsEnabled;
+    to.showShadowMapOverlay = from.showShadowMapOverlay;
+    to.useCubemapShadows = from.useCubemapShadows;
+    to.pcfRadius = from.pcfRadius;
+    to.cubeShadowMaxSlopeBias = from.cubeShadowMaxSlopeBias;
+    to.font = from.font;
+    if (to.backgroundType != from.backgroundType) {
+        to.backgroundType = from.backgroundType;
+        BackgroundFactory::setBackground(to, BackgroundFactory::create(to.backgroundType));
+    }
+
+    if (to.screen.width != from.screen.width || to.screen.height != from.screen.height) {
+        to.screen = from.screen;
+        to.pixels.resize(static_cast<size_t>(to.screen.width) * to.screen.height);
+    }
+
+    for (size_t i = 0; i < from.entities.size() && i < to.entities.size(); ++i) {
+        const Entity source = from.entities[i];
+        const Entity target = to.entities[i];
+        copyComponent(from.registry.transforms(), source, to.registry.transforms(), target);
+        copyComponent(from.registry.lights(), source, to.registry.lights(), target);
+        copyComponent(from.registry.renders(), source, to.registry.renders(), target);
+    }
+}
+
+std::vector<Entity> copyReload(Scene& from, Scene& to, const SceneReloader::Result& result) {
+    PROFILE_ZONE("FrameState::copyReload");
+    for (size_t slot : result.removedSlots) {
+        if (slot < to.entities.size()) {
+            to.registry.destroyEntity(to.entities[slot]);
+            to.entities.erase(to.entities.begin() + slot);
+        }
+    }
+    // Added entities were appended to `from`.
+    while (to.entities.size() < from.entities.size()) {
+        to.createEntity();
+    }
+
+    std::vector<Entity> rebuilt;
+    for (Entity source : result.rebuiltEntities) {
+        const Entity target = entityAt(from, source, to);
+        if (target != NULL_ENTITY) {
+            copyEntity(from, source, to, target);
+            rebuilt.push_back(target);
+        }
+    }
+    for (Entity source : result.patchedEntities) {
+        const Entity target = entityAt(from, source, to);
+        if (target == NULL_ENTITY) {
+            continue;
+        }
+        copyOrRemove(from.registry.names(), source, to.registry.names(), target);
+        copyOrRemove(from.registry.lights(), source, to.registry.lights(), target);
+        copyShadow(from, source, to, target);
+        auto* material = from.registry.materials().get(source);
+        auto* copied = to.registry.materials().get(target);
+        if (material && copied) {
+            copyMaterialProperties(*material, *copied);
+        }
+    }
+
+    to.selectedEntityIndex = from.selectedEntityIndex;
+    if (result.structural) {
+        to.Scene::setup();
+    }
+    return rebuilt;
+}
+
+void copyResults(const Scene& drawn, Scene& to) {
+    to.stats = drawn.stats;
+    to.spaceMatrix = drawn.spaceMatrix;
+}
+
+} // namespace FrameState
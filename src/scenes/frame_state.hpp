@@ -0,0 +1,57 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <render3d/scene.hpp>
+#include "mesh_lod.hpp"
+#include "scene_reloader.hpp"
+#include "texture_lod.hpp"
+
+using namespace render3d;
+
+// Per-frame state handed from the scene the main thread updates to a copy of
+// it, which the render thread draws meanwhile (Application::submitFrame).
+// AsyncSceneLoader clones every scene it builds when asked to, so the copy is
+// ready when the scene is swapped in. Scene::update moves transforms, lights
+// and the camera, and the UI edits those and the scene-wide render settings,
+// so that is what copy() carries each frame. Meshes and materials only change
+// with a hot reload, which copyReload() repeats on the copy entity by entity.
+
+// A scene's render copy, with LOD of its own.
+struct RenderCopy {
+    std::unique_ptr<Scene> scene;
+    TextureLod textureLod;
+    MeshLod meshLod;
+};
+
+namespace FrameState {
+
+    // A plain Scene with the entities of `from`, in the same order, copies
+    // of all their components, and the camera, render settings and
+    // framebuffer size of copy(). Scene::setup() has run on it. Drawing
+    // needs nothing a Scene subclass adds. Backgrounds cannot be copied: the
+    // clone gets BackgroundFactory's default one for the type. `from`'s LOD
+    // must be bound at full detail.
+    std::unique_ptr<Scene> clone(const Scene& from);
+
+    // Copies the camera, each entity's transform, light and render
+    // components, the render settings and the framebuffer size into `to`,
+    // a clone of `from`. A background of another type is created again with
+    // BackgroundFactory's default resources.
+    void copy(const Scene& from, Scene& to);
+
+    // Repeats on `to` what a hot reload did to `from`: removes the same
+    // entity slots, copies every component of rebuilt and added entities,
+    // and names, lights and material properties of patched ones. Texture
+    // maps of patched materials are moved out of `from` and back rather
+    // than copied, and `to` keeps the mip levels it has bound. `to`'s LOD
+    // must be restored first if entities were rebuilt or removed. Returns
+    // the entities of `to` whose LOD chains need rebuilding.
+    std::vector<Entity> copyReload(Scene& from, Scene& to, const SceneReloader::Result& result);
+
+    // Hands back what drawing `drawn` produced to the scene it was copied
+    // from: the render statistics and the view-projection matrix picking
+    // projects with, both of the frame on screen.
+    void copyResults(const Scene& drawn, Scene& to);
+
+} // namespace FrameState
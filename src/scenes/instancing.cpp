@@ -0,0 +1,190 @@
+#include "instancing.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <render3d/ecs/mesh_system.hpp>
+
+using namespace render3d;
+
+namespace {
+
+    constexpr float kTwoPi = 6.28318530718f;
+
+    // std::mt19937's sequence is fixed by the standard; the distributions
+    // are not, so the conversion to [0, 1) is done here.
+    float unit(std::mt19937& rng) {
+        return static_cast<float>(rng() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    float between(std::mt19937& rng, float lo, float hi) {
+        return lo + (hi - lo) * unit(rng);
+    }
+
+    std::string baseName(const SolidDescription& prototype) {
+        if (prototype.name) {
+            return *prototype.name;
+        }
+        if (!prototype.file.empty()) {
+            return std::filesystem::path(prototype.file).stem().string();
+        }
+        return prototype.type;
+    }
+
+    bool hasAngles(const InstancePlacement& placement) {
+        return placement.angles.x != 0.0f || placement.angles.y != 0.0f ||
+               placement.angles.z != 0.0f;
+    }
+
+}
+
+namespace Instancing {
+
+std::vector<InstancePlacement> place(const Options& options) {
+    std::vector<InstancePlacement> placements;
+
+    switch (options.layout) {
+    case Layout::Grid: {
+        const int nx = std::max(0, options.gridCount[0]);
+        const int ny = std::max(0, options.gridCount[1]);
+        const int nz = std::max(0, options.gridCount[2]);
+        placements.reserve(static_cast<size_t>(nx) * ny * nz);
+        for (int z = 0; z < nz; ++z) {
+            for (int y = 0; y < ny; ++y) {
+                for (int x = 0; x < nx; ++x) {
+                    InstancePlacement placement;
+                    placement.offset = {x * options.spacing.x, y * options.spacing.y,
+                                        z * options.spacing.z};
+                    placements.push_back(placement);
+                }
+            }
+        }
+        break;
+    }
+    case Layout::Ring: {
+        const int count = std::max(0, options.count);
+        placements.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            float angle = kTwoPi * static_cast<float>(i) / static_cast<float>(count);
+            InstancePlacement placement;
+            placement.offset = {options.radius * std::cos(angle), 0.0f,
+                                options.radius * std::sin(angle)};
+            placements.push_back(placement);
+        }
+        break;
+    }
+    case Layout::Random: {
+        const int count = std::max(0, options.count);
+        std::mt19937 rng(options.seed);
+        placements.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            InstancePlacement placement;
+            placement.offset.x = between(rng, options.boxMin.x, options.boxMax.x);
+            placement.offset.y = between(rng, options.boxMin.y, options.boxMax.y);
+            placement.offset.z = between(rng, options.boxMin.z, options.boxMax.z);
+            if (options.randomAngles) {
+                placement.angles.x = between(rng, 0.0f, 360.0f);
+                placement.angles.y = between(rng, 0.0f, 360.0f);
+                placement.angles.z = between(rng, 0.0f, 360.0f);
+            }
+            placement.scale = between(rng, options.scaleRange[0], options.scaleRange[1]);
+            placements.push_back(placement);
+        }
+        break;
+    }
+    case Layout::List:
+        placements = options.placements;
+        break;
+    }
+
+    return placements;
+}
+
+void expand(const SolidDescription& prototype, const Options& options,
+            std::vector<SolidDescription>& out) {
+    std::vector<InstancePlacement> placements = place(options);
+    if (placements.empty()) {
+        return;
+    }
+
+    const std::string name = baseName(prototype);
+
+    if (options.merge) {
+        if (prototype.orbit) {
+            throw std::runtime_error("instances of '" + name + "': merged instances cannot orbit");
+        }
+        for (const auto& placement : placements) {
+            if (hasAngles(placement)) {
+                throw std::runtime_error("instances of '" + name +
+                                         "': merged instances cannot vary angles");
+            }
+        }
+        SolidDescription solid = prototype;
+        solid.name = name;
+        solid.merged = std::move(placements);
+        out.push_back(std::move(solid));
+        return;
+    }
+
+    const slib::vec3 origin = prototype.position.value_or(slib::vec3{0, 0, 0});
+    const slib::vec3 angles = prototype.angles.value_or(slib::vec3{0, 0, 0});
+
+    out.reserve(out.size() + placements.size());
+    for (size_t i = 0; i < placements.size(); ++i) {
+        const InstancePlacement& placement = placements[i];
+        SolidDescription solid = prototype;
+        solid.name = name + "#" + std::to_string(i);
+        solid.position = slib::vec3{origin.x + placement.offset.x, origin.y + placement.offset.y,
+                                    origin.z + placement.offset.z};
+        if (prototype.angles || hasAngles(placement)) {
+            solid.angles = slib::vec3{angles.x + placement.angles.x, angles.y + placement.angles.y,
+                                      angles.z + placement.angles.z};
+        }
+        solid.zoomScale = prototype.zoomScale * placement.scale;
+        if (solid.orbit) {
+            solid.orbit->center.x += placement.offset.x;
+            solid.orbit->center.y += placement.offset.y;
+            solid.orbit->center.z += placement.offset.z;
+            solid.orbit->initialPhase += options.phaseStep * static_cast<float>(i);
+        }
+        out.push_back(std::move(solid));
+    }
+}
+
+void merge(MeshComponent& mesh, const std::vector<InstancePlacement>& placements, float zoom) {
+    const std::vector<VertexData> vertices = std::move(mesh.vertexData);
+    const std::vector<FaceData> faces = std::move(mesh.faceData);
+    const float inverseZoom = zoom != 0.0f ? 1.0f / zoom : 1.0f;
+
+    mesh.vertexData.clear();
+    mesh.faceData.clear();
+    mesh.vertexData.reserve(vertices.size() * placements.size());
+    mesh.faceData.reserve(faces.size() * placements.size());
+
+    for (const auto& placement : placements) {
+        const int base = static_cast<int>(mesh.vertexData.size());
+        const slib::vec3 offset{placement.offset.x * inverseZoom, placement.offset.y * inverseZoom,
+                                placement.offset.z * inverseZoom};
+        for (VertexData vertex : vertices) {
+            vertex.vertex.x = vertex.vertex.x * placement.scale + offset.x;
+            vertex.vertex.y = vertex.vertex.y * placement.scale + offset.y;
+            vertex.vertex.z = vertex.vertex.z * placement.scale + offset.z;
+            mesh.vertexData.push_back(vertex);
+        }
+        // Uniform scale and translation leave vertex and face normals as
+        // they are, so faces are copied with their indices shifted.
+        for (FaceData face : faces) {
+            for (int& index : face.face.vertexIndices) {
+                index += base;
+            }
+            mesh.faceData.push_back(std::move(face));
+        }
+    }
+
+    MeshSystem::updateRadius(mesh);
+}
+
+} // namespace Instancing
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <render3d/ecs/mesh_component.hpp>
+#include "scene_description.hpp"
+
+using namespace render3d;
+
+// Expansion of a scene file's `instances:` blocks. A block names one
+// prototype solid and a layout; every placement the layout produces becomes
+// a solid of its own, built through the same MeshLibrary entry so the asset
+// is imported or generated once.
+//
+// render3d keeps a mesh and a material by value in every entity, so those
+// solids still cost a mesh and material copy each. A block with `merge: true`
+// instead becomes a single solid whose mesh holds every instance: one mesh,
+// one material, however many instances. Merged instances are static and can
+// only vary position and scale.
+
+namespace Instancing {
+
+    enum class Layout { Grid, Ring, Random, List };
+
+    struct Options {
+        Layout layout = Layout::Grid;
+        std::array<int, 3> gridCount{1, 1, 1};  // grid: instances per axis
+        slib::vec3 spacing{0, 0, 0};             // grid: step per axis
+        int count = 0;                           // ring, random
+        float radius = 0.0f;                     // ring, in the XZ plane
+        slib::vec3 boxMin{0, 0, 0};              // random: offsets drawn in [boxMin, boxMax]
+        slib::vec3 boxMax{0, 0, 0};
+        uint32_t seed = 1;                       // random
+        bool randomAngles = false;               // random
+        std::array<float, 2> scaleRange{1.0f, 1.0f};  // random
+        std::vector<InstancePlacement> placements;    // list
+        float phaseStep = 0.0f;  // added to an orbit's initial phase per instance
+        bool merge = false;
+    };
+
+    // Placements in layout order. The same options (and seed) always give
+    // the same placements, on every platform.
+    std::vector<InstancePlacement> place(const Options& options);
+
+    // Appends the solids a block produces: one per placement, or a single
+    // merged solid. Instance names get a "#<n>" suffix.
+    void expand(const SolidDescription& prototype, const Options& options,
+                std::vector<SolidDescription>& out);
+
+    // Replaces `mesh` by one copy per placement. Offsets are in world units,
+    // so they are divided by `zoom`, the zoom the entity renders with.
+    void merge(MeshComponent& mesh, const std::vector<InstancePlacement>& placements, float zoom);
+
+} // namespace Instancing
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <functional>
+#include <string>
+
+// Hooks a caller can pass to scene construction to follow and abort it.
+// Both are optional; scene loading never calls an empty function.
+struct LoadProgress {
+    // Fraction in [0, 1] and a short description of the current step.
+    std::function<void(float, const std::string&)> report;
+    // Polled between steps; returning true abandons the load.
+    std::function<bool()> cancelled;
+
+    void update(float fraction, const std::string& stage) const {
+        if (report) report(fraction, stage);
+    }
+    bool isCancelled() const {
+        return cancelled && cancelled();
+    }
+};
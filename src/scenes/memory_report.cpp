@@ -0,0 +1,128 @@
+#include "memory_report.hpp"
+
+#include <cstdio>
+#include <render3d/ecs/light_component.hpp>
+#include <render3d/ecs/name_component.hpp>
+#include <render3d/ecs/shadow_component.hpp>
+#include "../assets/background_factory.hpp"
+#include "../assets/cubemap_loader.hpp"
+#include "../assets/json_string.hpp"
+#include "../assets/material_keys.hpp"
+#include "../assets/mipmap.hpp"
+#include "../assets/texture_cache.hpp"
+
+using namespace render3d;
+
+namespace {
+
+    void appendField(std::string& out, const char* key, size_t value, bool last = false) {
+        out += '"';
+        out += key;
+        out += "\": ";
+        out += std::to_string(value);
+        if (!last) {
+            out += ", ";
+        }
+    }
+
+}
+
+namespace MemoryReport {
+
+Report collect(Scene& scene, const TextureLod* textureLod, const MeshLod* meshLod,
+               const SceneCache::Stats* sceneCache) {
+    Report report;
+    report.scene = scene.name;
+    Registry& registry = scene.registry;
+
+    for (Entity entity : scene.entities) {
+        EntityBytes bytes;
+        bytes.entity = entity;
+        if (const auto* name = registry.names().get(entity)) {
+            bytes.name = name->name;
+        }
+        if (const auto* mesh = registry.meshes().get(entity)) {
+            bytes.vertices = mesh->vertexData.capacity() * sizeof(VertexData);
+            bytes.faces = mesh->faceData.capacity() * sizeof(FaceData) +
+                          MaterialKeys::keyHeapBytes(*mesh);
+            for (const auto& face : mesh->faceData) {
+                bytes.indices += face.face.vertexIndices.capacity() * sizeof(int);
+            }
+        }
+        if (const auto* material = registry.materials().get(entity)) {
+            for (const auto& [name, properties] : material->materials) {
+                bytes.textures += Mipmap::byteSize(properties.map_Kd) +
+                                  Mipmap::byteSize(properties.map_Ks) +
+                                  Mipmap::byteSize(properties.map_Ns);
+            }
+        }
+        if (registry.lights().get(entity)) {
+            bytes.light += sizeof(LightComponent);
+        }
+        if (registry.shadows().get(entity)) {
+            bytes.light += sizeof(ShadowComponent);
+        }
+        report.entityBytes += bytes.total();
+        report.entities.push_back(std::move(bytes));
+    }
+
+    auto add = [&report](const char* name, size_t bytes) {
+        report.resources.push_back({name, bytes});
+        report.resourceBytes += bytes;
+    };
+    add("Framebuffer", scene.pixels.capacity() * sizeof(scene.pixels[0]));
+    if (scene.backgroundType == BackgroundType::HDR_PANORAMA) {
+        add("HDR panorama", BackgroundFactory::hdrStatsFor(scene).residentBytes);
+    }
+    add("Skybox cache (process)", CubeMapLoader::stats().bytes);
+    add("Texture cache retained (process)", TextureCache::stats().bytes);
+    if (textureLod) {
+        add("Texture mip chains", textureLod->stats().chainBytes);
+    }
+    if (meshLod) {
+        add("Mesh LOD levels", meshLod->stats().levelBytes);
+    }
+    if (sceneCache) {
+        add("Cached scenes", sceneCache->bytes);
+    }
+    return report;
+}
+
+std::string toJson(const Report& report) {
+    std::string out = "{\n  \"scene\": ";
+    Json::appendString(out, report.scene);
+    out += ",\n  ";
+    appendField(out, "totalBytes", report.total());
+    appendField(out, "entityBytes", report.entityBytes);
+    appendField(out, "resourceBytes", report.resourceBytes, true);
+    out += ",\n  \"entities\": [";
+    for (size_t i = 0; i < report.entities.size(); ++i) {
+        const EntityBytes& entity = report.entities[i];
+        out += i ? ",\n    {" : "\n    {";
+        appendField(out, "entity", static_cast<size_t>(entity.entity));
+        out += "\"name\": ";
+        Json::appendString(out, entity.name);
+        out += ", ";
+        appendField(out, "vertexBytes", entity.vertices);
+        appendField(out, "faceBytes", entity.faces);
+        appendField(out, "indexBytes", entity.indices);
+        appendField(out, "textureBytes", entity.textures);
+        appendField(out, "lightBytes", entity.light);
+        appendField(out, "totalBytes", entity.total(), true);
+        out += '}';
+    }
+    out += report.entities.empty() ? "],\n  \"resources\": [" : "\n  ],\n  \"resources\": [";
+    for (size_t i = 0; i < report.resources.size(); ++i) {
+        const ResourceBytes& resource = report.resources[i];
+        out += i ? ",\n    {" : "\n    {";
+        out += "\"name\": ";
+        Json::appendString(out, resource.name);
+        out += ", ";
+        appendField(out, "bytes", resource.bytes, true);
+        out += '}';
+    }
+    out += report.resources.empty() ? "]\n}\n" : "\n  ]\n}\n";
+    return out;
+}
+
+} // namespace MemoryReport
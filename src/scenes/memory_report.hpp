@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <render3d/scene.hpp>
+#include "mesh_lod.hpp"
+#include "scene_cache.hpp"
+#include "texture_lod.hpp"
+
+using namespace render3d;
+
+// Where a scene's memory goes. collect() attributes bytes to each entity
+// (the arrays of its mesh, its material textures, its light) and to the
+// resources outside the registry: the framebuffer, the background, the
+// process-wide texture and skybox caches, the LOD levels not currently bound
+// and the scenes cached off screen.
+//
+// Sizes are those of the containers' allocations (capacity, not size).
+// Shadow depth maps are allocated inside render3d's shadow system and are
+// not visible from here; an entity's light column counts its Light and
+// Shadow components only. The HDR panorama is counted from what
+// BackgroundFactory recorded when the scene's own background was set.
+
+namespace MemoryReport {
+
+    struct EntityBytes {
+        Entity entity = NULL_ENTITY;
+        std::string name;
+        size_t vertices = 0;  // vertexData
+        size_t faces = 0;     // faceData, including material key strings
+        size_t indices = 0;   // each face's vertexIndices
+        size_t textures = 0;  // map_Kd/Ks/Ns of its materials, as bound
+        size_t light = 0;     // Light and Shadow components
+
+        size_t total() const { return vertices + faces + indices + textures + light; }
+    };
+
+    struct ResourceBytes {
+        std::string name;
+        size_t bytes = 0;
+    };
+
+    struct Report {
+        std::string scene;
+        std::vector<EntityBytes> entities;  // in scene.entities order
+        std::vector<ResourceBytes> resources;
+        size_t entityBytes = 0;
+        size_t resourceBytes = 0;
+
+        size_t total() const { return entityBytes + resourceBytes; }
+    };
+
+    // The LODs and cache statistics are optional; leaving one out leaves its
+    // resource out of the report.
+    Report collect(Scene& scene, const TextureLod* textureLod = nullptr,
+                   const MeshLod* meshLod = nullptr,
+                   const SceneCache::Stats* sceneCache = nullptr);
+
+    // The report as a JSON object, bytes as integers.
+    std::string toJson(const Report& report);
+
+} // namespace MemoryReport
@@ -0,0 +1,81 @@
+#include "mesh_library.hpp"
+
+#include <cstdio>
+#include "../assets/material_keys.hpp"
+#include "../assets/mesh_optimize.hpp"
+
+using namespace render3d;
+
+std::string MeshLibrary::keyFor(const SolidDescription& solid) {
+    std::string key = solid.type;
+    if (!solid.file.empty()) {
+        key += '|';
+        key += solid.file;
+    }
+    // params is ordered, so equal parameter sets give equal keys. %.9g keeps
+    // every float distinct.
+    char value[32];
+    for (const auto& [name, number] : solid.params) {
+        std::snprintf(value, sizeof(value), "%.9g", number);
+        key += '|';
+        key += name;
+        key += '=';
+        key += value;
+    }
+    return key;
+}
+
+size_t MeshLibrary::meshBytes(const MeshComponent& mesh) {
+    size_t bytes = mesh.vertexData.size() * sizeof(VertexData) +
+                   mesh.faceData.size() * sizeof(FaceData);
+    for (const auto& face : mesh.faceData) {
+        bytes += face.face.vertexIndices.size() * sizeof(face.face.vertexIndices[0]);
+    }
+    return bytes + MaterialKeys::keyHeapBytes(mesh);
+}
+
+bool MeshLibrary::acquire(const std::string& key, MeshComponent& mesh,
+                          MaterialComponent& material, TransformComponent& transform) {
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return false;
+    }
+    mesh = it->second.mesh;
+    material = it->second.material;
+    transform = it->second.transform;
+    ++counters.references;
+    counters.referencedBytes += it->second.bytes;
+    return true;
+}
+
+void MeshLibrary::add(const std::string& key, const MeshComponent& mesh,
+                      const MaterialComponent& material, const TransformComponent& transform) {
+    Entry entry{mesh, material, transform, meshBytes(mesh)};
+    const size_t bytes = entry.bytes;
+    if (!entries.emplace(key, std::move(entry)).second) {
+        return;
+    }
+    ++counters.meshes;
+    ++counters.references;
+    counters.uniqueBytes += bytes;
+    counters.referencedBytes += bytes;
+}
+
+void MeshLibrary::optimize(MeshComponent& mesh) {
+    if (!optimizeMeshes || mesh.faceData.empty()) {
+        return;
+    }
+    MeshOptimize::Result result = MeshOptimize::optimize(mesh);
+    ++counters.optimized;
+    counters.optimizedTriangles += result.triangles;
+    counters.cacheMissesBefore += static_cast<double>(result.acmrBefore) * result.triangles;
+    counters.cacheMissesAfter += static_cast<double>(result.acmrAfter) * result.triangles;
+}
+
+void MeshLibrary::addUnshared(const MeshComponent& mesh) {
+    const size_t bytes = meshBytes(mesh);
+    ++counters.meshes;
+    ++counters.references;
+    counters.uniqueBytes += bytes;
+    counters.referencedBytes += bytes;
+}
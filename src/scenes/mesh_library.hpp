@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <render3d/ecs/material_component.hpp>
+#include <render3d/ecs/mesh_component.hpp>
+#include <render3d/ecs/transform_component.hpp>
+#include "scene_description.hpp"
+
+using namespace render3d;
+
+// Geometry shared by the solids of one scene load. Solids that name the same
+// model file, or the same procedural type with the same parameters, are
+// imported or generated once; the others start from a copy of that result.
+//
+// render3d's registry stores a MeshComponent and a MaterialComponent by value
+// in every entity, so the copies still hold their own vertex and face arrays.
+// What is shared is the work: parsing, deduplication, normal generation and
+// texture decoding happen once per unique asset. stats() reports both sizes:
+// the bytes of the unique meshes, and the bytes the entities hold.
+//
+// With optimizeMeshes set, optimize() reorders each freshly built mesh with
+// MeshOptimize before it is shared; the copies inherit the order.
+
+class MeshLibrary {
+public:
+    struct Stats {
+        size_t meshes = 0;           // unique meshes built
+        size_t references = 0;       // entities using them
+        size_t uniqueBytes = 0;      // bytes of the unique meshes
+        size_t referencedBytes = 0;  // bytes held by all the entities
+        // Meshes optimize() reordered, their triangles and their vertex
+        // cache misses (ACMR x triangles) before and after.
+        size_t optimized = 0;
+        size_t optimizedTriangles = 0;
+        double cacheMissesBefore = 0.0;
+        double cacheMissesAfter = 0.0;
+    };
+
+    // Identifies the asset a solid builds: the file for imported solids, the
+    // type and builder parameters otherwise.
+    static std::string keyFor(const SolidDescription& solid);
+
+    static size_t meshBytes(const MeshComponent& mesh);
+
+    // Copies the components built for `key` and counts a reference. Returns
+    // false when nothing was built for it yet.
+    bool acquire(const std::string& key, MeshComponent& mesh,
+                 MaterialComponent& material, TransformComponent& transform);
+
+    // Keeps freshly built components under `key` and counts their entity.
+    void add(const std::string& key, const MeshComponent& mesh,
+             const MaterialComponent& material, const TransformComponent& transform);
+
+    // Reorders a freshly built mesh when optimizeMeshes is set.
+    void optimize(MeshComponent& mesh);
+
+    // Counts a mesh built for one entity only, such as a merged instance
+    // block; nothing is kept.
+    void addUnshared(const MeshComponent& mesh);
+
+    const Stats& stats() const { return counters; }
+
+    bool optimizeMeshes = false;
+
+private:
+    struct Entry {
+        MeshComponent mesh;
+        MaterialComponent material;
+        TransformComponent transform;
+        size_t bytes = 0;
+    };
+
+    std::map<std::string, Entry> entries;
+    Stats counters;
+};
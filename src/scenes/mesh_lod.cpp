@@ -0,0 +1,289 @@
+#include "mesh_lod.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+
+#include <render3d/ecs/mesh_system.hpp>
+#include <render3d/ecs/transform_system.hpp>
+#include "../assets/mesh_simplify.hpp"
+#include "../assets/parallel_for.hpp"
+#include "../assets/profiler.hpp"
+
+using namespace render3d;
+
+namespace {
+
+    // How far past a level boundary (in levels) the estimate must move before
+    // the bound level follows, as in TextureLod.
+    constexpr float kHysteresis = 0.25f;
+
+    constexpr float kDegreesToRadians = 3.14159265358979f / 180.0f;
+
+    // Identifies a mesh's geometry and the attributes its levels copy
+    // (texture coordinates, normals, material keys), so the copies of one
+    // solid share their simplification.
+    uint64_t geometryHash(const MeshComponent& mesh) {
+        uint64_t hash = 14695981039346656037ull;
+        auto mix = [&hash](const void* data, size_t size) {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; ++i) {
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            }
+        };
+        const size_t counts[2] = {mesh.vertexData.size(), mesh.faceData.size()};
+        mix(counts, sizeof(counts));
+        for (const auto& vertex : mesh.vertexData) {
+            const float attributes[8] = {vertex.vertex.x,   vertex.vertex.y,   vertex.vertex.z,
+                                         vertex.texCoord.x, vertex.texCoord.y, vertex.normal.x,
+                                         vertex.normal.y,   vertex.normal.z};
+            mix(attributes, sizeof(attributes));
+        }
+        for (const auto& face : mesh.faceData) {
+            mix(face.face.vertexIndices.data(), face.face.vertexIndices.size() * sizeof(int));
+            mix(face.face.materialKey.data(), face.face.materialKey.size() + 1);
+        }
+        return hash;
+    }
+
+    // Exact check behind a hash match, so a collision never hands one mesh
+    // another's levels.
+    bool sameGeometry(const MeshComponent& a, const MeshComponent& b) {
+        if (&a == &b) {
+            return true;
+        }
+        if (a.vertexData.size() != b.vertexData.size() || a.faceData.size() != b.faceData.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.vertexData.size(); ++i) {
+            const VertexData& va = a.vertexData[i];
+            const VertexData& vb = b.vertexData[i];
+            if (va.vertex.x != vb.vertex.x || va.vertex.y != vb.vertex.y ||
+                va.vertex.z != vb.vertex.z || va.texCoord.x != vb.texCoord.x ||
+                va.texCoord.y != vb.texCoord.y || va.normal.x != vb.normal.x ||
+                va.normal.y != vb.normal.y || va.normal.z != vb.normal.z) {
+                return false;
+            }
+        }
+        for (size_t i = 0; i < a.faceData.size(); ++i) {
+            if (a.faceData[i].face.vertexIndices != b.faceData[i].face.vertexIndices ||
+                a.faceData[i].face.materialKey != b.faceData[i].face.materialKey) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t levelBytes(const std::vector<VertexData>& vertices, const std::vector<FaceData>& faces) {
+        size_t bytes = vertices.size() * sizeof(VertexData) + faces.size() * sizeof(FaceData);
+        for (const auto& face : faces) {
+            bytes += face.face.vertexIndices.size() * sizeof(int);
+        }
+        return bytes;
+    }
+
+    // Levels below full detail the entity's projected size calls for:
+    // log2(kFullDetailPixels / projected diameter); <= 0 means full detail.
+    float detailLevel(const Scene& scene, Entity entity) {
+        const auto* transform = scene.registry.transforms().get(entity);
+        const auto* mesh = scene.registry.meshes().get(entity);
+        if (!transform || !mesh || mesh->radius <= 0.0f) {
+            return 0.0f;
+        }
+
+        float radius = mesh->radius * transform->position.zoom;
+        slib::vec3 center = TransformSystem::getWorldCenter(*transform);
+        float dx = center.x - scene.camera.pos.x;
+        float dy = center.y - scene.camera.pos.y;
+        float dz = center.z - scene.camera.pos.z;
+        float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+        if (distance <= radius) {
+            return 0.0f;
+        }
+
+        float focal = 0.5f * scene.screen.height /
+                      std::tan(0.5f * scene.camera.viewAngle * kDegreesToRadians);
+        float projectedPixels = 2.0f * radius * focal / distance;
+        if (projectedPixels <= 1.0f) {
+            projectedPixels = 1.0f;
+        }
+        return std::log2(MeshLod::kFullDetailPixels / projectedPixels);
+    }
+}
+
+void MeshLod::build(Scene& scene) {
+    PROFILE_ZONE("MeshLod::build");
+    chains.clear();
+    counters = Stats{};
+    addChains(scene, scene.entities);
+    countLevels();
+}
+
+void MeshLod::rebuild(Scene& scene, const std::vector<Entity>& entities) {
+    PROFILE_ZONE("MeshLod::rebuild");
+    auto contains = [](const std::vector<Entity>& list, Entity entity) {
+        return std::find(list.begin(), list.end(), entity) != list.end();
+    };
+    auto stale = std::remove_if(chains.begin(), chains.end(), [&](const Chain& chain) {
+        return contains(entities, chain.entity) || !contains(scene.entities, chain.entity);
+    });
+    for (auto it = stale; it != chains.end(); ++it) {
+        for (size_t level = 1; level < it->levels.size(); ++level) {
+            counters.levelBytes -= levelBytes(it->levels[level].vertices, it->levels[level].faces);
+        }
+        counters.meshes--;
+        counters.fullTriangles -= it->levels[0].triangles;
+    }
+    chains.erase(stale, chains.end());
+
+    std::vector<Entity> live;
+    for (Entity entity : entities) {
+        if (contains(scene.entities, entity) && !contains(live, entity)) {
+            live.push_back(entity);
+        }
+    }
+    addChains(scene, live);
+    countLevels();
+}
+
+void MeshLod::addChains(Scene& scene, const std::vector<Entity>& entities) {
+    struct Source {
+        const MeshComponent* mesh = nullptr;
+        std::vector<Entity> entities;
+        std::vector<Level> levels;  // 1..n
+    };
+    std::vector<Source> sources;
+    std::unordered_map<uint64_t, std::vector<size_t>> byHash;
+
+    for (Entity entity : entities) {
+        const auto* mesh = scene.registry.meshes().get(entity);
+        if (!mesh) {
+            continue;
+        }
+        size_t triangles = MeshSimplify::triangleCount(*mesh);
+        if (triangles < kMinTriangles || triangles > kMaxTriangles) {
+            continue;
+        }
+        std::vector<size_t>& candidates = byHash[geometryHash(*mesh)];
+        auto match = std::find_if(candidates.begin(), candidates.end(), [&](size_t source) {
+            return sameGeometry(*sources[source].mesh, *mesh);
+        });
+        if (match == candidates.end()) {
+            match = candidates.insert(candidates.end(), sources.size());
+            sources.push_back({mesh, {}, {}});
+        }
+        sources[*match].entities.push_back(entity);
+    }
+
+    Parallel::forEach(sources.size(), [&](size_t i) {
+        PROFILE_ZONE("Simplify mesh");
+        Source& source = sources[i];
+        const MeshComponent* previous = source.mesh;
+        MeshComponent simplified;
+        size_t triangles = MeshSimplify::triangleCount(*previous);
+        while (static_cast<int>(source.levels.size()) + 1 < kMaxLevels &&
+               triangles / 2 >= kMinLevelTriangles) {
+            simplified = MeshSimplify::simplify(*previous, triangles / 2);
+            size_t reached = MeshSimplify::triangleCount(simplified);
+            // Stop once collapses run out instead of storing near-copies.
+            if (reached > triangles * 3 / 4) {
+                break;
+            }
+            Level level;
+            level.triangles = reached;
+            level.vertices = std::move(simplified.vertexData);
+            level.faces = std::move(simplified.faceData);
+            source.levels.push_back(std::move(level));
+
+            // The next level starts from this one.
+            simplified.vertexData = source.levels.back().vertices;
+            simplified.faceData = source.levels.back().faces;
+            simplified.radius = source.mesh->radius;
+            previous = &simplified;
+            triangles = reached;
+        }
+    });
+
+    for (Source& source : sources) {
+        if (source.levels.empty()) {
+            continue;
+        }
+        const size_t fullTriangles = MeshSimplify::triangleCount(*source.mesh);
+        for (size_t e = 0; e < source.entities.size(); ++e) {
+            Chain chain;
+            chain.entity = source.entities[e];
+            chain.levels.emplace_back();
+            chain.levels[0].triangles = fullTriangles;
+            const bool last = e + 1 == source.entities.size();
+            for (Level& level : source.levels) {
+                counters.levelBytes += levelBytes(level.vertices, level.faces);
+                chain.levels.push_back(last ? std::move(level) : level);
+            }
+            counters.meshes++;
+            counters.fullTriangles += fullTriangles;
+            chains.push_back(std::move(chain));
+        }
+    }
+}
+
+void MeshLod::update(Scene& scene) {
+    PROFILE_ZONE("MeshLod::update");
+    if (!enabled) {
+        restore(scene);
+        return;
+    }
+
+    for (Chain& chain : chains) {
+        int top = static_cast<int>(chain.levels.size()) - 1;
+        float estimate = detailLevel(scene, chain.entity);
+
+        int level = chain.bound;
+        if (estimate >= chain.bound + 1 + kHysteresis || estimate < chain.bound - kHysteresis) {
+            level = std::clamp(static_cast<int>(std::floor(estimate)), 0, top);
+        }
+        bind(scene, chain, level);
+    }
+    countLevels();
+}
+
+void MeshLod::restore(Scene& scene) {
+    for (Chain& chain : chains) {
+        bind(scene, chain, 0);
+    }
+    countLevels();
+}
+
+void MeshLod::bind(Scene& scene, Chain& chain, int level) {
+    if (level == chain.bound) {
+        return;
+    }
+    MeshComponent* mesh = scene.registry.meshes().get(chain.entity);
+    if (!mesh) {
+        return;
+    }
+    // Return the bound level to its slot, then take the new one out of its.
+    std::swap(mesh->vertexData, chain.levels[chain.bound].vertices);
+    std::swap(mesh->faceData, chain.levels[chain.bound].faces);
+    std::swap(mesh->vertexData, chain.levels[level].vertices);
+    std::swap(mesh->faceData, chain.levels[level].faces);
+    chain.bound = level;
+    MeshSystem::markBoundsDirty(*mesh);
+}
+
+void MeshLod::countLevels() {
+    counters.reduced = 0;
+    counters.boundTriangles = 0;
+    counters.meshesPerLevel.assign(kMaxLevels, 0);
+    counters.trianglesPerLevel.assign(kMaxLevels, 0);
+    for (const Chain& chain : chains) {
+        const size_t triangles = chain.levels[chain.bound].triangles;
+        counters.boundTriangles += triangles;
+        counters.meshesPerLevel[chain.bound]++;
+        counters.trianglesPerLevel[chain.bound] += triangles;
+        if (chain.bound > 0) {
+            counters.reduced++;
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <render3d/scene.hpp>
+
+using namespace render3d;
+
+// Screen-size mesh LOD. build() simplifies every mesh of at least
+// kMinTriangles into a chain of levels with half the triangles of the one
+// above (MeshSimplify); update() estimates each entity's projected size from
+// its bounding radius and distance and binds the matching level into the
+// MeshComponent. An entity kFullDetailPixels across or larger keeps full
+// detail; each halving of that size drops one level.
+//
+// Like TextureLod, levels move in and out of the meshes with std::swap, so
+// changing level never copies vertices. Meshes with the same geometry (the
+// copies of a repeated solid) are simplified once. Meshes above
+// kMaxTriangles are left alone: they are environments the camera moves
+// through, and would only add load time.
+//
+// build() may run on a loader thread before the scene is shown; update() and
+// restore() belong to the thread that renders the scene.
+
+class MeshLod {
+public:
+    struct Stats {
+        size_t meshes = 0;          // meshes with simplified levels
+        size_t reduced = 0;         // of those, bound below full detail this frame
+        size_t fullTriangles = 0;   // triangles of those meshes at full detail
+        size_t boundTriangles = 0;  // triangles of the levels currently bound
+        size_t levelBytes = 0;      // memory held by levels 1..n
+        // Indexed by level: meshes bound at it and their triangles.
+        std::vector<size_t> meshesPerLevel;
+        std::vector<size_t> trianglesPerLevel;
+    };
+
+    // Replaces whatever this object held for a previous scene.
+    void build(Scene& scene);
+
+    // Simplifies the meshes of `entities` again after they were replaced in
+    // place or added, and drops the chains of entities no longer in the
+    // scene. Other chains are kept as they are. restore() must have bound
+    // full detail before the meshes were replaced.
+    void rebuild(Scene& scene, const std::vector<Entity>& entities);
+
+    // Picks each entity's level for the current camera and binds it.
+    void update(Scene& scene);
+
+    // Binds full-detail meshes again, e.g. before LOD is switched off.
+    void restore(Scene& scene);
+
+    const Stats& stats() const { return counters; }
+
+    bool enabled = true;
+
+    static constexpr size_t kMinTriangles = 256;
+    static constexpr size_t kMaxTriangles = 200000;
+    static constexpr size_t kMinLevelTriangles = 64;
+    static constexpr int kMaxLevels = 5;  // including full detail
+    static constexpr float kFullDetailPixels = 256.0f;
+
+private:
+    struct Level {
+        std::vector<VertexData> vertices;
+        std::vector<FaceData> faces;
+        size_t triangles = 0;
+    };
+
+    struct Chain {
+        Entity entity = NULL_ENTITY;
+        // levels[bound] holds whatever the mesh held before level `bound`
+        // was swapped in: the full mesh lives in levels[0] whenever a
+        // simplified level is bound.
+        std::vector<Level> levels;
+        int bound = 0;
+    };
+
+    void addChains(Scene& scene, const std::vector<Entity>& entities);
+    void bind(Scene& scene, Chain& chain, int level);
+    void countLevels();
+
+    std::vector<Chain> chains;
+    Stats counters;
+};
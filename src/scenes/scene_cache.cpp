@@ -0,0 +1,110 @@
+#include "scene_cache.hpp"
+
+#include "../assets/mipmap.hpp"
+#include "mesh_library.hpp"
+
+using namespace render3d;
+
+std::vector<SceneCache::Entry> SceneCache::store(int index,
+                                                 std::vector<SceneSnapshot::Dependency> sources,
+                                                 std::unique_ptr<Scene> scene,
+                                                 TextureLod textureLod, MeshLod meshLod,
+                                                 RenderCopy copy) {
+    std::vector<Entry> released;
+    if (!scene) {
+        return released;
+    }
+
+    auto existing = entries.find(index);
+    if (existing != entries.end()) {
+        counters.bytes -= existing->second.bytes;
+        released.push_back(std::move(existing->second));
+        entries.erase(existing);
+    }
+
+    Entry entry;
+    entry.bytes = estimateBytes(*scene, textureLod, meshLod);
+    if (copy.scene) {
+        entry.bytes += estimateBytes(*copy.scene, copy.textureLod, copy.meshLod);
+    }
+    entry.scene = std::move(scene);
+    entry.textureLod = std::move(textureLod);
+    entry.meshLod = std::move(meshLod);
+    entry.copy = std::move(copy);
+    entry.sources = std::move(sources);
+    entry.lastUse = ++clock;
+    counters.bytes += entry.bytes;
+    entries.emplace(index, std::move(entry));
+
+    evict(released);
+    counters.scenes = entries.size();
+    return released;
+}
+
+bool SceneCache::take(int index, bool needCopy, Entry& taken, std::vector<Entry>& released) {
+    auto it = entries.find(index);
+    if (it == entries.end()) {
+        ++counters.misses;
+        return false;
+    }
+
+    counters.bytes -= it->second.bytes;
+    // A file it was built from changed on disk since it was cached, or the
+    // pipelined mode was switched on after.
+    const bool hit = SceneSnapshot::isCurrent(it->second.sources) &&
+                     (!needCopy || it->second.copy.scene);
+    if (hit) {
+        ++counters.hits;
+        taken = std::move(it->second);
+        if (!needCopy && taken.copy.scene) {
+            Entry unused;
+            unused.copy = std::move(taken.copy);
+            taken.copy = RenderCopy{};
+            released.push_back(std::move(unused));
+        }
+    } else {
+        ++counters.misses;
+        released.push_back(std::move(it->second));
+    }
+    entries.erase(it);
+    counters.scenes = entries.size();
+    return hit;
+}
+
+std::vector<SceneCache::Entry> SceneCache::setBudget(size_t bytes) {
+    budgetBytes = bytes;
+    std::vector<Entry> released;
+    evict(released);
+    counters.scenes = entries.size();
+    return released;
+}
+
+void SceneCache::evict(std::vector<Entry>& released) {
+    while (counters.bytes > budgetBytes && !entries.empty()) {
+        auto oldest = entries.begin();
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->second.lastUse < oldest->second.lastUse) {
+                oldest = it;
+            }
+        }
+        counters.bytes -= oldest->second.bytes;
+        released.push_back(std::move(oldest->second));
+        entries.erase(oldest);
+        ++counters.evictions;
+    }
+}
+
+size_t SceneCache::estimateBytes(Scene& scene, const TextureLod& textureLod,
+                                 const MeshLod& meshLod) {
+    size_t bytes = scene.pixels.size() * sizeof(scene.pixels[0]);
+    for (const auto& [entity, mesh] : scene.registry.meshes()) {
+        bytes += MeshLibrary::meshBytes(mesh);
+    }
+    for (const auto& [entity, material] : scene.registry.materials()) {
+        for (const auto& [name, properties] : material.materials) {
+            bytes += Mipmap::byteSize(properties.map_Kd) + Mipmap::byteSize(properties.map_Ks) +
+                     Mipmap::byteSize(properties.map_Ns);
+        }
+    }
+    return bytes + textureLod.stats().chainBytes + meshLod.stats().levelBytes;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+#include <render3d/scene.hpp>
+#include "frame_state.hpp"
+#include "mesh_lod.hpp"
+#include "scene_snapshot.hpp"
+#include "texture_lod.hpp"
+
+using namespace render3d;
+
+// Scenes kept alive after they leave the screen, so selecting one again is a
+// pointer swap instead of a load. Entries are keyed by scene index and
+// evicted least recently stored first once their estimated size exceeds the
+// budget.
+//
+// Each entry remembers the files its scene was built from, with their size
+// and modification time (SceneSnapshot::sceneDependencies); take() drops an
+// entry once any of them has changed. An entry can carry the scene's render
+// copy for the pipelined mode; its size counts against the budget too. The
+// cache does no locking of its own: AsyncSceneLoader only touches it under
+// its mutex.
+
+class SceneCache {
+public:
+    struct Stats {
+        size_t scenes = 0;
+        size_t bytes = 0;      // estimated size of the cached scenes
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;  // including scenes too large to keep at all
+    };
+
+    // A cached scene with its mip chains, mesh levels, render copy and
+    // source files.
+    struct Entry {
+        std::unique_ptr<Scene> scene;
+        TextureLod textureLod;
+        MeshLod meshLod;
+        RenderCopy copy;
+        std::vector<SceneSnapshot::Dependency> sources;
+        size_t bytes = 0;
+        uint64_t lastUse = 0;
+    };
+
+    static constexpr size_t kDefaultBudget = size_t(512) << 20;
+
+    explicit SceneCache(size_t budgetBytes = kDefaultBudget) : budgetBytes(budgetBytes) {}
+
+    // Keeps `scene` for `index`, replacing any older entry. Returns the
+    // entries evicted to stay within budget, possibly `scene` itself, whole:
+    // nothing is freed here, so the caller can release them outside its
+    // locks and off the main thread.
+    std::vector<Entry> store(int index, std::vector<SceneSnapshot::Dependency> sources,
+                             std::unique_ptr<Scene> scene, TextureLod textureLod,
+                             MeshLod meshLod, RenderCopy copy = RenderCopy{});
+
+    // Moves the entry cached for `index` into `taken` and forgets it. False
+    // if there is none, one of its files has changed, or `needCopy` is set
+    // and it has no render copy; such an entry goes to `released`. A render
+    // copy nobody needs goes there too.
+    bool take(int index, bool needCopy, Entry& taken, std::vector<Entry>& released);
+
+    bool contains(int index) const { return entries.count(index) > 0; }
+
+    // Shrinking the budget evicts at once; see store() for the result.
+    std::vector<Entry> setBudget(size_t bytes);
+    size_t budget() const { return budgetBytes; }
+
+    const Stats& stats() const { return counters; }
+
+    // Vertex, face, texture, mip chain, mesh level and framebuffer bytes of
+    // a scene. Backgrounds are not counted; a render copy is counted as a
+    // scene of its own.
+    static size_t estimateBytes(Scene& scene, const TextureLod& textureLod,
+                                const MeshLod& meshLod);
+
+private:
+    void evict(std::vector<Entry>& released);
+
+    std::map<int, Entry> entries;
+    size_t budgetBytes;
+    uint64_t clock = 0;
+    Stats counters;
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+#include <render3d/scene.hpp>
+#include <render3d/ecs/light_component.hpp>
+#include <render3d/ecs/render_component.hpp>
+
+
+using namespace render3d;
+
+// A scene file as plain data. SceneLoader parses YAML into this and builds
+// the Scene from it; SceneSnapshot stores it so the YAML need not be read
+// again. Optional fields are keys the file may leave out: the builder keeps
+// the engine's defaults for them, exactly as when it read the YAML directly.
+
+struct CameraDescription {
+    std::optional<slib::vec3> position;
+    std::optional<slib::vec3> forward;
+    std::optional<float> pitch, yaw, roll;
+    std::optional<float> zNear, zFar, viewAngle;
+    std::optional<float> speed, eagerness, sensitivity;
+};
+
+struct LightDescription {
+    std::optional<LightType> type;
+    std::optional<slib::vec3> color;
+    std::optional<float> intensity;
+    std::optional<slib::vec3> direction;
+    std::optional<float> radius;
+    std::optional<float> innerCutoff;
+    std::optional<float> outerCutoff;
+};
+
+// Arguments for TransformSystem::enableCircularOrbit, with the YAML defaults.
+struct OrbitDescription {
+    slib::vec3 center{0, 0, 0};
+    float radius = 1.0f;
+    slib::vec3 planeNormal{0, 1, 0};
+    float omega = 1.0f;
+    float initialPhase = 0.0f;
+};
+
+// One copy of a solid placed by an `instances:` block, relative to the
+// block's prototype solid.
+struct InstancePlacement {
+    slib::vec3 offset{0, 0, 0};  // added to the prototype position
+    slib::vec3 angles{0, 0, 0};  // added to the prototype angles, degrees
+    float scale = 1.0f;          // multiplies the prototype zoom
+};
+
+struct SolidDescription {
+    std::string type;
+    std::string file;  // obj_loader / asc_loader
+    std::optional<std::string> name;
+    // Numeric builder parameters present in the file (u_steps, latitude, ...).
+    std::map<std::string, float> params;
+    bool useMeshCache = true;
+
+    std::optional<slib::vec3> position;
+    std::optional<slib::vec3> angles;
+    std::optional<float> zoom;
+    std::optional<Shading> shading;
+    std::optional<bool> rotationEnabled;
+    std::optional<std::array<float, 2>> rotationSpeed;
+    std::optional<LightDescription> light;
+    std::optional<slib::vec3> emissiveColor;
+    std::optional<OrbitDescription> orbit;
+
+    // Set on solids generated by an `instances:` block.
+    float zoomScale = 1.0f;  // multiplies the zoom the solid ends up with
+    // Non-empty for a merged block: this one solid carries every instance,
+    // baked into its mesh (see Instancing::merge).
+    std::vector<InstancePlacement> merged;
+
+    float param(const std::string& key, float fallback) const {
+        auto it = params.find(key);
+        return it == params.end() ? fallback : it->second;
+    }
+};
+
+struct BackgroundDescription {
+    BackgroundType type = BackgroundType::DESERT;
+    // px, nx, py, ny, pz, nz
+    std::optional<std::array<std::string, 6>> skyboxFaces;
+    std::optional<std::string> hdrPath;
+    int hdrMaxWidth = 0;
+    bool hdrCache = true;
+};
+
+struct SceneDescription {
+    std::optional<std::string> name;
+    std::optional<bool> shadowsEnabled;
+    std::optional<bool> useCubemapShadows;
+    std::optional<int> pcfRadius;
+    std::optional<bool> depthSortEnabled;
+    std::optional<bool> showAxes;
+    // Reorder meshes for vertex reuse at load (MeshOptimize).
+    std::optional<bool> optimizeMeshes;
+    std::optional<BackgroundDescription> background;
+    std::optional<CameraDescription> camera;
+    std::vector<SolidDescription> solids;
+};
+
+// Geometry of an imported (obj_loader / asc_loader) solid after import, in
+// MeshCache's encoding, plus the OBJ's mtllib names so its materials can be
+// rebuilt. Procedural solids have no cooked form: they rebuild faster than
+// they would decode.
+struct CookedSolid {
+    std::string mesh;  // MeshCache::encode() bytes; empty when not cooked
+    std::vector<std::string> materialLibraries;
+};
@@ -14,8 +14,9 @@ std::vector<std::string> SceneFactory::combinedNames_;
 bool SceneFactory::scanned_ = false;
 
 std::unique_ptr<Scene> SceneFactory::createSceneFromYaml(
-    const std::string& yamlPath, Screen scr) {
-  return SceneLoader::loadFromFile(yamlPath, scr);
+    const std::string& yamlPath, Screen scr, const LoadProgress* progress,
+    std::vector<SceneSnapshot::Dependency>* sources) {
+  return SceneLoader::loadFromFile(yamlPath, scr, progress, sources);
 }
 
 void SceneFactory::scanYamlScenes(const std::string& directory) {
@@ -67,12 +68,24 @@ int SceneFactory::sceneCount() {
   return static_cast<int>(allSceneNames().size());
 }
 
-std::unique_ptr<Scene> SceneFactory::createSceneByIndex(int index, Screen scr) {
+std::unique_ptr<Scene> SceneFactory::createSceneByIndex(int index, Screen scr,
+                                                        const LoadProgress* progress,
+                                                        std::vector<SceneSnapshot::Dependency>* sources) {
   if (!scanned_)
     scanYamlScenes(SCENES_PATH);
 
   if (index >= 0 && index < static_cast<int>(yamlPaths_.size()))
-    return createSceneFromYaml(yamlPaths_[index], scr);
+    return createSceneFromYaml(yamlPaths_[index], scr, progress, sources);
 
   return nullptr;
 }
+
+std::string SceneFactory::yamlPathForIndex(int index) {
+  if (!scanned_)
+    scanYamlScenes(SCENES_PATH);
+
+  if (index >= 0 && index < static_cast<int>(yamlPaths_.size()))
+    return yamlPaths_[index];
+
+  return {};
+}
@@ -4,20 +4,31 @@
 #include <string>
 #include <vector>
 #include <render3d/scene.hpp>
+#include "load_progress.hpp"
+#include "scene_snapshot.hpp"
 
 
 using namespace render3d;
 
 class SceneFactory {
 public:
+    // `sources` receives the files the scene is built from; see
+    // SceneLoader::loadFromFile.
     static std::unique_ptr<Scene> createSceneFromYaml(const std::string& yamlPath,
-                                                       Screen scr);
+                                                       Screen scr,
+                                                       const LoadProgress* progress = nullptr,
+                                                       std::vector<SceneSnapshot::Dependency>* sources = nullptr);
 
     // Scan a directory for .yaml scene files and register them
     static void scanYamlScenes(const std::string& directory);
 
     // Create a scene by combined index (built-in scenes first, then YAML scenes)
-    static std::unique_ptr<Scene> createSceneByIndex(int index, Screen scr);
+    static std::unique_ptr<Scene> createSceneByIndex(int index, Screen scr,
+                                                     const LoadProgress* progress = nullptr,
+                                                     std::vector<SceneSnapshot::Dependency>* sources = nullptr);
+
+    // Path of the YAML file behind a scene index; empty if there is none.
+    static std::string yamlPathForIndex(int index);
 
     // Get the combined list of scene names (built-in + YAML)
     static const std::vector<std::string>& allSceneNames();
@@ -5,14 +5,27 @@ using namespace render3d;
 #define TINY_YAML_IMPLEMENTATION
 #include "../vendor/tiny_yaml/tiny_yaml.hpp"
 #include <filesystem>
+#include <mutex>
 #include <stdexcept>
 #include <unordered_map>
 
 #include "../assets/background_factory.hpp"
 #include <render3d/ecs/material_system.hpp>
 #include <render3d/ecs/mesh_system.hpp>
+#include "../assets/material_keys.hpp"
+#include "../assets/mesh_cache.hpp"
 #include "../assets/prefab_factory.hpp"
+#include "../assets/profiler.hpp"
+#include "../assets/texture_cache.hpp"
 #include <render3d/ecs/name_component.hpp>
+#include "instancing.hpp"
+#include "scene_snapshot.hpp"
+
+namespace {
+    // Sharing stats of the last scene built; scenes build on loader threads.
+    std::mutex meshStatsMutex;
+    MeshLibrary::Stats meshStats;
+}
 
 // ---------------------------------------------------------------------------
 // Enum parsers
@@ -70,9 +83,9 @@ static slib::vec3 parseVec3(const YAML::Node& n) {
     return {n[0].as<float>(), n[1].as<float>(), n[2].as<float>()};
 }
 
-void SceneLoader::parseCamera(const YAML::Node& node, Camera& camera) {
+void SceneLoader::parseCamera(const YAML::Node& node, CameraDescription& camera) {
     if (node["position"])
-        camera.pos = parseVec3(node["position"]);
+        camera.position = parseVec3(node["position"]);
     if (node["pitch"])       camera.pitch       = node["pitch"].as<float>();
     if (node["yaw"])         camera.yaw         = node["yaw"].as<float>();
     if (node["roll"])        camera.roll        = node["roll"].as<float>();
@@ -86,7 +99,7 @@ void SceneLoader::parseCamera(const YAML::Node& node, Camera& camera) {
     if (node["sensitivity"]) camera.sensitivity = node["sensitivity"].as<float>();
 }
 
-void SceneLoader::parseLight(const YAML::Node& node, Light& light) {
+void SceneLoader::parseLight(const YAML::Node& node, LightDescription& light) {
     if (node["type"])
         light.type = parseLightType(node["type"].as<std::string>());
     if (node["color"])
@@ -103,73 +116,262 @@ void SceneLoader::parseLight(const YAML::Node& node, Light& light) {
         light.outerCutoff = node["outer_cutoff"].as<float>();
 }
 
-void SceneLoader::parseOrbit(const YAML::Node& node, TransformComponent& transform) {
-    slib::vec3 center{0, 0, 0};
-    float radius = 1.0f;
-    slib::vec3 planeNormal{0, 1, 0};
-    float omega = 1.0f;
-    float initialPhase = 0.0f;
-
+void SceneLoader::parseOrbit(const YAML::Node& node, OrbitDescription& orbit) {
     if (node["center"])
-        center = parseVec3(node["center"]);
+        orbit.center = parseVec3(node["center"]);
     if (node["radius"])
-        radius = node["radius"].as<float>();
+        orbit.radius = node["radius"].as<float>();
     if (node["plane_normal"])
-        planeNormal = parseVec3(node["plane_normal"]);
+        orbit.planeNormal = parseVec3(node["plane_normal"]);
     if (node["omega"])
-        omega = node["omega"].as<float>();
+        orbit.omega = node["omega"].as<float>();
     if (node["initial_phase"])
-        initialPhase = node["initial_phase"].as<float>();
+        orbit.initialPhase = node["initial_phase"].as<float>();
+}
 
-    TransformSystem::enableCircularOrbit(transform, center, radius, planeNormal, omega, initialPhase);
+void SceneLoader::parsePosition(const YAML::Node& node, SolidDescription& solid) {
+    if (node["position"])
+        solid.position = parseVec3(node["position"]);
+    if (node["angles"])
+        solid.angles = parseVec3(node["angles"]);
+    if (node["zoom"])
+        solid.zoom = node["zoom"].as<float>();
 }
 
-void SceneLoader::parsePosition(const YAML::Node& node, TransformComponent& transform) {
-    if (node["position"]) {
-        auto p = parseVec3(node["position"]);
-        transform.position.x = p.x;
-        transform.position.y = p.y;
-        transform.position.z = p.z;
+SolidDescription SceneLoader::parseSolid(const YAML::Node& node) {
+    // Numeric parameters of the procedural builders.
+    static const char* const paramKeys[] = {
+        "u_steps", "v_steps", "major_radius", "minor_radius", "lobes", "scale",
+        "tube_radius", "size", "latitude", "longitude",
+    };
+
+    SolidDescription solid;
+    solid.type = node["type"].as<std::string>();
+    if (node["file"])
+        solid.file = node["file"].as<std::string>();
+    if (node["name"])
+        solid.name = node["name"].as<std::string>();
+    for (const char* key : paramKeys) {
+        if (node[key])
+            solid.params[key] = node[key].as<float>();
+    }
+    if (node["mesh_cache"])
+        solid.useMeshCache = node["mesh_cache"].as<bool>();
+
+    parsePosition(node, solid);
+
+    if (node["shading"])
+        solid.shading = parseShading(node["shading"].as<std::string>());
+    if (node["rotation_enabled"])
+        solid.rotationEnabled = node["rotation_enabled"].as<bool>();
+    if (node["rotation_speed"]) {
+        auto rs = node["rotation_speed"];
+        solid.rotationSpeed = std::array<float, 2>{rs[0].as<float>(), rs[1].as<float>()};
     }
-    if (node["angles"]) {
-        auto a = parseVec3(node["angles"]);
-        transform.position.xAngle = a.x;
-        transform.position.yAngle = a.y;
-        transform.position.zAngle = a.z;
+    if (node["light"]) {
+        solid.light.emplace();
+        parseLight(node["light"], *solid.light);
     }
-    if (node["zoom"])
-        transform.position.zoom = node["zoom"].as<float>();
+    if (node["emissive_color"])
+        solid.emissiveColor = parseVec3(node["emissive_color"]);
+    if (node["orbit"]) {
+        solid.orbit.emplace();
+        parseOrbit(node["orbit"], *solid.orbit);
+    }
+    return solid;
+}
+
+void SceneLoader::parseInstances(const YAML::Node& node, std::vector<SolidDescription>& solids) {
+    if (!node["solid"])
+        throw std::runtime_error("instances block without a 'solid'");
+    SolidDescription prototype = parseSolid(node["solid"]);
+
+    Instancing::Options options;
+    const std::string layout = node["layout"] ? node["layout"].as<std::string>() : "grid";
+    if (layout == "grid") {
+        options.layout = Instancing::Layout::Grid;
+        if (node["count"]) {
+            auto c = node["count"];
+            options.gridCount = {c[0].as<int>(), c[1].as<int>(), c[2].as<int>()};
+        }
+        if (node["spacing"])
+            options.spacing = parseVec3(node["spacing"]);
+    } else if (layout == "ring") {
+        options.layout = Instancing::Layout::Ring;
+        if (node["count"])  options.count  = node["count"].as<int>();
+        if (node["radius"]) options.radius = node["radius"].as<float>();
+    } else if (layout == "random") {
+        options.layout = Instancing::Layout::Random;
+        if (node["count"]) options.count  = node["count"].as<int>();
+        if (node["min"])   options.boxMin = parseVec3(node["min"]);
+        if (node["max"])   options.boxMax = parseVec3(node["max"]);
+        if (node["seed"])  options.seed   = static_cast<uint32_t>(node["seed"].as<int>());
+        if (node["random_angles"])
+            options.randomAngles = node["random_angles"].as<bool>();
+        if (node["scale_range"]) {
+            auto r = node["scale_range"];
+            options.scaleRange = {r[0].as<float>(), r[1].as<float>()};
+        }
+    } else if (layout == "list") {
+        options.layout = Instancing::Layout::List;
+        if (node["transforms"]) {
+            for (const auto& t : node["transforms"]) {
+                InstancePlacement placement;
+                if (t["position"]) placement.offset = parseVec3(t["position"]);
+                if (t["angles"])   placement.angles = parseVec3(t["angles"]);
+                if (t["zoom"])     placement.scale  = t["zoom"].as<float>();
+                options.placements.push_back(placement);
+            }
+        }
+    } else {
+        throw std::runtime_error("Unknown instances layout: " + layout);
+    }
+
+    if (node["phase_step"])
+        options.phaseStep = node["phase_step"].as<float>();
+    if (node["merge"])
+        options.merge = node["merge"].as<bool>();
+
+    Instancing::expand(prototype, options, solids);
+}
+
+SceneDescription SceneLoader::parseFile(const std::string& yamlPath) {
+    YAML::Node root;
+    try {
+        root = YAML::LoadFile(yamlPath);
+    } catch (const YAML::Exception& e) {
+        throw std::runtime_error("Failed to load YAML file '" + yamlPath +
+                                 "': " + e.what());
+    }
+
+    if (!root["scene"])
+        throw std::runtime_error("YAML missing top-level 'scene' key in " +
+                                 yamlPath);
+
+    YAML::Node sceneNode = root["scene"];
+    SceneDescription description;
+
+    if (sceneNode["name"])
+        description.name = sceneNode["name"].as<std::string>();
+
+    if (sceneNode["shadows_enabled"])
+        description.shadowsEnabled = sceneNode["shadows_enabled"].as<bool>();
+    if (sceneNode["use_cubemap_shadows"])
+        description.useCubemapShadows = sceneNode["use_cubemap_shadows"].as<bool>();
+    if (sceneNode["pcf_radius"])
+        description.pcfRadius = sceneNode["pcf_radius"].as<int>();
+    if (sceneNode["depth_sort_enabled"])
+        description.depthSortEnabled = sceneNode["depth_sort_enabled"].as<bool>();
+    if (sceneNode["show_axes"])
+        description.showAxes = sceneNode["show_axes"].as<bool>();
+    if (sceneNode["optimize_meshes"])
+        description.optimizeMeshes = sceneNode["optimize_meshes"].as<bool>();
+
+    if (sceneNode["background"]) {
+        BackgroundDescription& background = description.background.emplace();
+        background.type = parseBackgroundType(sceneNode["background"].as<std::string>());
+        if (background.type == BackgroundType::SKYBOX && sceneNode["skybox"]) {
+            auto sb = sceneNode["skybox"];
+            background.skyboxFaces = std::array<std::string, 6>{
+                sb["px"].as<std::string>(), sb["nx"].as<std::string>(),
+                sb["py"].as<std::string>(), sb["ny"].as<std::string>(),
+                sb["pz"].as<std::string>(), sb["nz"].as<std::string>()};
+        } else if (background.type == BackgroundType::HDR_PANORAMA && sceneNode["hdr_panorama"]) {
+            auto hdr = sceneNode["hdr_panorama"];
+            background.hdrPath = hdr["path"].as<std::string>();
+            if (hdr["max_width"]) background.hdrMaxWidth = hdr["max_width"].as<int>();
+            if (hdr["cache"])     background.hdrCache = hdr["cache"].as<bool>();
+        }
+    }
+
+    if (sceneNode["camera"]) {
+        description.camera.emplace();
+        parseCamera(sceneNode["camera"], *description.camera);
+    }
+
+    if (sceneNode["solids"]) {
+        for (const auto& solidNode : sceneNode["solids"]) {
+            description.solids.push_back(parseSolid(solidNode));
+        }
+    }
+
+    if (sceneNode["instances"]) {
+        for (const auto& instancesNode : sceneNode["instances"]) {
+            parseInstances(instancesNode, description.solids);
+        }
+    }
+
+    return description;
 }
 
 // ---------------------------------------------------------------------------
-// Entity factory
+// Builders
 // ---------------------------------------------------------------------------
 
-Entity SceneLoader::parseEntity(const YAML::Node& node, Scene& scene) {
-    std::string type = node["type"].as<std::string>();
-    Entity entity = scene.createEntity();
+void SceneLoader::applyCamera(const CameraDescription& description, Camera& camera) {
+    if (description.position)    camera.pos         = *description.position;
+    if (description.pitch)       camera.pitch       = *description.pitch;
+    if (description.yaw)         camera.yaw         = *description.yaw;
+    if (description.roll)        camera.roll        = *description.roll;
+    if (description.forward)     camera.forward     = *description.forward;
+    if (description.zNear)       camera.zNear       = *description.zNear;
+    if (description.zFar)        camera.zFar        = *description.zFar;
+    if (description.viewAngle)   camera.viewAngle   = *description.viewAngle;
+    if (description.speed)       camera.speed       = *description.speed;
+    if (description.eagerness)   camera.eagerness   = *description.eagerness;
+    if (description.sensitivity) camera.sensitivity = *description.sensitivity;
+}
 
-    TransformComponent transform{};
-    MeshComponent mesh{};
-    MaterialComponent material{};
-    RenderComponent render{};
-    NameComponent name{};
-    bool isLight = false;
-
-    if (type == "obj_loader") {
-        std::string file = node["file"].as<std::string>();
-        PrefabFactory::buildObj(file, mesh, material, transform);
-        if (!node["name"]) {
-            std::filesystem::path filePath(file);
-            name.name = filePath.stem().string();
+void SceneLoader::applyLight(const LightDescription& description, Light& light) {
+    if (description.type)        light.type        = *description.type;
+    if (description.color)       light.color       = *description.color;
+    if (description.intensity)   light.intensity   = *description.intensity;
+    if (description.direction)   light.direction   = *description.direction;
+    if (description.radius)      light.radius      = *description.radius;
+    if (description.innerCutoff) light.innerCutoff = *description.innerCutoff;
+    if (description.outerCutoff) light.outerCutoff = *description.outerCutoff;
+}
+
+// Imports an obj_loader / asc_loader solid, or restores it from `cooked`.
+// With `capture` set, the imported geometry is also returned in cooked form,
+// unless the solid opted out of caching with `mesh_cache: false`.
+void SceneLoader::buildImported(const SolidDescription& solid, MeshComponent& mesh,
+                                MaterialComponent& material, TransformComponent& transform,
+                                const CookedSolid* cooked, CookedSolid* capture) {
+    const bool isObj = solid.type == "obj_loader";
+
+    bool loadedNormals = false;
+    if (cooked && !cooked->mesh.empty() &&
+        MeshCache::decode(cooked->mesh.data(), cooked->mesh.size(), 0, mesh, loadedNormals)) {
+        if (isObj) {
+            PrefabFactory::restoreObj(solid.file, cooked->materialLibraries, mesh, material, transform);
+        } else {
+            PrefabFactory::restoreAsc(mesh, material);
         }
-    } else if (type == "asc_loader") {
-        std::string file = node["file"].as<std::string>();
-        PrefabFactory::buildAsc(file, mesh, material);
-        if (!node["name"]) {
-            std::filesystem::path filePath(file);
-            name.name = filePath.stem().string();
+        return;
+    }
+
+    if (isObj) {
+        loadedNormals = PrefabFactory::buildObj(solid.file, mesh, material, transform, solid.useMeshCache);
+    } else {
+        PrefabFactory::buildAsc(solid.file, mesh, material, solid.useMeshCache);
+    }
+
+    if (capture && solid.useMeshCache && !mesh.vertexData.empty()) {
+        capture->mesh = MeshCache::encode(0, mesh, loadedNormals);
+        if (isObj) {
+            capture->materialLibraries = MeshCache::describeSource(solid.file).materialLibraries;
         }
+    }
+}
+
+void SceneLoader::buildGeometry(const SolidDescription& solid, MeshComponent& mesh,
+                                MaterialComponent& material, TransformComponent& transform,
+                                const CookedSolid* cooked, CookedSolid* capture) {
+    const std::string& type = solid.type;
+
+    if (type == "obj_loader" || type == "asc_loader") {
+        buildImported(solid, mesh, material, transform, cooked, capture);
     } else if (type == "cube") {
         PrefabFactory::buildCube(mesh, material);
     } else if (type == "icosahedron") {
@@ -177,28 +379,28 @@ Entity SceneLoader::parseEntity(const YAML::Node& node, Scene& scene) {
     } else if (type == "tetrakis") {
         PrefabFactory::buildTetrakis(mesh, material);
     } else if (type == "torus") {
-        int uSteps = node["u_steps"] ? node["u_steps"].as<int>() : 20;
-        int vSteps = node["v_steps"] ? node["v_steps"].as<int>() : 10;
-        float R    = node["major_radius"] ? node["major_radius"].as<float>() : 500.0f;
-        float r    = node["minor_radius"] ? node["minor_radius"].as<float>() : 250.0f;
+        int uSteps = static_cast<int>(solid.param("u_steps", 20));
+        int vSteps = static_cast<int>(solid.param("v_steps", 10));
+        float R    = solid.param("major_radius", 500.0f);
+        float r    = solid.param("minor_radius", 250.0f);
         PrefabFactory::buildTorus(mesh, material, uSteps, vSteps, R, r);
     } else if (type == "knot") {
-        int lobes   = node["lobes"]      ? node["lobes"].as<int>()        : 3;
-        int uSteps  = node["u_steps"]    ? node["u_steps"].as<int>()      : lobes * 40;
-        int vSteps  = node["v_steps"]    ? node["v_steps"].as<int>()      : 12;
-        float scale = node["scale"]      ? node["scale"].as<float>()      : 100.0f;
-        float r     = node["tube_radius"]? node["tube_radius"].as<float>(): 30.0f;
+        int lobes   = static_cast<int>(solid.param("lobes", 3));
+        int uSteps  = static_cast<int>(solid.param("u_steps", static_cast<float>(lobes * 40)));
+        int vSteps  = static_cast<int>(solid.param("v_steps", 12));
+        float scale = solid.param("scale", 100.0f);
+        float r     = solid.param("tube_radius", 30.0f);
         PrefabFactory::buildKnot(mesh, material, lobes, uSteps, vSteps, scale, r);
     } else if (type == "plane") {
-        float size = node["size"] ? node["size"].as<float>() : 10.0f;
+        float size = solid.param("size", 10.0f);
         PrefabFactory::buildPlane(mesh, material, size);
     } else if (type == "world") {
-        int lat = node["latitude"]  ? node["latitude"].as<int>()  : 16;
-        int lon = node["longitude"] ? node["longitude"].as<int>() : 32;
+        int lat = static_cast<int>(solid.param("latitude", 16));
+        int lon = static_cast<int>(solid.param("longitude", 32));
         PrefabFactory::buildWorld(mesh, material, lat, lon);
     } else if (type == "amiga") {
-        int lat = node["latitude"]  ? node["latitude"].as<int>()  : 16;
-        int lon = node["longitude"] ? node["longitude"].as<int>() : 32;
+        int lat = static_cast<int>(solid.param("latitude", 16));
+        int lon = static_cast<int>(solid.param("longitude", 32));
         PrefabFactory::buildAmiga(mesh, material, lat, lon);
     } else if (type == "test") {
         PrefabFactory::buildTest(mesh, material);
@@ -206,39 +408,100 @@ Entity SceneLoader::parseEntity(const YAML::Node& node, Scene& scene) {
         throw std::runtime_error("Unknown solid type: " + type);
     }
 
-    if (node["name"]) {
-        name.name = node["name"].as<std::string>();
+    // After the cooked form was captured: snapshots keep the MTL names.
+    // Only meshes with a key longer than the inline buffer are renamed.
+    MaterialKeys::intern(mesh, material);
+}
+
+void SceneLoader::buildEntity(Entity entity, const SolidDescription& solid, Scene& scene,
+                              MeshLibrary& library, const CookedSolid* cooked, CookedSolid* capture) {
+    TransformComponent transform{};
+    MeshComponent mesh{};
+    MaterialComponent material{};
+    RenderComponent render{};
+    NameComponent name{};
+
+    // A repeated asset is copied from its first solid. Its cooked form was
+    // captured there, so `capture` stays empty for the repeats. A merged
+    // instance block gets a mesh of its own further down.
+    const std::string key = MeshLibrary::keyFor(solid);
+    if (!solid.merged.empty()) {
+        buildGeometry(solid, mesh, material, transform, cooked, capture);
+        library.optimize(mesh);
+    } else if (!library.acquire(key, mesh, material, transform)) {
+        buildGeometry(solid, mesh, material, transform, cooked, capture);
+        library.optimize(mesh);
+        library.add(key, mesh, material, transform);
     }
 
-    parsePosition(node, transform);
+    if (solid.type == "obj_loader" || solid.type == "asc_loader") {
+        name.name = std::filesystem::path(solid.file).stem().string();
+    }
 
-    if (node["shading"]) {
-        render.shading = parseShading(node["shading"].as<std::string>());
+    if (solid.name) {
+        name.name = *solid.name;
     }
 
-    if (node["rotation_enabled"]) {
-        transform.autoRotate = node["rotation_enabled"].as<bool>();
+    if (solid.position) {
+        transform.position.x = solid.position->x;
+        transform.position.y = solid.position->y;
+        transform.position.z = solid.position->z;
+    }
+    if (solid.angles) {
+        transform.position.xAngle = solid.angles->x;
+        transform.position.yAngle = solid.angles->y;
+        transform.position.zAngle = solid.angles->z;
+    }
+    if (solid.zoom) {
+        transform.position.zoom = *solid.zoom;
     }
+    transform.position.zoom *= solid.zoomScale;
 
-    if (node["rotation_speed"]) {
-        auto rs = node["rotation_speed"];
-        transform.incXangle = rs[0].as<float>();
-        transform.incYangle = rs[1].as<float>();
+    if (!solid.merged.empty()) {
+        Instancing::merge(mesh, solid.merged, transform.position.zoom);
+        library.addUnshared(mesh);
     }
 
-    if (node["light"]) {
+    // Replacing a live entity (buildSolid): its old components go only now
+    // that the new geometry has built, so a failed rebuild leaves it intact.
+    Registry& registry = scene.registry;
+    if (registry.transforms().has(entity)) {
+        registry.transforms().remove(entity);
+        registry.meshes().remove(entity);
+        registry.materials().remove(entity);
+        registry.renders().remove(entity);
+        registry.names().remove(entity);
+        registry.lights().remove(entity);
+        registry.shadows().remove(entity);
+    }
+
+    if (solid.shading) {
+        render.shading = *solid.shading;
+    }
+
+    if (solid.rotationEnabled) {
+        transform.autoRotate = *solid.rotationEnabled;
+    }
+
+    if (solid.rotationSpeed) {
+        transform.incXangle = (*solid.rotationSpeed)[0];
+        transform.incYangle = (*solid.rotationSpeed)[1];
+    }
+
+    if (solid.light) {
         LightComponent lc;
-        parseLight(node["light"], lc.light);
+        applyLight(*solid.light, lc.light);
         scene.registry.lights().add(entity, std::move(lc));
         scene.registry.shadows().add(entity, ShadowComponent{});
-        isLight = true;
     }
 
-    if (node["emissive_color"])
-        MaterialSystem::setEmissiveColor(material, parseVec3(node["emissive_color"]));
+    if (solid.emissiveColor)
+        MaterialSystem::setEmissiveColor(material, *solid.emissiveColor);
 
-    if (node["orbit"]) {
-        parseOrbit(node["orbit"], transform);
+    if (solid.orbit) {
+        const OrbitDescription& orbit = *solid.orbit;
+        TransformSystem::enableCircularOrbit(transform, orbit.center, orbit.radius,
+                                             orbit.planeNormal, orbit.omega, orbit.initialPhase);
     }
 
     scene.registry.transforms().add(entity, std::move(transform));
@@ -247,82 +510,144 @@ Entity SceneLoader::parseEntity(const YAML::Node& node, Scene& scene) {
     scene.registry.materials().add(entity, std::move(material));
     scene.registry.renders().add(entity, std::move(render));
     scene.registry.names().add(entity, std::move(name));
+}
 
+Entity SceneLoader::buildSolid(const SolidDescription& solid, Scene& scene, MeshLibrary& library,
+                               Entity entity) {
+    if (entity == NULL_ENTITY)
+        entity = scene.createEntity();
+    buildEntity(entity, solid, scene, library, nullptr, nullptr);
     return entity;
 }
 
-// ---------------------------------------------------------------------------
-// Main entry point
-// ---------------------------------------------------------------------------
-
-std::unique_ptr<Scene> SceneLoader::loadFromFile(const std::string& yamlPath,
-                                                  Screen scr) {
-    YAML::Node root;
-    try {
-        root = YAML::LoadFile(yamlPath);
-    } catch (const YAML::Exception& e) {
-        throw std::runtime_error("Failed to load YAML file '" + yamlPath +
-                                 "': " + e.what());
+void SceneLoader::applyBackground(const BackgroundDescription& background, Scene& scene) {
+    scene.backgroundType = background.type;
+    if (background.skyboxFaces) {
+        const auto& faces = *background.skyboxFaces;
+        BackgroundFactory::setBackground(scene, BackgroundFactory::createSkybox(
+            faces[0], faces[1], faces[2], faces[3], faces[4], faces[5]));
+    } else if (background.hdrPath) {
+        BackgroundFactory::HdrOptions options;
+        options.maxWidth = background.hdrMaxWidth;
+        options.useCache = background.hdrCache;
+        BackgroundFactory::setBackground(
+            scene, BackgroundFactory::createHdrPanorama(*background.hdrPath, options));
+    } else {
+        BackgroundFactory::setBackground(scene, BackgroundFactory::create(scene.backgroundType));
     }
+}
 
-    if (!root["scene"])
-        throw std::runtime_error("YAML missing top-level 'scene' key in " +
-                                 yamlPath);
-
-    YAML::Node sceneNode = root["scene"];
+std::unique_ptr<Scene> SceneLoader::build(const SceneDescription& description, Screen scr,
+                                          const LoadProgress* progress,
+                                          const std::vector<CookedSolid>* cooked,
+                                          std::vector<CookedSolid>* capture) {
+    PROFILE_ZONE("SceneLoader::build");
+    LoadProgress none;
+    const LoadProgress& hooks = progress ? *progress : none;
 
     auto scene = std::make_unique<Scene>(scr);
     scene->sceneType = SceneType::YAML;
 
-    // Scene name
-    if (sceneNode["name"])
-        scene->name = sceneNode["name"].as<std::string>();
+    if (description.name)
+        scene->name = *description.name;
+
+    if (description.shadowsEnabled)
+        scene->shadowsEnabled = *description.shadowsEnabled;
+    if (description.useCubemapShadows)
+        scene->useCubemapShadows = *description.useCubemapShadows;
+    if (description.pcfRadius)
+        scene->pcfRadius = *description.pcfRadius;
+    if (description.depthSortEnabled)
+        scene->depthSortEnabled = *description.depthSortEnabled;
+    if (description.showAxes)
+        scene->showAxes = *description.showAxes;
+
+    if (description.background) {
+        hooks.update(0.05f, "Loading background");
+        applyBackground(*description.background, *scene);
+    }
 
-    // Scene-level properties
-    if (sceneNode["shadows_enabled"])
-        scene->shadowsEnabled = sceneNode["shadows_enabled"].as<bool>();
-    if (sceneNode["use_cubemap_shadows"])
-        scene->useCubemapShadows = sceneNode["use_cubemap_shadows"].as<bool>();
-    if (sceneNode["pcf_radius"])
-        scene->pcfRadius = sceneNode["pcf_radius"].as<int>();
-    if (sceneNode["depth_sort_enabled"])
-        scene->depthSortEnabled = sceneNode["depth_sort_enabled"].as<bool>();
-    if (sceneNode["show_axes"])
-        scene->showAxes = sceneNode["show_axes"].as<bool>();
-    if (sceneNode["background"]) {
-        scene->backgroundType = parseBackgroundType(
-            sceneNode["background"].as<std::string>());
-        if (scene->backgroundType == BackgroundType::SKYBOX && sceneNode["skybox"]) {
-            auto sb = sceneNode["skybox"];
-            scene->setBackground(BackgroundFactory::createSkybox(
-                sb["px"].as<std::string>(),
-                sb["nx"].as<std::string>(),
-                sb["py"].as<std::string>(),
-                sb["ny"].as<std::string>(),
-                sb["pz"].as<std::string>(),
-                sb["nz"].as<std::string>()
-            ));
-        } else if (scene->backgroundType == BackgroundType::HDR_PANORAMA && sceneNode["hdr_panorama"]) {
-            auto hdr = sceneNode["hdr_panorama"];
-            scene->setBackground(BackgroundFactory::createHdrPanorama(
-                hdr["path"].as<std::string>()));
-        } else {
-            scene->setBackground(BackgroundFactory::create(scene->backgroundType));
+    if (description.camera)
+        applyCamera(*description.camera, scene->camera);
+
+    MeshLibrary library;
+    library.optimizeMeshes = description.optimizeMeshes.value_or(false);
+    const size_t total = description.solids.size();
+    if (capture)
+        capture->assign(total, CookedSolid{});
+    for (size_t i = 0; i < total; ++i) {
+        if (hooks.isCancelled()) {
+            TextureCache::purgeUnused();
+            return nullptr;
         }
+        const SolidDescription& solid = description.solids[i];
+        std::string label = solid.file.empty() ? solid.type : solid.file;
+        hooks.update(0.1f + 0.85f * i / total,
+                     "Building " + std::filesystem::path(label).filename().string());
+        const CookedSolid* cookedSolid = cooked && i < cooked->size() ? &(*cooked)[i] : nullptr;
+        PROFILE_ZONE("Build solid");
+        buildEntity(scene->createEntity(), solid, *scene, library, cookedSolid,
+                    capture ? &(*capture)[i] : nullptr);
     }
 
-    // Camera
-    if (sceneNode["camera"])
-        parseCamera(sceneNode["camera"], scene->camera);
+    // Every material now owns its copy of the pixels; the cache only had to
+    // last long enough for repeated files to be decoded once.
+    TextureCache::purgeUnused();
+    if (hooks.isCancelled())
+        return nullptr;
+    {
+        std::lock_guard<std::mutex> lock(meshStatsMutex);
+        meshStats = library.stats();
+    }
+    hooks.update(0.95f, "Setting up scene");
+    scene->Scene::setup();
 
-    // Solids
-    if (sceneNode["solids"]) {
-        for (const auto& solidNode : sceneNode["solids"]) {
-            parseEntity(solidNode, *scene);
+    return scene;
+}
+
+// ---------------------------------------------------------------------------
+// Main entry point
+// ---------------------------------------------------------------------------
+
+std::unique_ptr<Scene> SceneLoader::loadFromFile(const std::string& yamlPath,
+                                                  Screen scr,
+                                                  const LoadProgress* progress,
+                                                  std::vector<SceneSnapshot::Dependency>* sources) {
+    LoadProgress none;
+    const LoadProgress& hooks = progress ? *progress : none;
+    const std::string fileName = std::filesystem::path(yamlPath).filename().string();
+
+    if (SceneSnapshot::isEnabled()) {
+        SceneDescription description;
+        std::vector<CookedSolid> cooked;
+        if (SceneSnapshot::load(yamlPath, description, cooked)) {
+            hooks.update(0.0f, "Restoring " + fileName + " snapshot");
+            if (sources)
+                *sources = SceneSnapshot::sceneDependencies(yamlPath, description);
+            return build(description, scr, progress, &cooked);
         }
     }
 
-    scene->Scene::setup();
+    hooks.update(0.0f, "Reading " + fileName);
+    SceneDescription description;
+    {
+        PROFILE_ZONE("SceneLoader::parseFile");
+        description = parseFile(yamlPath);
+    }
+    if (sources)
+        *sources = SceneSnapshot::sceneDependencies(yamlPath, description);
+
+    if (!SceneSnapshot::isEnabled())
+        return build(description, scr, progress);
 
+    std::vector<CookedSolid> cooked;
+    auto scene = build(description, scr, progress, nullptr, &cooked);
+    if (scene)
+        SceneSnapshot::save(yamlPath, description, cooked);
     return scene;
 }
+
+MeshLibrary::Stats SceneLoader::lastMeshStats() {
+    std::lock_guard<std::mutex> lock(meshStatsMutex);
+    return meshStats;
+}
@@ -2,8 +2,15 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include <render3d/scene.hpp>
+#include <render3d/ecs/material_component.hpp>
+#include <render3d/ecs/mesh_component.hpp>
 #include <render3d/ecs/transform_component.hpp>
+#include "load_progress.hpp"
+#include "mesh_library.hpp"
+#include "scene_description.hpp"
+#include "scene_snapshot.hpp"
 
 
 using namespace render3d;
@@ -12,17 +19,63 @@ namespace YAML { class Node; }
 
 class SceneLoader {
 public:
+    // Returns nullptr if `progress` reports cancellation; that is checked
+    // between solids, so a single large import always runs to completion.
+    // Uses the "<yaml>.r3dscene" snapshot when it is still current, and
+    // writes one after parsing otherwise (see SceneSnapshot). `sources`,
+    // when given, receives SceneSnapshot::sceneDependencies(), stamped before
+    // anything is built so edits made during the load still count.
     static std::unique_ptr<Scene> loadFromFile(const std::string& yamlPath,
-                                                Screen scr);
+                                                Screen scr,
+                                                const LoadProgress* progress = nullptr,
+                                                std::vector<SceneSnapshot::Dependency>* sources = nullptr);
+
+    // Reads the YAML into a description without building anything.
+    static SceneDescription parseFile(const std::string& yamlPath);
+
+    // Builds the scene a description describes. Imported solids are restored
+    // from `cooked` (indexed like description.solids) where it has them;
+    // `capture`, when given, receives the cooked form of each import.
+    static std::unique_ptr<Scene> build(const SceneDescription& description, Screen scr,
+                                        const LoadProgress* progress = nullptr,
+                                        const std::vector<CookedSolid>* cooked = nullptr,
+                                        std::vector<CookedSolid>* capture = nullptr);
+
+    // Mesh sharing of the last scene build() finished.
+    static MeshLibrary::Stats lastMeshStats();
+
+    // Builds one solid into a live scene, for hot reload. With `entity` set
+    // its components are replaced in place, so it keeps its slot in
+    // scene.entities; otherwise a new entity is appended. Solids built with
+    // the same `library` import each model once; its optimizeMeshes follows
+    // the scene's optimize_meshes setting.
+    static Entity buildSolid(const SolidDescription& solid, Scene& scene, MeshLibrary& library,
+                             Entity entity = NULL_ENTITY);
+
+    // Apply one part of a description to a scene. Fields the description
+    // leaves out keep their current values.
+    static void applyCamera(const CameraDescription& description, Camera& camera);
+    static void applyLight(const LightDescription& description, Light& light);
+    static void applyBackground(const BackgroundDescription& description, Scene& scene);
 
 private:
     static Shading parseShading(const std::string& str);
     static LightType parseLightType(const std::string& str);
     static BackgroundType parseBackgroundType(const std::string& str);
 
-    static Entity parseEntity(const YAML::Node& solidNode, Scene& scene);
-    static void parseCamera(const YAML::Node& cameraNode, Camera& camera);
-    static void parseLight(const YAML::Node& lightNode, Light& light);
-    static void parseOrbit(const YAML::Node& orbitNode, TransformComponent& transform);
-    static void parsePosition(const YAML::Node& solidNode, TransformComponent& transform);
+    static SolidDescription parseSolid(const YAML::Node& solidNode);
+    static void parseInstances(const YAML::Node& instancesNode, std::vector<SolidDescription>& solids);
+    static void parseCamera(const YAML::Node& cameraNode, CameraDescription& camera);
+    static void parseLight(const YAML::Node& lightNode, LightDescription& light);
+    static void parseOrbit(const YAML::Node& orbitNode, OrbitDescription& orbit);
+    static void parsePosition(const YAML::Node& solidNode, SolidDescription& solid);
+
+    static void buildImported(const SolidDescription& solid, MeshComponent& mesh,
+                              MaterialComponent& material, TransformComponent& transform,
+                              const CookedSolid* cooked, CookedSolid* capture);
+    static void buildGeometry(const SolidDescription& solid, MeshComponent& mesh,
+                              MaterialComponent& material, TransformComponent& transform,
+                              const CookedSolid* cooked, CookedSolid* capture);
+    static void buildEntity(Entity entity, const SolidDescription& solid, Scene& scene,
+                            MeshLibrary& library, const CookedSolid* cooked, CookedSolid* capture);
 };
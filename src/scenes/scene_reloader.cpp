@@ -0,0 +1,463 @@
+#include "scene_reloader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <render3d/ecs/material_system.hpp>
+#include <render3d/ecs/name_component.hpp>
+#include "../assets/mesh_cache.hpp"
+#include "../assets/texture_cache.hpp"
+#include "mesh_library.hpp"
+#include "scene_loader.hpp"
+
+using namespace render3d;
+
+// ---------------------------------------------------------------------------
+// Description comparison
+// ---------------------------------------------------------------------------
+
+// Overloads are declared up front so the optional and vector templates find
+// the struct ones.
+static bool same(const slib::vec3& a, const slib::vec3& b);
+static bool same(const LightDescription& a, const LightDescription& b);
+static bool same(const OrbitDescription& a, const OrbitDescription& b);
+static bool same(const CameraDescription& a, const CameraDescription& b);
+static bool same(const BackgroundDescription& a, const BackgroundDescription& b);
+static bool same(const InstancePlacement& a, const InstancePlacement& b);
+
+template <typename T>
+static bool same(const T& a, const T& b) {
+    return a == b;
+}
+
+template <typename T>
+static bool same(const std::optional<T>& a, const std::optional<T>& b) {
+    return a.has_value() == b.has_value() && (!a || same(*a, *b));
+}
+
+template <typename T>
+static bool same(const std::vector<T>& a, const std::vector<T>& b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (!same(a[i], b[i]))
+            return false;
+    }
+    return true;
+}
+
+// True when `before` set a key that `after` leaves out.
+template <typename T>
+static bool lost(const std::optional<T>& before, const std::optional<T>& after) {
+    return before.has_value() && !after.has_value();
+}
+
+static bool same(const slib::vec3& a, const slib::vec3& b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+static bool same(const LightDescription& a, const LightDescription& b) {
+    return same(a.type, b.type) && same(a.color, b.color) && same(a.intensity, b.intensity) &&
+           same(a.direction, b.direction) && same(a.radius, b.radius) &&
+           same(a.innerCutoff, b.innerCutoff) && same(a.outerCutoff, b.outerCutoff);
+}
+
+static bool same(const OrbitDescription& a, const OrbitDescription& b) {
+    return same(a.center, b.center) && a.radius == b.radius &&
+           same(a.planeNormal, b.planeNormal) && a.omega == b.omega &&
+           a.initialPhase == b.initialPhase;
+}
+
+static bool same(const CameraDescription& a, const CameraDescription& b) {
+    return same(a.position, b.position) && same(a.forward, b.forward) &&
+           same(a.pitch, b.pitch) && same(a.yaw, b.yaw) && same(a.roll, b.roll) &&
+           same(a.zNear, b.zNear) && same(a.zFar, b.zFar) && same(a.viewAngle, b.viewAngle) &&
+           same(a.speed, b.speed) && same(a.eagerness, b.eagerness) &&
+           same(a.sensitivity, b.sensitivity);
+}
+
+static bool same(const BackgroundDescription& a, const BackgroundDescription& b) {
+    return a.type == b.type && same(a.skyboxFaces, b.skyboxFaces) && same(a.hdrPath, b.hdrPath) &&
+           a.hdrMaxWidth == b.hdrMaxWidth && a.hdrCache == b.hdrCache;
+}
+
+static bool same(const InstancePlacement& a, const InstancePlacement& b) {
+    return same(a.offset, b.offset) && same(a.angles, b.angles) && a.scale == b.scale;
+}
+
+static bool isImported(const SolidDescription& solid) {
+    return solid.type == "obj_loader" || solid.type == "asc_loader";
+}
+
+// Whether `after` needs its entity built again rather than patched.
+static bool needsRebuild(const SolidDescription& before, const SolidDescription& after,
+                         const std::set<std::string>& changedFiles) {
+    if (MeshLibrary::keyFor(before) != MeshLibrary::keyFor(after) ||
+        before.useMeshCache != after.useMeshCache)
+        return true;
+    if (isImported(after) && changedFiles.count(after.file))
+        return true;
+
+    // Merged instances are baked into the mesh at the block's zoom.
+    if (!same(before.merged, after.merged))
+        return true;
+    if (!after.merged.empty() && (!same(before.zoom, after.zoom) || before.zoomScale != after.zoomScale))
+        return true;
+    if (!after.zoom && before.zoomScale != after.zoomScale)
+        return true;
+
+    // A removed key goes back to whatever the builder produced.
+    return lost(before.name, after.name) || lost(before.position, after.position) ||
+           lost(before.angles, after.angles) || lost(before.zoom, after.zoom) ||
+           lost(before.shading, after.shading) ||
+           lost(before.rotationEnabled, after.rotationEnabled) ||
+           lost(before.rotationSpeed, after.rotationSpeed) ||
+           lost(before.emissiveColor, after.emissiveColor);
+}
+
+static bool lostLightKey(const LightDescription& before, const LightDescription& after) {
+    return lost(before.type, after.type) || lost(before.color, after.color) ||
+           lost(before.intensity, after.intensity) || lost(before.direction, after.direction) ||
+           lost(before.radius, after.radius) || lost(before.innerCutoff, after.innerCutoff) ||
+           lost(before.outerCutoff, after.outerCutoff);
+}
+
+// ---------------------------------------------------------------------------
+// Tracking
+// ---------------------------------------------------------------------------
+
+void SceneReloader::track(const std::string& path, const Scene& scene) {
+    yamlPath = path;
+    current = SceneDescription{};
+    solidEntities.clear();
+    matched = false;
+    last = Result{};
+
+    if (yamlPath.empty()) {
+        watched.clear();
+        watcher.setFiles({});
+        return;
+    }
+
+    try {
+        current = SceneLoader::parseFile(yamlPath);
+        // build() creates one entity per solid, in file order.
+        if (scene.entities.size() >= current.solids.size()) {
+            solidEntities.assign(scene.entities.begin(),
+                                 scene.entities.begin() + current.solids.size());
+            matched = true;
+        }
+    } catch (const std::exception& e) {
+        last.error = e.what();
+    }
+    watched.clear();
+    watchDependencies();
+}
+
+void SceneReloader::watchDependencies() {
+    std::map<std::string, std::set<std::string>> dependencies;
+    for (const auto& solid : current.solids) {
+        if (!isImported(solid) || solid.file.empty())
+            continue;
+        dependencies[solid.file].insert(solid.file);
+        if (solid.type == "obj_loader") {
+            std::filesystem::path basePath = std::filesystem::path(solid.file).parent_path();
+            for (const auto& library : MeshCache::materialLibraries(solid.file))
+                dependencies[(basePath / library).string()].insert(solid.file);
+        }
+    }
+    if (current.background) {
+        const BackgroundDescription& background = *current.background;
+        if (background.skyboxFaces) {
+            for (const auto& face : *background.skyboxFaces)
+                dependencies[face].insert(face);
+        }
+        if (background.hdrPath)
+            dependencies[*background.hdrPath].insert(*background.hdrPath);
+    }
+
+    if (dependencies == watched && !watched.empty())
+        return;
+    watched = std::move(dependencies);
+
+    std::vector<std::string> files{yamlPath};
+    for (const auto& [path, owners] : watched)
+        files.push_back(path);
+    watcher.setFiles(files);
+}
+
+// ---------------------------------------------------------------------------
+// Reloading
+// ---------------------------------------------------------------------------
+
+SceneReloader::Result SceneReloader::update(Scene& scene, TextureLod* textureLod,
+                                            MeshLod* meshLod) {
+    if (!enabled || yamlPath.empty())
+        return Result{};
+
+    std::vector<std::string> changed = watcher.poll();
+    if (changed.empty())
+        return Result{};
+
+    const auto start = std::chrono::steady_clock::now();
+    bool yamlChanged = false;
+    std::set<std::string> changedFiles;
+    for (const auto& path : changed) {
+        if (path == yamlPath) {
+            yamlChanged = true;
+            continue;
+        }
+        auto it = watched.find(path);
+        if (it != watched.end())
+            changedFiles.insert(it->second.begin(), it->second.end());
+    }
+
+    Result result;
+    SceneDescription next = current;
+    try {
+        if (yamlChanged)
+            next = SceneLoader::parseFile(yamlPath);
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+
+    if (result.error.empty()) {
+        result = apply(next, scene, changedFiles, textureLod, meshLod);
+        watchDependencies();
+        // Rebuilt solids copied their textures out of the cache; see SceneLoader::build.
+        TextureCache::purgeUnused();
+    }
+
+    result.ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    last = result;
+    return result;
+}
+
+SceneReloader::Result SceneReloader::apply(const SceneDescription& next, Scene& scene,
+                                           const std::set<std::string>& changedFiles,
+                                           TextureLod* textureLod, MeshLod* meshLod) {
+    Result result;
+    // Every mesh would change: leave that to a full load.
+    if (!matched || !same(current.optimizeMeshes, next.optimizeMeshes)) {
+        result.needsFullReload = true;
+        return result;
+    }
+    result.reloaded = true;
+    // Solids sharing a changed model import it once per apply.
+    MeshLibrary library;
+    library.optimizeMeshes = current.optimizeMeshes.value_or(false);
+
+    // Rebuilt, added and removed entities change the materials and meshes
+    // the LOD chains point at: bind full detail first and rebuild the chains
+    // of those entities last.
+    bool lodRestored = false;
+    auto restoreLod = [&]() {
+        if (lodRestored) {
+            return;
+        }
+        if (textureLod) {
+            textureLod->restore(scene);
+        }
+        if (meshLod) {
+            meshLod->restore(scene);
+        }
+        lodRestored = true;
+    };
+    bool structural = false;
+    std::vector<Entity>& rebuiltEntities = result.rebuiltEntities;
+
+    // Scene settings
+    if (next.name && !same(current.name, next.name))
+        scene.name = *next.name;
+    if (next.shadowsEnabled && !same(current.shadowsEnabled, next.shadowsEnabled))
+        scene.shadowsEnabled = *next.shadowsEnabled;
+    if (next.useCubemapShadows && !same(current.useCubemapShadows, next.useCubemapShadows))
+        scene.useCubemapShadows = *next.useCubemapShadows;
+    if (next.pcfRadius && !same(current.pcfRadius, next.pcfRadius))
+        scene.pcfRadius = *next.pcfRadius;
+    if (next.depthSortEnabled && !same(current.depthSortEnabled, next.depthSortEnabled))
+        scene.depthSortEnabled = *next.depthSortEnabled;
+    if (next.showAxes && !same(current.showAxes, next.showAxes))
+        scene.showAxes = *next.showAxes;
+
+    if (next.background) {
+        const BackgroundDescription& background = *next.background;
+        bool imageChanged = background.hdrPath && changedFiles.count(*background.hdrPath);
+        if (background.skyboxFaces) {
+            for (const auto& face : *background.skyboxFaces)
+                imageChanged = imageChanged || changedFiles.count(face);
+        }
+        if (!same(current.background, next.background) || imageChanged) {
+            try {
+                result.backgroundChanged = true;
+                SceneLoader::applyBackground(*next.background, scene);
+            } catch (const std::exception& e) {
+                result.error = e.what();
+            }
+        }
+    }
+    if (next.camera && !same(current.camera, next.camera))
+        SceneLoader::applyCamera(*next.camera, scene.camera);
+
+    current.name = next.name;
+    current.shadowsEnabled = next.shadowsEnabled;
+    current.useCubemapShadows = next.useCubemapShadows;
+    current.pcfRadius = next.pcfRadius;
+    current.depthSortEnabled = next.depthSortEnabled;
+    current.showAxes = next.showAxes;
+    current.background = next.background;
+    current.camera = next.camera;
+
+    // Solids present before and after
+    Registry& registry = scene.registry;
+    const size_t common = std::min(current.solids.size(), next.solids.size());
+    for (size_t i = 0; i < common; ++i) {
+        const SolidDescription& before = current.solids[i];
+        const SolidDescription& after = next.solids[i];
+        const Entity entity = solidEntities[i];
+
+        TransformComponent* transform = registry.transforms().get(entity);
+        RenderComponent* render = registry.renders().get(entity);
+        MaterialComponent* material = registry.materials().get(entity);
+        NameComponent* name = registry.names().get(entity);
+
+        try {
+            if (!transform || !render || !material || !name ||
+                needsRebuild(before, after, changedFiles)) {
+                restoreLod();
+                rebuiltEntities.push_back(entity);
+                SceneLoader::buildSolid(after, scene, library, entity);
+                current.solids[i] = after;
+                ++result.rebuilt;
+                structural = true;
+                continue;
+            }
+
+            bool patched = false;
+            if (after.name && !same(before.name, after.name)) {
+                name->name = *after.name;
+                patched = true;
+            }
+            if (after.position && !same(before.position, after.position)) {
+                transform->position.x = after.position->x;
+                transform->position.y = after.position->y;
+                transform->position.z = after.position->z;
+                patched = true;
+            }
+            if (after.angles && !same(before.angles, after.angles)) {
+                transform->position.xAngle = after.angles->x;
+                transform->position.yAngle = after.angles->y;
+                transform->position.zAngle = after.angles->z;
+                patched = true;
+            }
+            if (after.zoom && (!same(before.zoom, after.zoom) || before.zoomScale != after.zoomScale)) {
+                transform->position.zoom = *after.zoom * after.zoomScale;
+                patched = true;
+            }
+            if (after.shading && !same(before.shading, after.shading)) {
+                render->shading = *after.shading;
+                patched = true;
+            }
+            if (after.rotationEnabled && !same(before.rotationEnabled, after.rotationEnabled)) {
+                transform->autoRotate = *after.rotationEnabled;
+                patched = true;
+            }
+            if (after.rotationSpeed && !same(before.rotationSpeed, after.rotationSpeed)) {
+                transform->incXangle = (*after.rotationSpeed)[0];
+                transform->incYangle = (*after.rotationSpeed)[1];
+                patched = true;
+            }
+            if (after.emissiveColor && !same(before.emissiveColor, after.emissiveColor)) {
+                MaterialSystem::setEmissiveColor(*material, *after.emissiveColor);
+                patched = true;
+            }
+
+            if (!same(before.light, after.light)) {
+                LightComponent* light = registry.lights().get(entity);
+                if (after.light && light && !(before.light && lostLightKey(*before.light, *after.light))) {
+                    SceneLoader::applyLight(*after.light, light->light);
+                } else {
+                    // Added, removed, or a key went back to its default.
+                    registry.lights().remove(entity);
+                    registry.shadows().remove(entity);
+                    if (after.light) {
+                        LightComponent fresh;
+                        SceneLoader::applyLight(*after.light, fresh.light);
+                        registry.lights().add(entity, std::move(fresh));
+                        registry.shadows().add(entity, ShadowComponent{});
+                    }
+                    structural = true;
+                }
+                patched = true;
+            }
+
+            if (!same(before.orbit, after.orbit)) {
+                if (after.orbit) {
+                    const OrbitDescription& orbit = *after.orbit;
+                    TransformSystem::enableCircularOrbit(*transform, orbit.center, orbit.radius,
+                                                         orbit.planeNormal, orbit.omega,
+                                                         orbit.initialPhase);
+                } else {
+                    TransformSystem::disableCircularOrbit(*transform);
+                }
+                patched = true;
+            }
+
+            current.solids[i] = after;
+            if (patched) {
+                result.patchedEntities.push_back(entity);
+                ++result.patched;
+            }
+        } catch (const std::exception& e) {
+            // Leave this solid as it was; the next edit diffs against it again.
+            // Whatever was written before the failure still counts as patched.
+            result.error = e.what();
+            result.patchedEntities.push_back(entity);
+        }
+    }
+
+    // Solids added at the end of the list
+    for (size_t i = common; i < next.solids.size(); ++i) {
+        try {
+            restoreLod();
+            solidEntities.push_back(SceneLoader::buildSolid(next.solids[i], scene, library));
+            rebuiltEntities.push_back(solidEntities.back());
+            current.solids.push_back(next.solids[i]);
+            ++result.added;
+            structural = true;
+        } catch (const std::exception& e) {
+            result.error = e.what();
+            break;
+        }
+    }
+
+    // Solids removed from the end of the list
+    while (current.solids.size() > next.solids.size()) {
+        restoreLod();
+        const Entity entity = solidEntities.back();
+        registry.destroyEntity(entity);
+        auto slot = std::find(scene.entities.begin(), scene.entities.end(), entity);
+        if (slot != scene.entities.end()) {
+            result.removedSlots.push_back(static_cast<size_t>(slot - scene.entities.begin()));
+            scene.entities.erase(slot);
+        }
+        solidEntities.pop_back();
+        current.solids.pop_back();
+        ++result.removed;
+        structural = true;
+    }
+    if (scene.selectedEntityIndex >= static_cast<int>(scene.entities.size()))
+        scene.selectedEntityIndex = std::max(0, static_cast<int>(scene.entities.size()) - 1);
+
+    result.structural = structural;
+    if (structural)
+        scene.Scene::setup();
+    if (lodRestored && textureLod)
+        textureLod->rebuild(scene, rebuiltEntities);
+    if (lodRestored && meshLod)
+        meshLod->rebuild(scene, rebuiltEntities);
+
+    return result;
+}
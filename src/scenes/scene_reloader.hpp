@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <render3d/scene.hpp>
+#include "../assets/file_watcher.hpp"
+#include "scene_description.hpp"
+#include "mesh_lod.hpp"
+#include "texture_lod.hpp"
+
+using namespace render3d;
+
+// Hot reload of the YAML scene on screen. Watches the YAML, the models its
+// solids import, their MTL libraries and the background images, and when one
+// of them changes patches the live Scene instead of loading it again:
+//
+//  - A YAML edit is parsed and diffed against the previous description.
+//    Changed transforms, shading, rotation, lights, orbits, emissive colors,
+//    camera and scene settings are written into the existing components;
+//    settings that were not touched keep their current (possibly animated)
+//    values.
+//  - Only solids whose geometry changed (type, file, builder parameters,
+//    merged instances) are rebuilt, in place, keeping their entity. The
+//    others keep their meshes and textures untouched.
+//  - A changed model or MTL file rebuilds the solids that use it.
+//
+// Solids are matched by their position in the file, so inserting a solid in
+// the middle of the list rebuilds the ones after it. Texture images named by
+// MTL files are not watched.
+// update() belongs to the thread that renders the scene.
+
+class SceneReloader {
+public:
+    struct Result {
+        bool reloaded = false;         // the scene was patched this call
+        bool needsFullReload = false;  // the scene does not match its file; load it again
+        size_t patched = 0;            // entities updated in place
+        size_t rebuilt = 0;            // entities whose geometry was rebuilt
+        size_t added = 0;
+        size_t removed = 0;
+        double ms = 0.0;               // parse + diff + patch time
+        std::string error;             // parse or build failure; the rest was still applied
+
+        // What changed, for a copy of the scene to follow (FrameState::copyReload).
+        std::vector<Entity> rebuiltEntities;  // new meshes and materials, in place or added
+        std::vector<Entity> patchedEntities;  // other components written in place
+        std::vector<size_t> removedSlots;     // scene.entities positions, in removal order
+        bool backgroundChanged = false;
+        bool structural = false;              // Scene::setup() ran again
+    };
+
+    // Starts following `yamlPath`, whose freshly loaded scene is `scene`.
+    // An empty path stops watching.
+    void track(const std::string& yamlPath, const Scene& scene);
+
+    // Applies pending file changes to `scene`, which must be the scene given
+    // to track(). When entities are rebuilt, added or removed, `textureLod`
+    // and `meshLod` rebuild the chains of just those. Returns an empty
+    // result when nothing changed.
+    Result update(Scene& scene, TextureLod* textureLod = nullptr, MeshLod* meshLod = nullptr);
+
+    // Diffs `next` against the tracked description and patches `scene`.
+    // Solids whose `file` is in `changedFiles` are rebuilt, and a background
+    // whose image is in it is reloaded, even if the description is unchanged.
+    Result apply(const SceneDescription& next, Scene& scene,
+                 const std::set<std::string>& changedFiles = {},
+                 TextureLod* textureLod = nullptr, MeshLod* meshLod = nullptr);
+
+    const Result& lastResult() const { return last; }
+    const std::string& trackedPath() const { return yamlPath; }
+    // The description the scene matches, as far as it could be applied.
+    const SceneDescription& description() const { return current; }
+    size_t watchedFiles() const { return watched.size(); }
+
+    bool enabled = true;
+
+private:
+    void watchDependencies();
+
+    std::string yamlPath;
+    SceneDescription current;
+    // Entity built for each of current.solids; empty when the scene could
+    // not be matched to its description.
+    std::vector<Entity> solidEntities;
+    bool matched = false;
+
+    FileWatcher watcher;
+    // Watched dependency -> files to treat as changed when it changes: the
+    // model for a model or its MTL library, itself for a background image.
+    std::map<std::string, std::set<std::string>> watched;
+    Result last;
+};
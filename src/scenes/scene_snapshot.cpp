@@ -0,0 +1,602 @@
+#include "scene_snapshot.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <type_traits>
+
+#include "../assets/mapped_file.hpp"
+#include "../assets/mesh_cache.hpp"
+#include "../vendor/tinyobjloader/tiny_obj_loader.h"
+
+
+namespace {
+
+    constexpr char MAGIC[8] = {'R', '3', 'D', 'S', 'C', 'E', 'N', 'E'};
+    constexpr uint32_t BYTE_ORDER_MARK = 0x01020304u;
+
+    std::atomic<bool> snapshotEnabled{true};
+
+    using SceneSnapshot::Dependency;
+
+    bool statFile(const std::string& path, Dependency& dependency) {
+        std::error_code ec;
+        dependency.path = path;
+        dependency.size = std::filesystem::file_size(path, ec);
+        if (ec) {
+            return false;
+        }
+        auto modified = std::filesystem::last_write_time(path, ec);
+        if (ec) {
+            return false;
+        }
+        dependency.modified = static_cast<int64_t>(modified.time_since_epoch().count());
+        return true;
+    }
+
+    // Marks a dependency that did not exist when the snapshot was written.
+    constexpr uint64_t MISSING = UINT64_MAX;
+
+    // Appends fields in native byte order; the header's byte-order mark
+    // rejects snapshots written on a machine with the other one.
+    class Writer {
+    public:
+        template <typename T>
+        void pod(T value) {
+            static_assert(std::is_trivially_copyable<T>::value, "pod() takes plain values");
+            bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        void str(const std::string& value) {
+            pod(static_cast<uint32_t>(value.size()));
+            bytes.append(value);
+        }
+
+        void vec3(const slib::vec3& value) {
+            pod(value.x);
+            pod(value.y);
+            pod(value.z);
+        }
+
+        template <typename T, typename Fn>
+        void optional(const std::optional<T>& value, Fn&& write) {
+            pod(static_cast<uint8_t>(value.has_value()));
+            if (value) {
+                write(*value);
+            }
+        }
+
+        template <typename T>
+        void optional(const std::optional<T>& value) {
+            optional(value, [this](const T& v) { pod(v); });
+        }
+
+        std::string bytes;
+    };
+
+    // Reads what Writer wrote. Any overrun clears `ok` and leaves values at
+    // their defaults, so callers check once at the end.
+    class Reader {
+    public:
+        Reader(const char* data, size_t size) : cursor(data), end(data + size) {}
+
+        template <typename T>
+        T pod() {
+            T value{};
+            if (!take(sizeof(T))) {
+                return value;
+            }
+            std::memcpy(&value, cursor - sizeof(T), sizeof(T));
+            return value;
+        }
+
+        std::string str() {
+            uint32_t size = pod<uint32_t>();
+            if (!take(size)) {
+                return {};
+            }
+            return std::string(cursor - size, size);
+        }
+
+        slib::vec3 vec3() {
+            float x = pod<float>();
+            float y = pod<float>();
+            float z = pod<float>();
+            return {x, y, z};
+        }
+
+        template <typename T, typename Fn>
+        void optional(std::optional<T>& value, Fn&& read) {
+            if (pod<uint8_t>() != 0) {
+                value = read();
+            } else {
+                value.reset();
+            }
+        }
+
+        template <typename T>
+        void optional(std::optional<T>& value) {
+            optional(value, [this]() { return pod<T>(); });
+        }
+
+        // Guards element counts against the bytes actually left, so a corrupt
+        // count cannot trigger a huge allocation.
+        uint32_t count(size_t minElementSize) {
+            uint32_t n = pod<uint32_t>();
+            if (static_cast<size_t>(end - cursor) / minElementSize < n) {
+                ok = false;
+                return 0;
+            }
+            return n;
+        }
+
+        bool atEnd() const { return cursor == end; }
+
+        bool ok = true;
+
+    private:
+        bool take(size_t size) {
+            if (!ok || static_cast<size_t>(end - cursor) < size) {
+                ok = false;
+                return false;
+            }
+            cursor += size;
+            return true;
+        }
+
+        const char* cursor;
+        const char* end;
+    };
+
+    void writeLight(Writer& w, const LightDescription& light) {
+        w.optional(light.type);
+        w.optional(light.color, [&](const slib::vec3& v) { w.vec3(v); });
+        w.optional(light.intensity);
+        w.optional(light.direction, [&](const slib::vec3& v) { w.vec3(v); });
+        w.optional(light.radius);
+        w.optional(light.innerCutoff);
+        w.optional(light.outerCutoff);
+    }
+
+    LightDescription readLight(Reader& r) {
+        LightDescription light;
+        r.optional(light.type);
+        r.optional(light.color, [&]() { return r.vec3(); });
+        r.optional(light.intensity);
+        r.optional(light.direction, [&]() { return r.vec3(); });
+        r.optional(light.radius);
+        r.optional(light.innerCutoff);
+        r.optional(light.outerCutoff);
+        return light;
+    }
+
+    void writeSolid(Writer& w, const SolidDescription& solid) {
+        w.str(solid.type);
+        w.str(solid.file);
+        w.optional(solid.name, [&](const std::string& s) { w.str(s); });
+        w.pod(static_cast<uint32_t>(solid.params.size()));
+        for (const auto& [key, value] : solid.params) {
+            w.str(key);
+            w.pod(value);
+        }
+        w.pod(static_cast<uint8_t>(solid.useMeshCache));
+
+        w.optional(solid.position, [&](const slib::vec3& v) { w.vec3(v); });
+        w.optional(solid.angles, [&](const slib::vec3& v) { w.vec3(v); });
+        w.optional(solid.zoom);
+        w.optional(solid.shading);
+        w.optional(solid.rotationEnabled);
+        w.optional(solid.rotationSpeed);
+        w.optional(solid.light, [&](const LightDescription& l) { writeLight(w, l); });
+        w.optional(solid.emissiveColor, [&](const slib::vec3& v) { w.vec3(v); });
+        w.optional(solid.orbit, [&](const OrbitDescription& o) {
+            w.vec3(o.center);
+            w.pod(o.radius);
+            w.vec3(o.planeNormal);
+            w.pod(o.omega);
+            w.pod(o.initialPhase);
+        });
+        w.pod(solid.zoomScale);
+        w.pod(static_cast<uint32_t>(solid.merged.size()));
+        for (const auto& placement : solid.merged) {
+            w.vec3(placement.offset);
+            w.vec3(placement.angles);
+            w.pod(placement.scale);
+        }
+    }
+
+    SolidDescription readSolid(Reader& r) {
+        SolidDescription solid;
+        solid.type = r.str();
+        solid.file = r.str();
+        r.optional(solid.name, [&]() { return r.str(); });
+        uint32_t paramCount = r.count(sizeof(uint32_t) + sizeof(float));
+        for (uint32_t i = 0; i < paramCount; ++i) {
+            std::string key = r.str();
+            solid.params[key] = r.pod<float>();
+        }
+        solid.useMeshCache = r.pod<uint8_t>() != 0;
+
+        r.optional(solid.position, [&]() { return r.vec3(); });
+        r.optional(solid.angles, [&]() { return r.vec3(); });
+        r.optional(solid.zoom);
+        r.optional(solid.shading);
+        r.optional(solid.rotationEnabled);
+        r.optional(solid.rotationSpeed);
+        r.optional(solid.light, [&]() { return readLight(r); });
+        r.optional(solid.emissiveColor, [&]() { return r.vec3(); });
+        r.optional(solid.orbit, [&]() {
+            OrbitDescription o;
+            o.center = r.vec3();
+            o.radius = r.pod<float>();
+            o.planeNormal = r.vec3();
+            o.omega = r.pod<float>();
+            o.initialPhase = r.pod<float>();
+            return o;
+        });
+        solid.zoomScale = r.pod<float>();
+        uint32_t mergedCount = r.count(7 * sizeof(float));
+        solid.merged.resize(mergedCount);
+        for (auto& placement : solid.merged) {
+            placement.offset = r.vec3();
+            placement.angles = r.vec3();
+            placement.scale = r.pod<float>();
+        }
+        return solid;
+    }
+
+    void writeDescription(Writer& w, const SceneDescription& description) {
+        w.optional(description.name, [&](const std::string& s) { w.str(s); });
+        w.optional(description.shadowsEnabled);
+        w.optional(description.useCubemapShadows);
+        w.optional(description.pcfRadius);
+        w.optional(description.depthSortEnabled);
+        w.optional(description.showAxes);
+        w.optional(description.optimizeMeshes);
+
+        w.optional(description.background, [&](const BackgroundDescription& b) {
+            w.pod(b.type);
+            w.optional(b.skyboxFaces, [&](const std::array<std::string, 6>& faces) {
+                for (const auto& face : faces) {
+                    w.str(face);
+                }
+            });
+            w.optional(b.hdrPath, [&](const std::string& s) { w.str(s); });
+            w.pod(static_cast<int32_t>(b.hdrMaxWidth));
+            w.pod(static_cast<uint8_t>(b.hdrCache));
+        });
+
+        w.optional(description.camera, [&](const CameraDescription& c) {
+            w.optional(c.position, [&](const slib::vec3& v) { w.vec3(v); });
+            w.optional(c.forward, [&](const slib::vec3& v) { w.vec3(v); });
+            w.optional(c.pitch);
+            w.optional(c.yaw);
+            w.optional(c.roll);
+            w.optional(c.zNear);
+            w.optional(c.zFar);
+            w.optional(c.viewAngle);
+            w.optional(c.speed);
+            w.optional(c.eagerness);
+            w.optional(c.sensitivity);
+        });
+
+        w.pod(static_cast<uint32_t>(description.solids.size()));
+        for (const auto& solid : description.solids) {
+            writeSolid(w, solid);
+        }
+    }
+
+    SceneDescription readDescription(Reader& r) {
+        SceneDescription description;
+        r.optional(description.name, [&]() { return r.str(); });
+        r.optional(description.shadowsEnabled);
+        r.optional(description.useCubemapShadows);
+        r.optional(description.pcfRadius);
+        r.optional(description.depthSortEnabled);
+        r.optional(description.showAxes);
+        r.optional(description.optimizeMeshes);
+
+        r.optional(description.background, [&]() {
+            BackgroundDescription b;
+            b.type = r.pod<BackgroundType>();
+            r.optional(b.skyboxFaces, [&]() {
+                std::array<std::string, 6> faces;
+                for (auto& face : faces) {
+                    face = r.str();
+                }
+                return faces;
+            });
+            r.optional(b.hdrPath, [&]() { return r.str(); });
+            b.hdrMaxWidth = r.pod<int32_t>();
+            b.hdrCache = r.pod<uint8_t>() != 0;
+            return b;
+        });
+
+        r.optional(description.camera, [&]() {
+            CameraDescription c;
+            r.optional(c.position, [&]() { return r.vec3(); });
+            r.optional(c.forward, [&]() { return r.vec3(); });
+            r.optional(c.pitch);
+            r.optional(c.yaw);
+            r.optional(c.roll);
+            r.optional(c.zNear);
+            r.optional(c.zFar);
+            r.optional(c.viewAngle);
+            r.optional(c.speed);
+            r.optional(c.eagerness);
+            r.optional(c.sensitivity);
+            return c;
+        });
+
+        // Every solid takes at least its two string lengths.
+        uint32_t solidCount = r.count(2 * sizeof(uint32_t));
+        description.solids.reserve(solidCount);
+        for (uint32_t i = 0; i < solidCount && r.ok; ++i) {
+            description.solids.push_back(readSolid(r));
+        }
+        return description;
+    }
+
+    // The YAML, each imported model and, for cooked OBJs, their MTL files.
+    bool collectDependencies(const std::string& yamlPath, const SceneDescription& description,
+                             const std::vector<CookedSolid>& cooked,
+                             std::vector<Dependency>& out) {
+        Dependency dependency;
+        if (!statFile(yamlPath, dependency)) {
+            return false;
+        }
+        out.push_back(dependency);
+
+        // Instance blocks repeat one file many times; it is recorded once.
+        std::set<std::string> seen;
+        for (size_t i = 0; i < description.solids.size(); ++i) {
+            const SolidDescription& solid = description.solids[i];
+            if (solid.file.empty() || !seen.insert(solid.file).second) {
+                continue;
+            }
+            if (!statFile(solid.file, dependency)) {
+                return false;
+            }
+            out.push_back(dependency);
+            if (i >= cooked.size()) {
+                continue;
+            }
+            std::filesystem::path basePath = std::filesystem::path(solid.file).parent_path();
+            for (const auto& library : cooked[i].materialLibraries) {
+                // A missing MTL is recorded as such: creating it later must
+                // invalidate the snapshot too.
+                if (!statFile((basePath / library).string(), dependency)) {
+                    dependency.size = MISSING;
+                    dependency.modified = 0;
+                }
+                out.push_back(dependency);
+            }
+        }
+        return true;
+    }
+
+    // Texture files an MTL library names, as the importer resolves them.
+    std::vector<std::string> textureFiles(const std::string& libraryPath,
+                                          const std::filesystem::path& basePath) {
+        std::vector<std::string> files;
+        std::ifstream in(libraryPath);
+        if (!in) {
+            return files;
+        }
+        std::map<std::string, int> materialIds;
+        std::vector<tinyobj::material_t> materials;
+        std::string warning;
+        std::string error;
+        tinyobj::LoadMtl(&materialIds, &materials, &in, &warning, &error);
+        for (const auto& material : materials) {
+            for (std::string name : {material.diffuse_texname, material.specular_texname,
+                                     material.specular_highlight_texname}) {
+                if (name.empty()) {
+                    continue;
+                }
+                std::replace(name.begin(), name.end(), '\\', '/');
+                files.push_back((basePath / name).string());
+            }
+        }
+        return files;
+    }
+
+}
+
+namespace SceneSnapshot {
+
+bool isCurrent(const Dependency& dependency) {
+    Dependency now;
+    if (!statFile(dependency.path, now)) {
+        return dependency.size == MISSING;
+    }
+    return now.size == dependency.size && now.modified == dependency.modified;
+}
+
+bool isCurrent(const std::vector<Dependency>& dependencies) {
+    return std::all_of(dependencies.begin(), dependencies.end(),
+                       [](const Dependency& dependency) { return isCurrent(dependency); });
+}
+
+std::vector<Dependency> sceneDependencies(const std::string& yamlPath,
+                                          const SceneDescription& description) {
+    std::vector<Dependency> out;
+    std::set<std::string> seen;
+    auto add = [&](const std::string& path) {
+        if (path.empty() || !seen.insert(path).second) {
+            return false;
+        }
+        Dependency dependency;
+        if (!statFile(path, dependency)) {
+            dependency.size = MISSING;
+            dependency.modified = 0;
+        }
+        out.push_back(std::move(dependency));
+        return true;
+    };
+
+    add(yamlPath);
+    for (const auto& solid : description.solids) {
+        // Instance blocks repeat one file many times; it is read once.
+        if (!add(solid.file) || solid.type != "obj_loader") {
+            continue;
+        }
+        std::filesystem::path basePath = std::filesystem::path(solid.file).parent_path();
+        for (const auto& library : MeshCache::materialLibraries(solid.file)) {
+            const std::string libraryPath = (basePath / library).string();
+            if (!add(libraryPath)) {
+                continue;
+            }
+            for (const auto& texture : textureFiles(libraryPath, basePath)) {
+                add(texture);
+            }
+        }
+    }
+    if (description.background) {
+        if (description.background->skyboxFaces) {
+            for (const auto& face : *description.background->skyboxFaces) {
+                add(face);
+            }
+        }
+        if (description.background->hdrPath) {
+            add(*description.background->hdrPath);
+        }
+    }
+    return out;
+}
+
+std::string pathFor(const std::string& yamlPath) {
+    return yamlPath + ".r3dscene";
+}
+
+bool save(const std::string& yamlPath, const SceneDescription& description,
+          const std::vector<CookedSolid>& cooked) {
+    if (!isEnabled()) {
+        return false;
+    }
+
+    std::vector<Dependency> dependencies;
+    if (!collectDependencies(yamlPath, description, cooked, dependencies)) {
+        return false;
+    }
+
+    Writer w;
+    w.bytes.append(MAGIC, sizeof(MAGIC));
+    w.pod(FORMAT_VERSION);
+    w.pod(BYTE_ORDER_MARK);
+
+    w.pod(static_cast<uint32_t>(dependencies.size()));
+    for (const auto& dependency : dependencies) {
+        w.str(dependency.path);
+        w.pod(dependency.size);
+        w.pod(dependency.modified);
+    }
+
+    writeDescription(w, description);
+
+    w.pod(static_cast<uint32_t>(cooked.size()));
+    for (const auto& solid : cooked) {
+        w.str(solid.mesh);
+        w.pod(static_cast<uint32_t>(solid.materialLibraries.size()));
+        for (const auto& library : solid.materialLibraries) {
+            w.str(library);
+        }
+    }
+
+    // Same temp-and-rename scheme as the mesh cache.
+    const std::string path = pathFor(yamlPath);
+    const std::string tempPath = tempPathFor(path);
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            std::cerr << "Scene snapshot: cannot write " << path << "\n";
+            return false;
+        }
+        out.write(w.bytes.data(), static_cast<std::streamsize>(w.bytes.size()));
+        if (!out) {
+            std::cerr << "Scene snapshot: failed writing " << path << "\n";
+            out.close();
+            std::error_code ignored;
+            std::filesystem::remove(tempPath, ignored);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::cerr << "Scene snapshot: cannot replace " << path << ": " << ec.message() << "\n";
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+bool load(const std::string& yamlPath, SceneDescription& description,
+          std::vector<CookedSolid>& cooked) {
+    if (!isEnabled()) {
+        return false;
+    }
+
+    MappedFile file;
+    if (!file.open(pathFor(yamlPath)) || file.size() < sizeof(MAGIC)) {
+        return false;
+    }
+    if (std::memcmp(file.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        return false;
+    }
+
+    Reader r(file.data() + sizeof(MAGIC), file.size() - sizeof(MAGIC));
+    if (r.pod<uint32_t>() != FORMAT_VERSION || r.pod<uint32_t>() != BYTE_ORDER_MARK) {
+        return false;
+    }
+
+    // Dependencies come first so a stale snapshot is rejected before the
+    // rest of it is decoded.
+    uint32_t dependencyCount = r.count(sizeof(uint32_t) + 2 * sizeof(uint64_t));
+    for (uint32_t i = 0; i < dependencyCount; ++i) {
+        Dependency dependency;
+        dependency.path = r.str();
+        dependency.size = r.pod<uint64_t>();
+        dependency.modified = r.pod<int64_t>();
+        if (!r.ok || !isCurrent(dependency)) {
+            return false;
+        }
+    }
+
+    SceneDescription parsed = readDescription(r);
+
+    uint32_t cookedCount = r.count(2 * sizeof(uint32_t));
+    std::vector<CookedSolid> solids(cookedCount);
+    for (auto& solid : solids) {
+        solid.mesh = r.str();
+        uint32_t libraryCount = r.count(sizeof(uint32_t));
+        for (uint32_t i = 0; i < libraryCount; ++i) {
+            solid.materialLibraries.push_back(r.str());
+        }
+    }
+
+    if (!r.ok || !r.atEnd() || solids.size() != parsed.solids.size()) {
+        return false;
+    }
+
+    description = std::move(parsed);
+    cooked = std::move(solids);
+    return true;
+}
+
+void setEnabled(bool enabled) {
+    snapshotEnabled = enabled;
+}
+
+bool isEnabled() {
+    return snapshotEnabled;
+}
+
+} // namespace SceneSnapshot
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "scene_description.hpp"
+
+// Binary snapshots of YAML scenes. After a scene is parsed and built, the
+// loader writes "<yaml>.r3dscene" next to the file: the parsed description
+// plus the cooked mesh of every imported solid. Loading it skips both the
+// YAML parse and the OBJ/ASC imports.
+//
+// A snapshot records the size and modification time of the YAML, of every
+// imported model and of the MTL libraries those models use, and is ignored
+// as soon as any of them changes. Textures are not embedded: materials are
+// rebuilt from the MTL files, which goes through the TextureCache.
+
+namespace SceneSnapshot {
+
+    constexpr uint32_t FORMAT_VERSION = 3;
+
+    // Size and modification time of a file a scene was built from. A file
+    // that was missing is recorded as such, so creating it counts as a change.
+    struct Dependency {
+        std::string path;
+        uint64_t size = 0;
+        int64_t modified = 0;
+    };
+
+    // True while the file still has the recorded size and modification time.
+    bool isCurrent(const Dependency& dependency);
+    bool isCurrent(const std::vector<Dependency>& dependencies);
+
+    // Every file a built scene depends on: the YAML, each imported model,
+    // the MTL libraries of OBJ models and the textures they name, and the
+    // skybox faces or HDR panorama. Wider than what a snapshot records,
+    // since snapshots embed neither textures nor backgrounds. The bundled
+    // textures of procedural solids are not listed.
+    std::vector<Dependency> sceneDependencies(const std::string& yamlPath,
+                                              const SceneDescription& description);
+
+    std::string pathFor(const std::string& yamlPath);
+
+    // `cooked` is indexed like description.solids.
+    bool save(const std::string& yamlPath, const SceneDescription& description,
+              const std::vector<CookedSolid>& cooked);
+
+    // Fails if the snapshot is missing, malformed, from another format
+    // version, or older than any of the files it was built from.
+    bool load(const std::string& yamlPath, SceneDescription& description,
+              std::vector<CookedSolid>& cooked);
+
+    // Global switch, on by default.
+    void setEnabled(bool enabled);
+    bool isEnabled();
+
+} // namespace SceneSnapshot
@@ -0,0 +1,180 @@
+#include "texture_lod.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include <render3d/ecs/transform_system.hpp>
+#include "../assets/mipmap.hpp"
+#include "../assets/profiler.hpp"
+
+using namespace render3d;
+
+namespace {
+
+    // How far past a level boundary (in levels) the estimate must move before
+    // the bound level follows, so objects hovering at a boundary don't flip
+    // between levels every frame.
+    constexpr float kHysteresis = 0.25f;
+
+    constexpr float kDegreesToRadians = 3.14159265358979f / 180.0f;
+
+    Material* findMaterial(Scene& scene, Entity entity, const std::string& key) {
+        auto* component = scene.registry.materials().get(entity);
+        if (!component) {
+            return nullptr;
+        }
+        auto it = component->materials.find(key);
+        return it == component->materials.end() ? nullptr : &it->second;
+    }
+
+    // log2 of texels per screen pixel if the texture is stretched once across
+    // the entity's projected bounding sphere; <= 0 means magnified.
+    float texelsPerPixelLog2(const Scene& scene, Entity entity, int textureSize) {
+        const auto* transform = scene.registry.transforms().get(entity);
+        const auto* mesh = scene.registry.meshes().get(entity);
+        if (!transform || !mesh || mesh->radius <= 0.0f) {
+            return 0.0f;
+        }
+
+        float radius = mesh->radius * transform->position.zoom;
+        slib::vec3 center = TransformSystem::getWorldCenter(*transform);
+        float dx = center.x - scene.camera.pos.x;
+        float dy = center.y - scene.camera.pos.y;
+        float dz = center.z - scene.camera.pos.z;
+        float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+        if (distance <= radius) {
+            return 0.0f;
+        }
+
+        float focal = 0.5f * scene.screen.height /
+                      std::tan(0.5f * scene.camera.viewAngle * kDegreesToRadians);
+        float projectedPixels = 2.0f * radius * focal / distance;
+        if (projectedPixels <= 1.0f) {
+            projectedPixels = 1.0f;
+        }
+        return std::log2(static_cast<float>(textureSize) / projectedPixels);
+    }
+}
+
+void TextureLod::build(Scene& scene) {
+    PROFILE_ZONE("TextureLod::build");
+    chains.clear();
+    counters = Stats{};
+    addChains(scene, scene.entities);
+}
+
+void TextureLod::rebuild(Scene& scene, const std::vector<Entity>& entities) {
+    PROFILE_ZONE("TextureLod::rebuild");
+    auto contains = [](const std::vector<Entity>& list, Entity entity) {
+        return std::find(list.begin(), list.end(), entity) != list.end();
+    };
+    auto stale = std::remove_if(chains.begin(), chains.end(), [&](const Chain& chain) {
+        return contains(entities, chain.entity) || !contains(scene.entities, chain.entity);
+    });
+    for (auto it = stale; it != chains.end(); ++it) {
+        for (size_t level = 1; level < it->levelBytes.size(); ++level) {
+            counters.chainBytes -= it->levelBytes[level];
+        }
+        counters.textures--;
+        counters.fullBytes -= it->levelBytes[0];
+    }
+    chains.erase(stale, chains.end());
+
+    std::vector<Entity> live;
+    for (Entity entity : entities) {
+        if (contains(scene.entities, entity) && !contains(live, entity)) {
+            live.push_back(entity);
+        }
+    }
+    addChains(scene, live);
+
+    counters.reduced = 0;
+    counters.boundBytes = 0;
+    for (const Chain& chain : chains) {
+        counters.boundBytes += chain.levelBytes[chain.bound];
+        if (chain.bound > 0) {
+            counters.reduced++;
+        }
+    }
+}
+
+void TextureLod::addChains(Scene& scene, const std::vector<Entity>& entities) {
+    for (Entity entity : entities) {
+        auto* component = scene.registry.materials().get(entity);
+        if (!component) {
+            continue;
+        }
+        for (auto& [key, material] : component->materials) {
+            Texture& base = material.map_Kd;
+            if (std::min(base.w, base.h) < kMinChainSize) {
+                continue;
+            }
+            Chain chain;
+            chain.entity = entity;
+            chain.materialKey = key;
+            chain.baseSize = std::max(base.w, base.h);
+            chain.levels.emplace_back();
+            chain.levelBytes.push_back(Mipmap::byteSize(base));
+            for (Texture& level : Mipmap::buildChain(base)) {
+                chain.levelBytes.push_back(Mipmap::byteSize(level));
+                counters.chainBytes += chain.levelBytes.back();
+                chain.levels.push_back(std::move(level));
+            }
+            counters.textures++;
+            counters.fullBytes += chain.levelBytes[0];
+            counters.boundBytes += chain.levelBytes[0];
+            chains.push_back(std::move(chain));
+        }
+    }
+}
+
+void TextureLod::update(Scene& scene) {
+    PROFILE_ZONE("TextureLod::update");
+    if (!enabled) {
+        restore(scene);
+        return;
+    }
+
+    counters.reduced = 0;
+    counters.boundBytes = 0;
+    for (Chain& chain : chains) {
+        const auto& sizes = chain.levelBytes;
+        int top = static_cast<int>(chain.levels.size()) - 1;
+
+        float estimate = texelsPerPixelLog2(scene, chain.entity, chain.baseSize);
+
+        int level = chain.bound;
+        if (estimate >= chain.bound + 1 + kHysteresis || estimate < chain.bound - kHysteresis) {
+            level = std::clamp(static_cast<int>(std::floor(estimate)), 0, top);
+        }
+        bind(scene, chain, level);
+
+        counters.boundBytes += sizes[chain.bound];
+        if (chain.bound > 0) {
+            counters.reduced++;
+        }
+    }
+}
+
+void TextureLod::restore(Scene& scene) {
+    counters.reduced = 0;
+    counters.boundBytes = counters.fullBytes;
+    for (Chain& chain : chains) {
+        bind(scene, chain, 0);
+    }
+}
+
+void TextureLod::bind(Scene& scene, Chain& chain, int level) {
+    if (level == chain.bound) {
+        return;
+    }
+    Material* material = findMaterial(scene, chain.entity, chain.materialKey);
+    if (!material) {
+        return;
+    }
+    // Return the bound level to its slot, then take the new one out of its.
+    std::swap(material->map_Kd, chain.levels[chain.bound]);
+    std::swap(material->map_Kd, chain.levels[level]);
+    chain.bound = level;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <render3d/scene.hpp>
+
+using namespace render3d;
+
+// Distance-based mip selection for material diffuse maps.
+//
+// The renderer samples one texture per material, so instead of choosing a
+// level per pixel this binds a whole level per entity: from the entity's
+// bounding radius and distance it estimates how many screen pixels its
+// texture spans and swaps the matching mip level into the material. A far
+// `world` sphere then samples a 187x93 copy of its 1500x750 texture instead
+// of striding across the full-size one. Entities the camera is inside of
+// (sponza) always keep full size.
+//
+// Levels move in and out of the materials with std::swap, so changing level
+// never copies pixels. build() may run on a loader thread before the scene is
+// shown; update() and restore() belong to the thread that renders the scene.
+
+class TextureLod {
+public:
+    struct Stats {
+        size_t textures = 0;     // diffuse maps with a mip chain
+        size_t reduced = 0;      // of those, bound below full size this frame
+        size_t fullBytes = 0;    // full-size bytes of those maps
+        size_t boundBytes = 0;   // bytes of the levels currently bound
+        size_t chainBytes = 0;   // extra memory held by levels 1..n
+    };
+
+    // Builds chains for every diffuse map at least kMinChainSize on a side.
+    // Replaces whatever this object held for a previous scene.
+    void build(Scene& scene);
+
+    // Builds chains again for the materials of `entities` after they were
+    // replaced in place or added, and drops the chains of entities no longer
+    // in the scene. Other chains are kept as they are. restore() must have
+    // bound full size before the materials were replaced.
+    void rebuild(Scene& scene, const std::vector<Entity>& entities);
+
+    // Picks each entity's level for the current camera and binds it.
+    void update(Scene& scene);
+
+    // Binds full-size textures again, e.g. before LOD is switched off.
+    void restore(Scene& scene);
+
+    const Stats& stats() const { return counters; }
+
+    bool enabled = true;
+
+    static constexpr int kMinChainSize = 64;
+
+private:
+    struct Chain {
+        Entity entity = NULL_ENTITY;
+        std::string materialKey;
+        // levels[bound] holds whatever the material held before level
+        // `bound` was swapped in: the full-size map lives in levels[0]
+        // whenever a smaller level is bound.
+        std::vector<Texture> levels;
+        std::vector<size_t> levelBytes;
+        int baseSize = 0;  // longer side of level 0
+        int bound = 0;
+    };
+
+    void addChains(Scene& scene, const std::vector<Entity>& entities);
+    void bind(Scene& scene, Chain& chain, int level);
+
+    std::vector<Chain> chains;
+    Stats counters;
+};
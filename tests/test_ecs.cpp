@@ -1,5 +1,13 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
 #include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <thread>
 #include <render3d/ecs/entity.hpp>
 #include <render3d/ecs/component_store.hpp>
 #include <render3d/ecs/registry.hpp>
@@ -9,7 +17,36 @@
 #include <render3d/ecs/light_system.hpp>
 #include <render3d/ecs/shadow_system.hpp>
 #include <render3d/ecs/render_component.hpp>
+#include "../src/assets/asc_parser.hpp"
+#include "../src/assets/background_factory.hpp"
+#include "../src/assets/cubemap_loader.hpp"
+#include "../src/assets/file_watcher.hpp"
+#include "../src/assets/hdr_cache.hpp"
+#include "../src/assets/json_string.hpp"
+#include "../src/assets/material_keys.hpp"
+#include "../src/assets/mesh_cache.hpp"
+#include "../src/assets/mesh_optimize.hpp"
+#include "../src/assets/mesh_simplify.hpp"
+#include "../src/assets/mipmap.hpp"
+#include "../src/assets/obj_parser.hpp"
+#include "../src/assets/ppm_writer.hpp"
 #include "../src/assets/prefab_factory.hpp"
+#include "../src/assets/profiler.hpp"
+#include "../src/assets/texture_cache.hpp"
+#include "../src/assets/vertex_dedup.hpp"
+#include "../src/render_pipeline.hpp"
+#include "../src/scenes/async_scene_loader.hpp"
+#include "../src/scenes/bench_report.hpp"
+#include "../src/scenes/dynamic_resolution.hpp"
+#include "../src/scenes/frame_state.hpp"
+#include "../src/scenes/instancing.hpp"
+#include "../src/scenes/memory_report.hpp"
+#include "../src/scenes/mesh_lod.hpp"
+#include "../src/scenes/scene_factory.hpp"
+#include "../src/scenes/scene_loader.hpp"
+#include "../src/scenes/scene_reloader.hpp"
+#include "../src/scenes/scene_snapshot.hpp"
+#include "../src/scenes/texture_lod.hpp"
 
 // ============================================================================
 // Entity Tests
@@ -476,7 +513,8 @@ TEST(PrefabFactoryTest, BuildObj) {
 
     std::filesystem::path objPath = std::filesystem::path(__FILE__).parent_path() /
         "fixtures" / "triangle.obj";
-    bool hasNormals = PrefabFactory::buildObj(objPath.string(), mesh, material, transform);
+    // No mesh cache: it would write a sidecar into the fixtures directory.
+    bool hasNormals = PrefabFactory::buildObj(objPath.string(), mesh, material, transform, false);
 
     EXPECT_FALSE(hasNormals);
     EXPECT_EQ(mesh.vertexData.size(), 3u);
@@ -484,6 +522,2003 @@ TEST(PrefabFactoryTest, BuildObj) {
     EXPECT_TRUE(material.materials.count("default") > 0);
 }
 
+TEST(PrefabFactoryTest, BuildObjWithMtlTextures) {
+    MeshComponent mesh;
+    MaterialComponent material;
+    TransformComponent transform;
+
+    std::filesystem::path objPath = std::filesystem::path(__FILE__).parent_path() /
+        "fixtures" / "textured_quad.obj";
+    TextureCache::clear();
+    PrefabFactory::buildObj(objPath.string(), mesh, material, transform, false);
+
+    EXPECT_EQ(mesh.faceData.size(), 2u);
+    EXPECT_TRUE(material.materials.count("checker") > 0);
+    EXPECT_TRUE(material.materials.count("missing") > 0);
+
+    // map_Kd and map_Ks of "checker" name the same file: decoded once, shared.
+    EXPECT_EQ(TextureCache::stats().entries, 1u);
+}
+
+// ============================================================================
+// MeshCache Tests
+// ============================================================================
+
+namespace {
+    std::filesystem::path copyFixtureToTemp(const std::string& name) {
+        std::filesystem::path dir = std::filesystem::temp_directory_path() / "render3d_mesh_cache_test";
+        std::filesystem::create_directories(dir);
+        std::filesystem::path target = dir / name;
+        std::filesystem::copy_file(std::filesystem::path(__FILE__).parent_path() / "fixtures" / name,
+                                   target, std::filesystem::copy_options::overwrite_existing);
+        std::filesystem::remove(MeshCache::cachePathFor(target.string()));
+        return target;
+    }
+}
+
+TEST(MeshCacheTest, ObjRoundTrip) {
+    std::filesystem::path objPath = copyFixtureToTemp("triangle.obj");
+
+    MeshComponent parsed;
+    MaterialComponent parsedMaterial;
+    TransformComponent parsedTransform;
+    bool parsedNormals = PrefabFactory::buildObj(objPath.string(), parsed, parsedMaterial, parsedTransform);
+    ASSERT_TRUE(std::filesystem::exists(MeshCache::cachePathFor(objPath.string())));
+
+    MeshComponent cached;
+    MaterialComponent cachedMaterial;
+    TransformComponent cachedTransform;
+    bool cachedNormals = PrefabFactory::buildObj(objPath.string(), cached, cachedMaterial, cachedTransform);
+
+    EXPECT_EQ(cachedNormals, parsedNormals);
+    ASSERT_EQ(cached.vertexData.size(), parsed.vertexData.size());
+    ASSERT_EQ(cached.faceData.size(), parsed.faceData.size());
+    for (size_t i = 0; i < parsed.vertexData.size(); ++i) {
+        EXPECT_FLOAT_EQ(cached.vertexData[i].vertex.x, parsed.vertexData[i].vertex.x);
+        EXPECT_FLOAT_EQ(cached.vertexData[i].normal.z, parsed.vertexData[i].normal.z);
+        EXPECT_FLOAT_EQ(cached.vertexData[i].texCoord.y, parsed.vertexData[i].texCoord.y);
+    }
+    EXPECT_EQ(cached.faceData[0].face.vertexIndices, parsed.faceData[0].face.vertexIndices);
+    EXPECT_EQ(cached.faceData[0].face.materialKey, parsed.faceData[0].face.materialKey);
+    EXPECT_FLOAT_EQ(cached.radius, parsed.radius);
+    EXPECT_FLOAT_EQ(cachedTransform.position.zoom, parsedTransform.position.zoom);
+    EXPECT_TRUE(cachedMaterial.materials.count("default") > 0);
+}
+
+TEST(MeshCacheTest, RejectsStaleHash) {
+    std::filesystem::path objPath = copyFixtureToTemp("triangle.obj");
+    MeshCache::SourceInfo source = MeshCache::describeSource(objPath.string());
+    ASSERT_TRUE(source.valid);
+
+    MeshComponent mesh;
+    MaterialComponent material;
+    PrefabFactory::buildCube(mesh, material);
+    std::string cachePath = MeshCache::cachePathFor(objPath.string());
+    ASSERT_TRUE(MeshCache::save(cachePath, source.hash, mesh, true));
+
+    MeshComponent restored;
+    bool hasNormals = false;
+    EXPECT_TRUE(MeshCache::load(cachePath, source.hash, restored, hasNormals));
+    EXPECT_TRUE(hasNormals);
+    EXPECT_EQ(restored.vertexData.size(), 24u);
+    EXPECT_EQ(restored.faceData.size(), 6u);
+    EXPECT_EQ(restored.faceData[0].face.materialKey, "floorTexture");
+
+    EXPECT_FALSE(MeshCache::load(cachePath, source.hash + 1, restored, hasNormals));
+}
+
+TEST(MeshCacheTest, HashFollowsMaterialLibrary) {
+    std::filesystem::path objPath = copyFixtureToTemp("textured_quad.obj");
+    std::filesystem::path mtlPath = copyFixtureToTemp("textured_quad.mtl");
+
+    MeshCache::SourceInfo before = MeshCache::describeSource(objPath.string());
+    ASSERT_EQ(before.materialLibraries.size(), 1u);
+    EXPECT_EQ(before.materialLibraries[0], "textured_quad.mtl");
+
+    std::ofstream(mtlPath, std::ios::app) << "Ns 12\n";
+    MeshCache::SourceInfo after = MeshCache::describeSource(objPath.string());
+    EXPECT_NE(before.hash, after.hash);
+}
+
+// ============================================================================
+// MaterialKeys Tests
+// ============================================================================
+
+TEST(MaterialKeysTest, InternsNamesAsDenseIds) {
+    MeshComponent mesh;
+    MaterialComponent material;
+    PrefabFactory::buildTorus(mesh, material, 8, 4, 1.0f, 0.3f);
+    // A name too long for the string's inline buffer, and one no face uses.
+    const std::string longName = "a_material_name_from_an_exporter";
+    material.materials[longName] = material.materials["white"];
+    material.materials.erase("white");
+    material.materials["unused"] = Material{};
+    std::vector<std::string> names;
+    for (auto& face : mesh.faceData) {
+        if (face.face.materialKey == "white") {
+            face.face.materialKey = longName;
+        }
+        names.push_back(face.face.materialKey);
+    }
+    EXPECT_GT(MaterialKeys::keyHeapBytes(mesh), 0u);
+    const float blueKd = material.materials["blue"].Kd.x;
+
+    EXPECT_EQ(MaterialKeys::intern(mesh, material), 3u);
+    EXPECT_EQ(MaterialKeys::keyHeapBytes(mesh), 0u);
+    ASSERT_EQ(material.materials.size(), 3u);
+    const std::string firstId = mesh.faceData[0].face.materialKey;
+    EXPECT_EQ(firstId, "0");
+    for (size_t f = 0; f < mesh.faceData.size(); ++f) {
+        const std::string& id = mesh.faceData[f].face.materialKey;
+        EXPECT_EQ(id == firstId, names[f] == names[0]);
+        EXPECT_TRUE(material.materials.count(id));
+    }
+    EXPECT_TRUE(material.materials.count("2"));  // "unused", numbered last
+    const std::string blueId = names[0] == "blue" ? "0" : "1";
+    EXPECT_FLOAT_EQ(material.materials[blueId].Kd.x, blueKd);
+}
+
+TEST(MaterialKeysTest, KeepsNamesThatFitInline) {
+    MeshComponent mesh;
+    MaterialComponent material;
+    PrefabFactory::buildTorus(mesh, material, 8, 4, 1.0f, 0.3f);
+    const std::string firstName = mesh.faceData[0].face.materialKey;
+    ASSERT_EQ(MaterialKeys::keyHeapBytes(mesh), 0u);
+
+    EXPECT_EQ(MaterialKeys::intern(mesh, material), 0u);
+    EXPECT_EQ(mesh.faceData[0].face.materialKey, firstName);
+    EXPECT_TRUE(material.materials.count("white"));
+    EXPECT_TRUE(material.materials.count("blue"));
+}
+
+// ============================================================================
+// MeshOptimize Tests
+// ============================================================================
+
+TEST(MeshOptimizeTest, ReordersWithoutChangingTriangles) {
+    MeshComponent mesh;
+    MaterialComponent material;
+    PrefabFactory::buildWorld(mesh, material, 24, 48);
+    const size_t triangles = MeshSimplify::triangleCount(mesh);
+
+    // Each triangle as its sorted corner positions and material.
+    auto corners = [](const MeshComponent& m) {
+        std::multiset<std::string> result;
+        for (const auto& face : m.faceData) {
+            const auto& indices = face.face.vertexIndices;
+            for (size_t i = 2; i < indices.size(); ++i) {
+                std::vector<std::string> points;
+                for (int v : {indices[0], indices[i - 1], indices[i]}) {
+                    const auto& p = m.vertexData[v].vertex;
+                    char text[64];
+                    std::snprintf(text, sizeof(text), "%.4f,%.4f,%.4f", p.x, p.y, p.z);
+                    points.push_back(text);
+                }
+                std::sort(points.begin(), points.end());
+                result.insert(points[0] + points[1] + points[2] + face.face.materialKey);
+            }
+        }
+        return result;
+    };
+    const auto before = corners(mesh);
+
+    MeshOptimize::Result result = MeshOptimize::optimize(mesh);
+    EXPECT_EQ(result.triangles, triangles);
+    EXPECT_EQ(mesh.faceData.size(), triangles);
+    EXPECT_EQ(corners(mesh), before);
+    EXPECT_LT(result.acmrAfter, result.acmrBefore);
+    EXPECT_LT(result.acmrAfter, 1.0f);
+    EXPECT_FLOAT_EQ(MeshOptimize::acmr(mesh), result.acmrAfter);
+
+    // Vertices are numbered in order of first use.
+    int next = 0;
+    for (const auto& face : mesh.faceData) {
+        for (int v : face.face.vertexIndices) {
+            ASSERT_LE(v, next);
+            if (v == next) {
+                ++next;
+            }
+        }
+    }
+}
+
+TEST(MeshOptimizeTest, SceneSettingOptimizesEachMeshOnce) {
+    SceneDescription description;
+    SolidDescription world;
+    world.type = "world";
+    description.solids.push_back(world);
+    description.solids.push_back(world);
+
+    auto plain = SceneLoader::build(description, Screen{64, 48});
+    EXPECT_EQ(SceneLoader::lastMeshStats().optimized, 0u);
+
+    description.optimizeMeshes = true;
+    auto optimized = SceneLoader::build(description, Screen{64, 48});
+    MeshLibrary::Stats stats = SceneLoader::lastMeshStats();
+    EXPECT_EQ(stats.optimized, 1u);
+    EXPECT_LT(stats.cacheMissesAfter, stats.cacheMissesBefore);
+    const MeshComponent* mesh = optimized->registry.meshes().get(optimized->entities[1]);
+    for (const auto& face : mesh->faceData) {
+        EXPECT_EQ(face.face.vertexIndices.size(), 3u);
+    }
+    EXPECT_NE(plain->registry.meshes().get(plain->entities[1])->faceData.size(),
+              mesh->faceData.size());
+}
+
+// ============================================================================
+// ObjParser Tests
+// ============================================================================
+
+namespace {
+    // Parses objPath with ObjParser, split into chunks of chunkBytes (0 for
+    // the default sizing), and compares the result against tinyobj.
+    void expectMatchesTinyObj(const std::string& objPath, const std::string& mtlDir,
+                              size_t chunkBytes, size_t minChunks) {
+        ObjParser::Result parsed;
+        ASSERT_TRUE(ObjParser::parse(objPath, mtlDir, parsed, chunkBytes));
+        EXPECT_GE(parsed.chunks, minChunks);
+
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string warning;
+        std::string error;
+        ASSERT_TRUE(tinyobj::LoadObj(&attrib, &shapes, &materials, &warning, &error,
+                                     objPath.c_str(), mtlDir.c_str(), true));
+
+        EXPECT_EQ(parsed.attrib.vertices, attrib.vertices);
+        EXPECT_EQ(parsed.attrib.texcoords, attrib.texcoords);
+        EXPECT_EQ(parsed.attrib.normals, attrib.normals);
+        ASSERT_EQ(parsed.materials.size(), materials.size());
+
+        std::vector<int> expectedIndices;
+        std::vector<int> expectedMaterials;
+        size_t expectedFaces = 0;
+        for (const auto& shape : shapes) {
+            for (const auto& idx : shape.mesh.indices) {
+                expectedIndices.insert(expectedIndices.end(),
+                                       {idx.vertex_index, idx.texcoord_index, idx.normal_index});
+            }
+            expectedMaterials.insert(expectedMaterials.end(),
+                                     shape.mesh.material_ids.begin(), shape.mesh.material_ids.end());
+            expectedFaces += shape.mesh.num_face_vertices.size();
+        }
+
+        ASSERT_EQ(parsed.shapes.size(), 1u);
+        std::vector<int> indices;
+        for (const auto& idx : parsed.shapes[0].mesh.indices) {
+            indices.insert(indices.end(), {idx.vertex_index, idx.texcoord_index, idx.normal_index});
+        }
+        EXPECT_EQ(indices, expectedIndices);
+        EXPECT_EQ(parsed.shapes[0].mesh.material_ids, expectedMaterials);
+        EXPECT_EQ(parsed.shapes[0].mesh.num_face_vertices.size(), expectedFaces);
+    }
+}
+
+TEST(ObjParserTest, MatchesTinyObj) {
+    std::filesystem::path fixtures = std::filesystem::path(__FILE__).parent_path() / "fixtures";
+    expectMatchesTinyObj((fixtures / "mixed_faces.obj").string(), fixtures.string(), 0, 1);
+}
+
+TEST(ObjParserTest, MatchesTinyObjAcrossChunkBoundaries) {
+    std::filesystem::path fixtures = std::filesystem::path(__FILE__).parent_path() / "fixtures";
+    // Every boundary the fixture has: each chunk ends within a line or two,
+    // so relative indices and usemtl spans cross into later chunks.
+    expectMatchesTinyObj((fixtures / "mixed_faces.obj").string(), fixtures.string(), 16, 10);
+}
+
+TEST(ObjParserTest, MatchesTinyObjOnMultiChunkFile) {
+    std::filesystem::path fixtures = std::filesystem::path(__FILE__).parent_path() / "fixtures";
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "render3d_obj_parser_test";
+    std::filesystem::create_directories(dir);
+    std::filesystem::path objPath = dir / "strip.obj";
+
+    // A strip of quads, each an object with its own vertices. Faces mix
+    // absolute and relative indices, and the material changes every few
+    // quads, so with the default sizing both fall on chunk boundaries.
+    {
+        std::ofstream out(objPath);
+        out << "mtllib textured_quad.mtl\n";
+        const char* names[] = {"checker", "missing", "unknown"};
+        for (int q = 0; q < 12000; ++q) {
+            out << "o quad" << q << "\n";
+            for (int c = 0; c < 4; ++c) {
+                out << "v " << q + (c == 1 || c == 2) << ' ' << (c >= 2) << " 0.5\n";
+                out << "vt " << 0.25f * c << ' ' << (c >= 2) << "\n";
+            }
+            out << "vn 0 0 1\n";
+            if (q % 7 == 0) {
+                out << "usemtl " << names[(q / 7) % 3] << "\n";
+            }
+            const int base = 4 * q + 1;
+            const int normal = q + 1;
+            if (q % 2 == 0) {
+                out << "f " << base << '/' << base << '/' << normal << ' '
+                    << base + 1 << '/' << base + 1 << '/' << normal << ' '
+                    << base + 2 << '/' << base + 2 << '/' << normal << ' '
+                    << base + 3 << '/' << base + 3 << '/' << normal << "\n";
+            } else {
+                out << "f -4/-4/-1 -3/-3/-1 -2/-2/-1\nf -4//-1 -2//-1 -1//-1\n";
+            }
+        }
+    }
+    ASSERT_GT(std::filesystem::file_size(objPath), 2 * 256 * 1024u);
+
+    // Forced 64 KB chunks split it whatever the worker count.
+    expectMatchesTinyObj(objPath.string(), fixtures.string(), 64 * 1024, 8);
+    expectMatchesTinyObj(objPath.string(), fixtures.string(), 0, 1);
+}
+
+TEST(ObjParserTest, RejectsPolygonsBeyondQuads) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "render3d_obj_parser_test";
+    std::filesystem::create_directories(dir);
+    std::filesystem::path objPath = dir / "pentagon.obj";
+    std::ofstream(objPath) << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0.5 2 0\nv 0 1 0\nf 1 2 3 4 5\n";
+
+    ObjParser::Result parsed;
+    EXPECT_FALSE(ObjParser::parse(objPath.string(), dir.string(), parsed));
+
+    MeshComponent mesh;
+    MaterialComponent material;
+    TransformComponent transform;
+    PrefabFactory::buildObj(objPath.string(), mesh, material, transform, false);
+    EXPECT_EQ(mesh.faceData.size(), 3u);
+}
+
+// ============================================================================
+// VertexDedupTable Tests
+// ============================================================================
+
+TEST(VertexDedupTableTest, NumbersDistinctCornersAndFindsDuplicates) {
+    VertexDedupTable table(4);
+    EXPECT_EQ(table.findOrInsert(0, 0, 0, 0), 0);
+    EXPECT_EQ(table.findOrInsert(0, 1, 0, 1), 1);
+    EXPECT_EQ(table.findOrInsert(0, 0, 1, 2), 2);
+    EXPECT_EQ(table.size(), 3u);
+
+    // A corner seen before keeps its index whatever nextIndex says.
+    EXPECT_EQ(table.findOrInsert(0, 1, 0, 3), 1);
+    EXPECT_EQ(table.findOrInsert(0, 0, 0, 3), 0);
+    EXPECT_EQ(table.size(), 3u);
+}
+
+TEST(VertexDedupTableTest, MissingTexcoordAndNormalAreKeyParts) {
+    VertexDedupTable table(4);
+    EXPECT_EQ(table.findOrInsert(5, -1, -1, 0), 0);
+    EXPECT_EQ(table.findOrInsert(5, -1, 0, 1), 1);
+    EXPECT_EQ(table.findOrInsert(5, 0, -1, 2), 2);
+    EXPECT_EQ(table.findOrInsert(5, -1, -1, 3), 0);
+    EXPECT_EQ(table.findOrInsert(5, 0, -1, 3), 2);
+    EXPECT_EQ(table.size(), 3u);
+}
+
+TEST(VertexDedupTableTest, ResolvesCollisionChains) {
+    VertexDedupTable table(8);
+    const size_t mask = table.capacity() - 1;
+
+    // Corners that share a home slot probe past each other.
+    std::vector<int> chain;
+    const size_t home = VertexDedupTable::hash(0, 0, 0) & mask;
+    for (int pos = 0; chain.size() < 4; ++pos) {
+        if ((VertexDedupTable::hash(pos, 0, 0) & mask) == home)
+            chain.push_back(pos);
+    }
+    for (size_t i = 0; i < chain.size(); ++i) {
+        EXPECT_EQ(table.findOrInsert(chain[i], 0, 0, static_cast<int>(i)), static_cast<int>(i));
+    }
+    for (size_t i = 0; i < chain.size(); ++i) {
+        EXPECT_EQ(table.findOrInsert(chain[i], 0, 0, 99), static_cast<int>(i));
+    }
+    EXPECT_EQ(table.size(), chain.size());
+}
+
+TEST(VertexDedupTableTest, HoldsMaxCornersDistinctCorners) {
+    const size_t maxCorners = 1000;
+    VertexDedupTable table(maxCorners);
+    EXPECT_GE(table.capacity(), 2 * maxCorners);
+
+    for (size_t i = 0; i < maxCorners; ++i) {
+        const int n = static_cast<int>(i);
+        EXPECT_EQ(table.findOrInsert(n / 10, n % 10, n % 3 - 1, n), n);
+    }
+    EXPECT_EQ(table.size(), maxCorners);
+    for (size_t i = 0; i < maxCorners; ++i) {
+        const int n = static_cast<int>(i);
+        ASSERT_EQ(table.findOrInsert(n / 10, n % 10, n % 3 - 1, -2), n);
+    }
+    EXPECT_EQ(table.size(), maxCorners);
+}
+
+// ============================================================================
+// AscParser Tests
+// ============================================================================
+
+TEST(AscParserTest, ParsesVertexAndFaceLists) {
+    const std::string text =
+        "Named Object: \"Tri01\"\r\n"
+        "Tri-mesh, Vertices: 3     Faces: 1\r\n"
+        "Vertex list:\r\n"
+        "Vertex 0: X: -1.5     Y: 2.0e1     Z: .25\r\n"
+        "Vertex 1: X: 3.000000     Y: -0.000001     Z: 4\r\n"
+        "Vertex 2: X: broken\r\n"
+        "  Vertex 2:  X: 0.5\tY: 0.5\tZ: 0.5  \r\n"
+        "Face list:\r\n"
+        "Face 0:    A:0 B:1 C:2 AB:1 BC:1 CA:0\r\n"
+        "Smoothing:  1\r\n"
+        "Vertex 3: X: 9 Y: 9 Z: 9\r\n";
+
+    AscParser::Result result;
+    AscParser::parse(text.data(), text.size(), result);
+
+    ASSERT_EQ(result.vertices.size(), 3u);
+    EXPECT_FLOAT_EQ(result.vertices[0].vertex.x, -1.5f);
+    EXPECT_FLOAT_EQ(result.vertices[0].vertex.y, 20.0f);
+    EXPECT_FLOAT_EQ(result.vertices[0].vertex.z, 0.25f);
+    EXPECT_FLOAT_EQ(result.vertices[1].vertex.y, -0.000001f);
+    EXPECT_FLOAT_EQ(result.vertices[2].vertex.z, 0.5f);
+    ASSERT_EQ(result.faces.size(), 1u);
+    EXPECT_EQ(result.faces[0].face.vertexIndices, (std::vector<int>{0, 1, 2}));
+}
+
+// ============================================================================
+// AsyncSceneLoader Tests
+// ============================================================================
+
+namespace {
+    // Registers a one-file scene directory with SceneFactory (index 0).
+    void useSingleSceneDirectory(const std::string& yaml) {
+        std::filesystem::path dir = std::filesystem::temp_directory_path() / "render3d_async_scene_test";
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        std::ofstream(dir / "scene.yaml") << yaml;
+        SceneFactory::scanYamlScenes(dir.string());
+    }
+
+    AsyncSceneLoader::Status waitForLoader(const AsyncSceneLoader& loader) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        AsyncSceneLoader::Status status = loader.status();
+        while (status.loading && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            status = loader.status();
+        }
+        return status;
+    }
+}
+
+TEST(AsyncSceneLoaderTest, DeliversSceneOnce) {
+    useSingleSceneDirectory(
+        "scene:\n"
+        "  name: \"Async\"\n"
+        "  solids:\n"
+        "    - type: icosahedron\n"
+        "      name: \"A\"\n"
+        "    - type: tetrakis\n"
+        "      name: \"B\"\n");
+
+    AsyncSceneLoader loader;
+    loader.request(0, Screen{64, 48}, BackgroundType::DESERT);
+    AsyncSceneLoader::Status status = waitForLoader(loader);
+    ASSERT_FALSE(status.loading);
+    EXPECT_TRUE(status.error.empty());
+    EXPECT_FLOAT_EQ(status.progress, 1.0f);
+
+    int index = -1;
+    std::unique_ptr<Scene> scene = loader.takeReady(index);
+    ASSERT_NE(scene, nullptr);
+    EXPECT_EQ(index, 0);
+    EXPECT_EQ(scene->entities.size(), 2u);
+    EXPECT_EQ(scene->backgroundType, BackgroundType::DESERT);
+    EXPECT_EQ(loader.takeReady(index), nullptr);
+}
+
+TEST(AsyncSceneLoaderTest, ReportsLoadErrors) {
+    useSingleSceneDirectory(
+        "scene:\n"
+        "  solids:\n"
+        "    - type: no_such_solid\n");
+
+    AsyncSceneLoader loader;
+    loader.request(0, Screen{64, 48}, BackgroundType::DESERT);
+    AsyncSceneLoader::Status status = waitForLoader(loader);
+    ASSERT_FALSE(status.loading);
+    EXPECT_NE(status.error.find("no_such_solid"), std::string::npos);
+
+    int index = -1;
+    EXPECT_EQ(loader.takeReady(index), nullptr);
+}
+
+TEST(AsyncSceneLoaderTest, CancelDropsResult) {
+    useSingleSceneDirectory(
+        "scene:\n"
+        "  solids:\n"
+        "    - type: icosahedron\n");
+
+    AsyncSceneLoader loader;
+    loader.request(0, Screen{64, 48}, BackgroundType::DESERT);
+    loader.cancel();
+    EXPECT_FALSE(loader.status().loading);
+
+    // The worker may still be finishing; its scene must never be handed out.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    int index = -1;
+    EXPECT_EQ(loader.takeReady(index), nullptr);
+}
+
+TEST(AsyncSceneLoaderTest, CachesRetiredAndPrefetchedScenes) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "render3d_scene_cache_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "a.yaml") << "scene:\n  solids:\n    - type: icosahedron\n";
+    std::ofstream(dir / "b.yaml") << "scene:\n  solids:\n    - type: tetrakis\n    - type: tetrakis\n";
+    SceneFactory::scanYamlScenes(dir.string());
+
+    AsyncSceneLoader loader;
+    loader.request(0, Screen{64, 48}, BackgroundType::DESERT);
+    waitForLoader(loader);
+    int index = -1;
+    TextureLod textureLod;
+    std::unique_ptr<Scene> first = loader.takeReady(index, &textureLod);
+    ASSERT_NE(first, nullptr);
+
+    // Scene 1 is the only neighbour; takeReady() starts its prefetch.
+    loader.prefetchAround(0, Screen{64, 48}, BackgroundType::DESERT);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (loader.cacheStats().scenes == 0 && std::chrono::steady_clock::now() < deadline) {
+        loader.takeReady(index);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(loader.cacheStats().scenes, 1u);
+
+    // A cached scene is ready without loading.
+    loader.request(1, Screen{64, 48}, BackgroundType::DESERT);
+    EXPECT_EQ(loader.status().stage, "Cached");
+    std::unique_ptr<Scene> second = loader.takeReady(index, &textureLod);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(index, 1);
+    EXPECT_EQ(second->entities.size(), 2u);
+
+    Scene* firstPointer = first.get();
+    loader.retire(0, std::move(first), TextureLod{}, MeshLod{});
+    EXPECT_GT(loader.cacheStats().bytes, 0u);
+    loader.request(0, Screen{64, 48}, BackgroundType::DESERT);
+    std::unique_ptr<Scene> again = loader.takeReady(index);
+    EXPECT_EQ(again.get(), firstPointer);
+    EXPECT_EQ(loader.cacheStats().hits, 2u);
+
+    // Over budget: the scene is dropped instead of kept.
+    loader.setCacheBudget(0);
+    loader.retire(1, std::move(second), TextureLod{}, MeshLod{});
+    EXPECT_EQ(loader.cacheStats().scenes, 0u);
+    EXPECT_EQ(loader.cacheStats().evictions, 1u);
+
+    // An edited file invalidates its cached scene.
+    loader.setCacheBudget(SceneCache::kDefaultBudget);
+    loader.retire(0, std::move(again), TextureLod{}, MeshLod{});
+    std::filesystem::last_write_time(dir / "a.yaml", std::filesystem::last_write_time(dir / "a.yaml") +
+                                                         std::chrono::seconds(2));
+    loader.request(0, Screen{64, 48}, BackgroundType::DESERT);
+    EXPECT_TRUE(loader.status().loading);
+    waitForLoader(loader);
+}
+
+TEST(AsyncSceneLoaderTest, CachedSceneFollowsModelAndTextureEdits) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "render3d_scene_cache_sources_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::filesystem::path root = std::filesystem::path(__FILE__).parent_path().parent_path();
+    std::filesystem::copy_file(root / "tests" / "fixtures" / "textured_quad.obj", dir / "textured_quad.obj");
+    std::filesystem::copy_file(root / "resources" / "checker-map_tho.png", dir / "checker.png");
+    std::ofstream(dir / "textured_quad.mtl") << "newmtl checker\nKd 1 1 1\nmap_Kd checker.png\n";
+    std::ofstream(dir / "quad.yaml") <<
+        "scene:\n"
+        "  solids:\n"
+        "    - type: obj_loader\n"
+        "      file: \"" + (dir / "textured_quad.obj").generic_string() + "\"\n";
+    SceneFactory::scanYamlScenes(dir.string());
+
+    AsyncSceneLoader loader;
+    loader.prefetch = false;
+    auto loadAndRetire = [&loader]() {
+        int index = -1;
+        std::unique_ptr<Scene> scene = loader.takeReady(index);
+        ASSERT_NE(scene, nullptr);
+        loader.retire(0, std::move(scene), TextureLod{}, MeshLod{});
+    };
+    auto touch = [](const std::filesystem::path& path) {
+        std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) +
+                                                   std::chrono::seconds(2));
+    };
+
+    loader.request(0, Screen{64, 48}, BackgroundType::DESERT);
+    waitForLoader(loader);
+    loadAndRetire();
+    loader.request(0, Screen{64, 48}, BackgroundType::DESERT);
+    EXPECT_EQ(loader.status().stage, "Cached");
+    loadAndRetire();
+
+    // The YAML is untouched; the texture the MTL names changed.
+    touch(dir / "checker.png");
+    loader.request(0, Screen{64, 48}, BackgroundType::DESERT);
+    EXPECT_TRUE(loader.status().loading);
+    waitForLoader(loader);
+    loadAndRetire();
+
+    touch(dir / "textured_quad.mtl");
+    loader.request(0, Screen{64, 48}, BackgroundType::DESERT);
+    EXPECT_TRUE(loader.status().loading);
+    waitForLoader(loader);
+    loadAndRetire();
+
+    touch(dir / "textured_quad.obj");
+    loader.request(0, Screen{64, 48}, BackgroundType::DESERT);
+    EXPECT_TRUE(loader.status().loading);
+    waitForLoader(loader);
+}
+
+TEST(AsyncSceneLoaderTest, CachesOnlyScenesWithKnownSources) {
+    useSingleSceneDirectory(
+        "scene:\n"
+        "  solids:\n"
+        "    - type: icosahedron\n");
+
+    AsyncSceneLoader loader;
+    loader.prefetch = false;
+    std::vector<SceneSnapshot::Dependency> sources;
+
+    // Loaded without the loader and never adopted: nothing to check it against.
+    loader.retire(0, SceneFactory::createSceneByIndex(0, Screen{64, 48}), TextureLod{}, MeshLod{});
+    EXPECT_EQ(loader.cacheStats().scenes, 0u);
+
+    std::unique_ptr<Scene> scene = SceneFactory::createSceneByIndex(0, Screen{64, 48}, nullptr, &sources);
+    ASSERT_FALSE(sources.empty());
+    loader.adopt(0, std::move(sources));
+    loader.retire(0, std::move(scene), TextureLod{}, MeshLod{});
+    EXPECT_EQ(loader.cacheStats().scenes, 1u);
+
+    // Evicted entries are freed on a worker thread; the loader joins it.
+    loader.setCacheBudget(0);
+    EXPECT_EQ(loader.cacheStats().scenes, 0u);
+    EXPECT_EQ(loader.cacheStats().evictions, 1u);
+}
+
+TEST(AsyncSceneLoaderTest, BuildsAndCachesRenderCopies) {
+    useSingleSceneDirectory(
+        "scene:\n"
+        "  solids:\n"
+        "    - type: icosahedron\n"
+        "    - type: cube\n");
+
+    AsyncSceneLoader loader;
+    loader.prefetch = false;
+    loader.renderCopies = true;
+    loader.request(0, Screen{64, 48}, BackgroundType::DESERT);
+    waitForLoader(loader);
+    int index = -1;
+    RenderCopy copy;
+    std::unique_ptr<Scene> scene = loader.takeReady(index, nullptr, nullptr, &copy);
+    ASSERT_NE(scene, nullptr);
+    ASSERT_NE(copy.scene, nullptr);
+    EXPECT_EQ(copy.scene->entities.size(), scene->entities.size());
+    EXPECT_EQ(copy.scene->backgroundType, scene->backgroundType);
+
+    // The copy is cached with its scene and counted against the budget.
+    const Scene* copyPointer = copy.scene.get();
+    const size_t alone = SceneCache::estimateBytes(*scene, TextureLod{}, MeshLod{});
+    loader.retire(0, std::move(scene), TextureLod{}, MeshLod{}, std::move(copy));
+    EXPECT_GT(loader.cacheStats().bytes, alone);
+    loader.request(0, Screen{64, 48}, BackgroundType::DESERT);
+    EXPECT_EQ(loader.status().stage, "Cached");
+    scene = loader.takeReady(index, nullptr, nullptr, &copy);
+    EXPECT_EQ(copy.scene.get(), copyPointer);
+
+    // While copies are wanted, a cached scene without one is loaded again.
+    loader.retire(0, std::move(scene), TextureLod{}, MeshLod{});
+    loader.request(0, Screen{64, 48}, BackgroundType::DESERT);
+    EXPECT_TRUE(loader.status().loading);
+    waitForLoader(loader);
+    scene = loader.takeReady(index, nullptr, nullptr, &copy);
+    ASSERT_NE(scene, nullptr);
+    EXPECT_NE(copy.scene, nullptr);
+}
+
+// ============================================================================
+// SceneSnapshot Tests
+// ============================================================================
+
+TEST(SceneSnapshotTest, RestoresSceneAndFollowsSources) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "render3d_scene_snapshot_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::filesystem::path fixtures = std::filesystem::path(__FILE__).parent_path() / "fixtures";
+    std::filesystem::copy_file(fixtures / "textured_quad.obj", dir / "textured_quad.obj");
+    std::filesystem::copy_file(fixtures / "textured_quad.mtl", dir / "textured_quad.mtl");
+
+    std::string yamlPath = (dir / "scene.yaml").string();
+    std::ofstream(yamlPath) <<
+        "scene:\n"
+        "  name: \"Snapshot\"\n"
+        "  camera:\n"
+        "    position: [1, 2, 3]\n"
+        "  solids:\n"
+        "    - type: torus\n"
+        "      u_steps: 8\n"
+        "      v_steps: 4\n"
+        "      position: [10, 0, 0]\n"
+        "    - type: obj_loader\n"
+        "      file: \"" + (dir / "textured_quad.obj").generic_string() + "\"\n"
+        "      light:\n"
+        "        type: point\n"
+        "        intensity: 2.5\n";
+
+    auto parsed = SceneLoader::loadFromFile(yamlPath, Screen{64, 48});
+    ASSERT_NE(parsed, nullptr);
+    ASSERT_TRUE(std::filesystem::exists(SceneSnapshot::pathFor(yamlPath)));
+
+    SceneDescription description;
+    std::vector<CookedSolid> cooked;
+    ASSERT_TRUE(SceneSnapshot::load(yamlPath, description, cooked));
+    ASSERT_EQ(description.solids.size(), 2u);
+    EXPECT_EQ(description.name.value_or(""), "Snapshot");
+    EXPECT_FLOAT_EQ(description.solids[0].param("u_steps", 0), 8.0f);
+    ASSERT_TRUE(description.solids[1].light.has_value());
+    EXPECT_FLOAT_EQ(description.solids[1].light->intensity.value_or(0), 2.5f);
+    EXPECT_TRUE(cooked[0].mesh.empty());
+    EXPECT_FALSE(cooked[1].mesh.empty());
+    ASSERT_EQ(cooked[1].materialLibraries.size(), 1u);
+
+    auto restored = SceneLoader::loadFromFile(yamlPath, Screen{64, 48});
+    ASSERT_NE(restored, nullptr);
+    EXPECT_EQ(restored->name, "Snapshot");
+    EXPECT_FLOAT_EQ(restored->camera.pos.z, 3.0f);
+    ASSERT_EQ(restored->entities.size(), parsed->entities.size());
+    for (size_t i = 0; i < parsed->entities.size(); ++i) {
+        const MeshComponent* a = parsed->registry.meshes().get(parsed->entities[i]);
+        const MeshComponent* b = restored->registry.meshes().get(restored->entities[i]);
+        ASSERT_NE(a, nullptr);
+        ASSERT_NE(b, nullptr);
+        EXPECT_EQ(a->vertexData.size(), b->vertexData.size());
+        EXPECT_EQ(a->faceData.size(), b->faceData.size());
+        EXPECT_FLOAT_EQ(a->radius, b->radius);
+    }
+    EXPECT_EQ(restored->registry.lights().size(), 1u);
+    // The restored faces resolve their materials by key.
+    const MaterialComponent* material = restored->registry.materials().get(restored->entities[1]);
+    const MeshComponent* quad = restored->registry.meshes().get(restored->entities[1]);
+    ASSERT_NE(material, nullptr);
+    ASSERT_FALSE(quad->faceData.empty());
+    EXPECT_EQ(material->materials.count(quad->faceData[0].face.materialKey), 1u);
+
+    // Editing a material library the model uses invalidates the snapshot.
+    std::ofstream(dir / "textured_quad.mtl", std::ios::app) << "Ns 12\n";
+    EXPECT_FALSE(SceneSnapshot::load(yamlPath, description, cooked));
+
+    SceneSnapshot::setEnabled(false);
+    EXPECT_NE(SceneLoader::loadFromFile(yamlPath, Screen{64, 48}), nullptr);
+    SceneSnapshot::setEnabled(true);
+    EXPECT_FALSE(SceneSnapshot::load(yamlPath, description, cooked));
+
+    ASSERT_NE(SceneLoader::loadFromFile(yamlPath, Screen{64, 48}), nullptr);
+    EXPECT_TRUE(SceneSnapshot::load(yamlPath, description, cooked));
+}
+
+// ============================================================================
+// MeshLibrary Tests
+// ============================================================================
+
+TEST(MeshLibraryTest, RepeatedSolidsBuildOnce) {
+    SceneDescription description;
+    for (float u : {8.0f, 8.0f, 12.0f}) {
+        SolidDescription torus;
+        torus.type = "torus";
+        torus.params["u_steps"] = u;
+        description.solids.push_back(torus);
+    }
+    SolidDescription cube;
+    cube.type = "cube";
+    description.solids.push_back(cube);
+    description.solids.push_back(cube);
+    description.solids.back().emissiveColor = slib::vec3{1.0f, 0.0f, 0.0f};
+
+    EXPECT_EQ(MeshLibrary::keyFor(description.solids[0]), MeshLibrary::keyFor(description.solids[1]));
+    EXPECT_NE(MeshLibrary::keyFor(description.solids[0]), MeshLibrary::keyFor(description.solids[2]));
+
+    auto scene = SceneLoader::build(description, Screen{64, 48});
+    ASSERT_NE(scene, nullptr);
+    ASSERT_EQ(scene->entities.size(), 5u);
+
+    MeshLibrary::Stats stats = SceneLoader::lastMeshStats();
+    EXPECT_EQ(stats.meshes, 3u);
+    EXPECT_EQ(stats.references, 5u);
+
+    const MeshComponent* first = scene->registry.meshes().get(scene->entities[0]);
+    const MeshComponent* repeat = scene->registry.meshes().get(scene->entities[1]);
+    const MeshComponent* cubeMesh = scene->registry.meshes().get(scene->entities[3]);
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(repeat, nullptr);
+    ASSERT_NE(cubeMesh, nullptr);
+    EXPECT_EQ(first->vertexData.size(), repeat->vertexData.size());
+    EXPECT_EQ(first->faceData.size(), repeat->faceData.size());
+
+    const size_t torusBytes = MeshLibrary::meshBytes(*first);
+    const size_t cubeBytes = MeshLibrary::meshBytes(*cubeMesh);
+    const size_t otherTorusBytes = MeshLibrary::meshBytes(*scene->registry.meshes().get(scene->entities[2]));
+    EXPECT_EQ(stats.uniqueBytes, torusBytes + otherTorusBytes + cubeBytes);
+    EXPECT_EQ(stats.referencedBytes, 2 * torusBytes + otherTorusBytes + 2 * cubeBytes);
+}
+
+// ============================================================================
+// Instancing Tests
+// ============================================================================
+
+TEST(InstancingTest, LayoutsPlaceDeterministically) {
+    Instancing::Options grid;
+    grid.gridCount = {3, 1, 2};
+    grid.spacing = {10.0f, 0.0f, 20.0f};
+    std::vector<InstancePlacement> cells = Instancing::place(grid);
+    ASSERT_EQ(cells.size(), 6u);
+    EXPECT_FLOAT_EQ(cells[5].offset.x, 20.0f);
+    EXPECT_FLOAT_EQ(cells[5].offset.z, 20.0f);
+
+    Instancing::Options ring;
+    ring.layout = Instancing::Layout::Ring;
+    ring.count = 4;
+    ring.radius = 100.0f;
+    std::vector<InstancePlacement> around = Instancing::place(ring);
+    ASSERT_EQ(around.size(), 4u);
+    EXPECT_NEAR(around[1].offset.x, 0.0f, 1e-4f);
+    EXPECT_NEAR(around[1].offset.z, 100.0f, 1e-4f);
+
+    Instancing::Options random;
+    random.layout = Instancing::Layout::Random;
+    random.count = 50;
+    random.boxMin = {-5.0f, 0.0f, -5.0f};
+    random.boxMax = {5.0f, 1.0f, 5.0f};
+    random.scaleRange = {0.5f, 2.0f};
+    random.seed = 7;
+    std::vector<InstancePlacement> a = Instancing::place(random);
+    std::vector<InstancePlacement> b = Instancing::place(random);
+    random.seed = 8;
+    std::vector<InstancePlacement> c = Instancing::place(random);
+    ASSERT_EQ(a.size(), 50u);
+    bool differs = false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        EXPECT_EQ(a[i].offset.x, b[i].offset.x);
+        EXPECT_EQ(a[i].scale, b[i].scale);
+        EXPECT_GE(a[i].offset.x, -5.0f);
+        EXPECT_LT(a[i].offset.x, 5.0f);
+        EXPECT_GE(a[i].scale, 0.5f);
+        EXPECT_LT(a[i].scale, 2.0f);
+        differs = differs || a[i].offset.x != c[i].offset.x;
+    }
+    EXPECT_TRUE(differs);
+}
+
+TEST(InstancingTest, YamlBlocksSpawnAndMerge) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "render3d_instancing_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::string yamlPath = (dir / "scene.yaml").string();
+    std::ofstream(yamlPath) <<
+        "scene:\n"
+        "  instances:\n"
+        "    - solid:\n"
+        "        type: icosahedron\n"
+        "        name: \"Moon\"\n"
+        "        position: [0, 0, -500]\n"
+        "        orbit:\n"
+        "          radius: 50\n"
+        "      layout: ring\n"
+        "      count: 8\n"
+        "      radius: 200\n"
+        "      phase_step: 0.5\n"
+        "    - solid:\n"
+        "        type: cube\n"
+        "        zoom: 2\n"
+        "      layout: grid\n"
+        "      count: [10, 1, 10]\n"
+        "      spacing: [40, 0, 40]\n"
+        "      merge: true\n";
+
+    SceneDescription description = SceneLoader::parseFile(yamlPath);
+    ASSERT_EQ(description.solids.size(), 9u);
+    EXPECT_EQ(description.solids[3].name.value_or(""), "Moon#3");
+    ASSERT_TRUE(description.solids[3].orbit.has_value());
+    EXPECT_FLOAT_EQ(description.solids[3].orbit->initialPhase, 1.5f);
+    EXPECT_NEAR(description.solids[2].position->z, -300.0f, 1e-3f);
+    EXPECT_EQ(description.solids[8].merged.size(), 100u);
+
+    auto scene = SceneLoader::build(description, Screen{64, 48});
+    ASSERT_NE(scene, nullptr);
+    ASSERT_EQ(scene->entities.size(), 9u);
+
+    MeshComponent cube;
+    MaterialComponent cubeMaterial;
+    PrefabFactory::buildCube(cube, cubeMaterial);
+    const MeshComponent* merged = scene->registry.meshes().get(scene->entities[8]);
+    ASSERT_NE(merged, nullptr);
+    EXPECT_EQ(merged->vertexData.size(), 100 * cube.vertexData.size());
+    EXPECT_EQ(merged->faceData.size(), 100 * cube.faceData.size());
+    // The last cell sits 360 world units out; the entity's zoom of 2 halves that.
+    const VertexData& last = merged->vertexData.back();
+    const VertexData& source = cube.vertexData.back();
+    EXPECT_FLOAT_EQ(last.vertex.x, source.vertex.x + 180.0f);
+    EXPECT_EQ(merged->faceData.back().face.vertexIndices[0],
+              cube.faceData.back().face.vertexIndices[0] + 99 * static_cast<int>(cube.vertexData.size()));
+
+    MeshLibrary::Stats stats = SceneLoader::lastMeshStats();
+    EXPECT_EQ(stats.meshes, 2u);
+    EXPECT_EQ(stats.references, 9u);
+}
+
+TEST(InstancingTest, EntityStressSceneKeepsInstancesSeparate) {
+    std::filesystem::path yaml = std::filesystem::path(__FILE__).parent_path().parent_path() /
+        "resources" / "scenes" / "instances_entities.yaml";
+    SceneDescription description = SceneLoader::parseFile(yaml.string());
+
+    ASSERT_EQ(description.solids.size(), 10004u);
+    for (size_t i = 0; i < 10000; ++i) {
+        const SolidDescription& tile = description.solids[i];
+        ASSERT_EQ(tile.type, "plane");
+        EXPECT_TRUE(tile.merged.empty());
+        EXPECT_TRUE(tile.angles.has_value());
+        ASSERT_TRUE(tile.orbit.has_value());
+    }
+    EXPECT_NE(description.solids[0].orbit->initialPhase, description.solids[1].orbit->initialPhase);
+}
+
+// ============================================================================
+// Hot Reload Tests
+// ============================================================================
+
+TEST(FileWatcherTest, ReportsReplacedFileOnce) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "render3d_watcher_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::string watchedPath = (dir / "scene.yaml").string();
+    std::ofstream(watchedPath) << "scene:\n";
+    std::ofstream((dir / "other.yaml").string()) << "scene:\n";
+
+    FileWatcher watcher;
+    watcher.setFiles({watchedPath});
+    EXPECT_TRUE(watcher.poll().empty());
+
+    // Saved the way editors do: a temporary file renamed over the original.
+    // Stamp polling needs the modification time to move, so step it too.
+    std::ofstream((dir / "scene.yaml.tmp").string()) << "scene:\n  name: edited\n";
+    std::filesystem::rename(dir / "scene.yaml.tmp", watchedPath);
+    std::filesystem::last_write_time(watchedPath, std::filesystem::last_write_time(watchedPath) +
+                                                      std::chrono::seconds(2));
+    std::ofstream((dir / "other.yaml").string()) << "scene:\n  name: other\n";
+
+    std::vector<std::string> changed;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while (changed.empty() && std::chrono::steady_clock::now() < deadline) {
+        changed = watcher.poll();
+    }
+    ASSERT_EQ(changed.size(), 1u);
+    EXPECT_EQ(changed[0], watchedPath);
+
+    const auto settle = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+    while (std::chrono::steady_clock::now() < settle) {
+        EXPECT_TRUE(watcher.poll().empty());
+    }
+}
+
+TEST(SceneReloaderTest, PatchesInPlaceAndRebuildsOnlyChangedGeometry) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "render3d_reloader_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::string yamlPath = (dir / "scene.yaml").string();
+    std::ofstream(yamlPath) <<
+        "scene:\n"
+        "  solids:\n"
+        "    - type: torus\n"
+        "      u_steps: 8\n"
+        "      v_steps: 4\n"
+        "      position: [0, 0, -500]\n"
+        "    - type: icosahedron\n"
+        "      light:\n"
+        "        type: point\n"
+        "        intensity: 1.0\n"
+        "    - type: icosahedron\n";
+
+    auto scene = SceneLoader::build(SceneLoader::parseFile(yamlPath), Screen{64, 48});
+    ASSERT_NE(scene, nullptr);
+    SceneReloader reloader;
+    reloader.track(yamlPath, *scene);
+    const std::vector<Entity> entities = scene->entities;
+    const VertexData* torusVertices = scene->registry.meshes().get(entities[0])->vertexData.data();
+    const size_t icosahedronFaces = scene->registry.meshes().get(entities[2])->faceData.size();
+
+    std::ofstream(yamlPath) <<
+        "scene:\n"
+        "  solids:\n"
+        "    - type: torus\n"
+        "      u_steps: 8\n"
+        "      v_steps: 4\n"
+        "      position: [10, 0, -500]\n"
+        "    - type: icosahedron\n"
+        "      light:\n"
+        "        type: point\n"
+        "        intensity: 3.0\n"
+        "    - type: torus\n"
+        "      u_steps: 12\n"
+        "      v_steps: 4\n"
+        "    - type: icosahedron\n";
+
+    SceneReloader::Result result = reloader.apply(SceneLoader::parseFile(yamlPath), *scene);
+    EXPECT_TRUE(result.error.empty()) << result.error;
+    EXPECT_EQ(result.patched, 2u);
+    EXPECT_EQ(result.rebuilt, 1u);
+    EXPECT_EQ(result.added, 1u);
+    ASSERT_EQ(scene->entities.size(), 4u);
+    for (size_t i = 0; i < entities.size(); ++i) {
+        EXPECT_EQ(scene->entities[i], entities[i]);
+    }
+
+    // Patched in place: same mesh storage, new position and light.
+    EXPECT_EQ(scene->registry.meshes().get(entities[0])->vertexData.data(), torusVertices);
+    EXPECT_FLOAT_EQ(scene->registry.transforms().get(entities[0])->position.x, 10.0f);
+    ASSERT_NE(scene->registry.lights().get(entities[1]), nullptr);
+    EXPECT_FLOAT_EQ(scene->registry.lights().get(entities[1])->light.intensity, 3.0f);
+    EXPECT_NE(scene->registry.meshes().get(entities[2])->faceData.size(), icosahedronFaces);
+    EXPECT_EQ(scene->registry.meshes().get(scene->entities[3])->faceData.size(), icosahedronFaces);
+
+    // A bad solid type reports an error and leaves that entity as it was.
+    SceneDescription broken = SceneLoader::parseFile(yamlPath);
+    broken.solids[2].type = "dodecahedron";
+    result = reloader.apply(broken, *scene);
+    EXPECT_FALSE(result.error.empty());
+    EXPECT_NE(scene->registry.meshes().get(entities[2]), nullptr);
+
+    std::ofstream(yamlPath) <<
+        "scene:\n"
+        "  solids:\n"
+        "    - type: torus\n"
+        "      u_steps: 8\n"
+        "      v_steps: 4\n";
+    result = reloader.apply(SceneLoader::parseFile(yamlPath), *scene);
+    EXPECT_EQ(result.removed, 3u);
+    EXPECT_EQ(result.rebuilt, 1u);  // its position key went away
+    ASSERT_EQ(scene->entities.size(), 1u);
+    EXPECT_FALSE(scene->registry.lights().has(entities[1]));
+    EXPECT_FALSE(scene->registry.meshes().has(entities[2]));
+}
+
+// ============================================================================
+// TextureCache Tests
+// ============================================================================
+
+TEST(TextureCacheTest, DecodesEachFileOnce) {
+    TextureCache::clear();
+    std::filesystem::path png = std::filesystem::path(__FILE__).parent_path().parent_path() /
+        "resources" / "checker-map_tho.png";
+
+    auto first = TextureCache::acquire(png.string());
+    auto second = TextureCache::acquire(png.string());
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first, second);
+
+    TextureCache::Stats stats = TextureCache::stats();
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_GT(stats.bytes, 0u);
+}
+
+TEST(TextureCacheTest, FilterIsPartOfKey) {
+    TextureCache::clear();
+    std::filesystem::path png = std::filesystem::path(__FILE__).parent_path().parent_path() /
+        "resources" / "checker-map_tho.png";
+
+    auto nearest = TextureCache::acquire(png.string(), TextureFilter::NEIGHBOUR);
+    auto bilinear = TextureCache::acquire(png.string(), TextureFilter::BILINEAR);
+    EXPECT_NE(nearest, bilinear);
+    EXPECT_EQ(TextureCache::stats().entries, 2u);
+
+    nearest.reset();
+    bilinear.reset();
+    TextureCache::purgeUnused();
+    EXPECT_EQ(TextureCache::stats().entries, 0u);
+    EXPECT_EQ(TextureCache::stats().bytes, 0u);
+}
+
+TEST(TextureCacheTest, MissingFileIsNotCached) {
+    TextureCache::clear();
+    EXPECT_EQ(TextureCache::acquire("does/not/exist.png"), nullptr);
+    EXPECT_EQ(TextureCache::stats().entries, 0u);
+}
+
+TEST(TextureCacheTest, SceneBuildRetainsNoPixels) {
+    TextureCache::clear();
+    SceneDescription description;
+    SolidDescription quad;
+    quad.type = "obj_loader";
+    quad.file = (std::filesystem::path(__FILE__).parent_path() / "fixtures" / "textured_quad.obj").string();
+    quad.useMeshCache = false;
+    description.solids.push_back(quad);
+
+    auto scene = SceneLoader::build(description, Screen{64, 48});
+    ASSERT_NE(scene, nullptr);
+    EXPECT_EQ(TextureCache::stats().misses, 1u);
+    EXPECT_EQ(TextureCache::stats().entries, 0u);
+    EXPECT_EQ(TextureCache::stats().bytes, 0u);
+
+    // The material kept its own copy.
+    const MaterialComponent* material = scene->registry.materials().get(scene->entities[0]);
+    ASSERT_NE(material, nullptr);
+    size_t textureBytes = 0;
+    for (const auto& [key, properties] : material->materials) {
+        textureBytes += Mipmap::byteSize(properties.map_Kd);
+    }
+    EXPECT_GT(textureBytes, 0u);
+}
+
+// ============================================================================
+// Mipmap / TextureLod Tests
+// ============================================================================
+
+TEST(MipmapTest, ChainHalvesWithBoxFilter) {
+    // 5x2 image: red channel = column index * 10, other channels constant.
+    std::vector<unsigned char> pixels;
+    for (int y = 0; y < 2; ++y) {
+        for (int x = 0; x < 5; ++x) {
+            pixels.insert(pixels.end(), {static_cast<unsigned char>(x * 10), 20, 30, 255});
+        }
+    }
+    Texture base(5, 2, pixels);
+    base.setFilter(TextureFilter::BILINEAR);
+
+    EXPECT_EQ(Mipmap::levelCount(5, 2), 3);
+    std::vector<Texture> chain = Mipmap::buildChain(base);
+    ASSERT_EQ(chain.size(), 2u);
+    EXPECT_EQ(base.data, pixels);
+
+    EXPECT_EQ(chain[0].w, 2);
+    EXPECT_EQ(chain[0].h, 1);
+    EXPECT_EQ(chain[0].data[0], 5);   // columns 0-1
+    EXPECT_EQ(chain[0].data[4], 30);  // odd edge: columns 2-4
+    EXPECT_EQ(chain[0].data[5], 20);
+    EXPECT_EQ(chain[1].w, 1);
+    EXPECT_EQ(chain[1].h, 1);
+    EXPECT_EQ(chain[1].data[0], 18);
+
+    EXPECT_TRUE(Mipmap::buildChain(base, 4).empty());
+}
+
+TEST(TextureLodTest, BindsSmallerLevelsWithDistance) {
+    Scene scene(Screen{200, 200});
+    Entity entity = scene.createEntity();
+    TransformComponent transform;
+    scene.registry.transforms().add(entity, transform);
+    MeshComponent mesh;
+    mesh.radius = 1.0f;
+    scene.registry.meshes().add(entity, mesh);
+    MaterialComponent materials;
+    materials.materials["base"].map_Kd = Texture(256, 256, std::vector<unsigned char>(256 * 256 * 4, 128));
+    materials.materials["tiny"].map_Kd = Texture(8, 8, std::vector<unsigned char>(8 * 8 * 4, 128));
+    scene.registry.materials().add(entity, materials);
+
+    TextureLod lod;
+    lod.build(scene);
+    EXPECT_EQ(lod.stats().textures, 1u);
+    auto boundWidth = [&]() {
+        return scene.registry.materials().get(entity)->materials["base"].map_Kd.w;
+    };
+
+    scene.camera.pos = {0.0f, 0.0f, 2.0f};
+    lod.update(scene);
+    EXPECT_EQ(boundWidth(), 256);
+
+    scene.camera.pos = {0.0f, 0.0f, 400.0f};
+    lod.update(scene);
+    EXPECT_LT(boundWidth(), 16);
+    EXPECT_EQ(lod.stats().reduced, 1u);
+    EXPECT_LT(lod.stats().boundBytes, lod.stats().fullBytes);
+
+    lod.enabled = false;
+    lod.update(scene);
+    EXPECT_EQ(boundWidth(), 256);
+    EXPECT_EQ(lod.stats().reduced, 0u);
+}
+
+TEST(TextureLodTest, RebuildsOnlyTheGivenEntities) {
+    Scene scene(Screen{200, 200});
+    auto addTextured = [&scene](int size) {
+        Entity entity = scene.createEntity();
+        scene.registry.transforms().add(entity, TransformComponent{});
+        MeshComponent mesh;
+        mesh.radius = 1.0f;
+        scene.registry.meshes().add(entity, mesh);
+        MaterialComponent materials;
+        materials.materials["base"].map_Kd =
+            Texture(size, size, std::vector<unsigned char>(size * size * 4, 128));
+        scene.registry.materials().add(entity, materials);
+        return entity;
+    };
+    Entity kept = addTextured(256);
+    Entity replaced = addTextured(256);
+    Entity removed = addTextured(128);
+
+    TextureLod lod;
+    lod.build(scene);
+    ASSERT_EQ(lod.stats().textures, 3u);
+
+    scene.registry.materials().get(replaced)->materials["base"].map_Kd =
+        Texture(64, 64, std::vector<unsigned char>(64 * 64 * 4, 128));
+    scene.registry.destroyEntity(removed);
+    scene.entities.pop_back();
+    Entity added = addTextured(128);
+    lod.rebuild(scene, {replaced, added});
+
+    TextureLod fresh;
+    fresh.build(scene);
+    EXPECT_EQ(lod.stats().textures, 3u);
+    EXPECT_EQ(lod.stats().fullBytes, fresh.stats().fullBytes);
+    EXPECT_EQ(lod.stats().chainBytes, fresh.stats().chainBytes);
+    EXPECT_EQ(lod.stats().boundBytes, lod.stats().fullBytes);
+
+    scene.camera.pos = {0.0f, 0.0f, 400.0f};
+    lod.update(scene);
+    EXPECT_EQ(lod.stats().reduced, 3u);
+    lod.restore(scene);
+    EXPECT_EQ(scene.registry.materials().get(kept)->materials["base"].map_Kd.w, 256);
+    EXPECT_EQ(scene.registry.materials().get(replaced)->materials["base"].map_Kd.w, 64);
+    EXPECT_EQ(scene.registry.materials().get(added)->materials["base"].map_Kd.w, 128);
+}
+
+// ============================================================================
+// PpmWriter Tests
+// ============================================================================
+
+TEST(PpmWriterTest, WritesRgbRowsTopToBottom) {
+    const auto path = std::filesystem::temp_directory_path() / "r3d_ppm_writer_test.ppm";
+    const uint32_t pixels[] = {0xff102030u, 0x80405060u, 0xff708090u, 0x00a0b0c0u};
+    ASSERT_TRUE(PpmWriter::write(path.string(), pixels, 2, 2));
+
+    std::ifstream in(path, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const std::string header = "P6\n2 2\n255\n";
+    ASSERT_EQ(data.size(), header.size() + 12);
+    EXPECT_EQ(data.substr(0, header.size()), header);
+    const unsigned char expected[] = {0x10, 0x20, 0x30, 0x40, 0x50, 0x60,
+                                      0x70, 0x80, 0x90, 0xa0, 0xb0, 0xc0};
+    for (size_t i = 0; i < sizeof(expected); ++i) {
+        EXPECT_EQ(static_cast<unsigned char>(data[header.size() + i]), expected[i]);
+    }
+    std::filesystem::remove(path);
+
+    EXPECT_FALSE(PpmWriter::write((path.parent_path() / "missing_dir" / "x.ppm").string(),
+                                  pixels, 2, 2));
+}
+
+// ============================================================================
+// MemoryReport Tests
+// ============================================================================
+
+namespace {
+    // A scene importing a copy of the textured quad fixture, for the tests of
+    // the modes that write JSON to stdout. Returns the YAML path.
+    std::string writeImportScene(const std::string& dirName) {
+        std::filesystem::path dir = std::filesystem::temp_directory_path() / dirName;
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        std::filesystem::path fixtures = std::filesystem::path(__FILE__).parent_path() / "fixtures";
+        std::filesystem::copy_file(fixtures / "textured_quad.obj", dir / "textured_quad.obj");
+        std::filesystem::copy_file(fixtures / "textured_quad.mtl", dir / "textured_quad.mtl");
+        std::string yamlPath = (dir / "scene.yaml").string();
+        std::ofstream(yamlPath) <<
+            "scene:\n"
+            "  solids:\n"
+            "    - type: obj_loader\n"
+            "      file: \"" + (dir / "textured_quad.obj").generic_string() + "\"\n";
+        return yamlPath;
+    }
+}
+
+
+TEST(MemoryReportTest, AttributesBytesAndWritesJson) {
+    SceneDescription description;
+    SolidDescription cube;
+    cube.type = "cube";
+    cube.name = "box \"one\"";
+    description.solids.push_back(cube);
+    SolidDescription lamp;
+    lamp.type = "icosahedron";
+    lamp.light = LightDescription{};
+    description.solids.push_back(lamp);
+    auto scene = SceneLoader::build(description, Screen{64, 48});
+    ASSERT_NE(scene, nullptr);
+    scene->name = "Memory";
+
+    MeshLod meshLod;
+    MemoryReport::Report report = MemoryReport::collect(*scene, nullptr, &meshLod);
+    ASSERT_EQ(report.entities.size(), 2u);
+    const MemoryReport::EntityBytes& box = report.entities[0];
+    const MeshComponent* mesh = scene->registry.meshes().get(scene->entities[0]);
+    EXPECT_EQ(box.name, "box \"one\"");
+    EXPECT_EQ(box.vertices, mesh->vertexData.capacity() * sizeof(VertexData));
+    EXPECT_GE(box.faces, mesh->faceData.size() * sizeof(FaceData));
+    EXPECT_GE(box.indices, mesh->faceData.size() * 3 * sizeof(int));
+    EXPECT_EQ(box.light, 0u);
+    EXPECT_GT(report.entities[1].light, 0u);
+
+    size_t entityBytes = 0;
+    for (const auto& entity : report.entities) {
+        entityBytes += entity.total();
+    }
+    EXPECT_EQ(report.entityBytes, entityBytes);
+    ASSERT_FALSE(report.resources.empty());
+    EXPECT_EQ(report.resources[0].name, "Framebuffer");
+    EXPECT_EQ(report.resources[0].bytes, 64u * 48u * sizeof(scene->pixels[0]));
+    EXPECT_EQ(report.resources.back().name, "Mesh LOD levels");
+
+    const std::string json = MemoryReport::toJson(report);
+    EXPECT_NE(json.find("\"scene\": \"Memory\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\": \"box \\\"one\\\"\""), std::string::npos);
+    EXPECT_NE(json.find("\"totalBytes\": " + std::to_string(report.total())), std::string::npos);
+    EXPECT_NE(json.find("\"vertexBytes\": " + std::to_string(box.vertices)), std::string::npos);
+    EXPECT_EQ(std::count(json.begin(), json.end(), '{'), std::count(json.begin(), json.end(), '}'));
+}
+
+TEST(MemoryReportTest, CountsTheHdrPanoramaOfItsOwnScene) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "render3d_memory_hdr_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    // Flat (not run-length encoded) Radiance files of width x 2 grey texels.
+    auto writeHdr = [&dir](const std::string& name, int width) {
+        std::ofstream file(dir / name, std::ios::binary);
+        file << "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y 2 +X " << width << "\n";
+        for (int i = 0; i < width * 2; ++i) {
+            file.write("\x80\x80\x80\x81", 4);
+        }
+        return (dir / name).string();
+    };
+    auto sceneWith = [](const std::string& hdrPath) {
+        SceneDescription description;
+        BackgroundDescription background;
+        background.type = BackgroundType::HDR_PANORAMA;
+        background.hdrPath = hdrPath;
+        background.hdrCache = false;
+        description.background = background;
+        return SceneLoader::build(description, Screen{16, 12});
+    };
+    auto wide = sceneWith(writeHdr("wide.hdr", 4));
+    // Loaded last, like a neighbour prefetched after the scene on screen.
+    auto narrow = sceneWith(writeHdr("narrow.hdr", 2));
+    ASSERT_NE(wide, nullptr);
+    ASSERT_NE(narrow, nullptr);
+
+    auto hdrBytes = [](Scene& scene) {
+        for (const auto& resource : MemoryReport::collect(scene).resources) {
+            if (resource.name == "HDR panorama") {
+                return resource.bytes;
+            }
+        }
+        return size_t{0};
+    };
+    EXPECT_EQ(hdrBytes(*wide), 4u * 2u * 3u * sizeof(float));
+    EXPECT_EQ(hdrBytes(*narrow), 2u * 2u * 3u * sizeof(float));
+    EXPECT_EQ(BackgroundFactory::hdrStatsFor(*wide).width, 4);
+
+    // Another background replaces the record.
+    BackgroundFactory::setBackground(*wide, BackgroundFactory::create(BackgroundType::DESERT));
+    EXPECT_TRUE(BackgroundFactory::hdrStatsFor(*wide).path.empty());
+}
+
+// `--scene sponza --memory-report -`: loading the scene may not print to
+// stdout ahead of the report.
+TEST(MemoryReportTest, StdoutHoldsOnlyTheReportWhenTheSceneImportsModels) {
+    const std::string yamlPath = writeImportScene("render3d_memory_stdout_test");
+
+    SceneSnapshot::setEnabled(false);
+    testing::internal::CaptureStdout();
+    auto scene = SceneLoader::loadFromFile(yamlPath, Screen{32, 24});
+    std::string json;
+    if (scene) {
+        json = MemoryReport::toJson(MemoryReport::collect(*scene));
+        std::fwrite(json.data(), 1, json.size(), stdout);
+    }
+    std::fflush(stdout);
+    const std::string out = testing::internal::GetCapturedStdout();
+    SceneSnapshot::setEnabled(true);
+
+    ASSERT_NE(scene, nullptr);
+    EXPECT_EQ(out, json);
+    EXPECT_EQ(out.front(), '{');
+}
+
+// ============================================================================
+// BenchReport Tests
+// ============================================================================
+
+TEST(BenchReportTest, SummarizesAndComparesAgainstBaseline) {
+    std::vector<double> samples;
+    for (int i = 100; i >= 1; --i) {
+        samples.push_back(i);
+    }
+    BenchReport::Summary summary = BenchReport::summarize(samples);
+    EXPECT_DOUBLE_EQ(summary.min, 1.0);
+    EXPECT_DOUBLE_EQ(summary.median, 50.0);
+    EXPECT_DOUBLE_EQ(summary.p95, 95.0);
+    EXPECT_DOUBLE_EQ(summary.p99, 99.0);
+    EXPECT_DOUBLE_EQ(summary.mean, 50.5);
+    EXPECT_DOUBLE_EQ(BenchReport::percentile({}, 50.0), 0.0);
+    EXPECT_DOUBLE_EQ(BenchReport::percentile({7.0}, 99.0), 7.0);
+
+    BenchReport::Report report;
+    report.frames = 100;
+    report.scenes.push_back({"cube \"a\"", 100, summary});
+    report.scenes.push_back({"torus", 100, summary});
+    report.scenes[1].counters.drawCalls = 300;
+
+    const std::string json = BenchReport::toJson(report);
+    EXPECT_NE(json.find("\"drawCalls\": 300"), std::string::npos);
+    std::map<std::string, BenchReport::Baseline> baseline;
+    ASSERT_TRUE(BenchReport::parseBaseline(json, baseline));
+    ASSERT_EQ(baseline.size(), 2u);
+    EXPECT_DOUBLE_EQ(baseline["cube \"a\""].median, 50.0);
+    EXPECT_DOUBLE_EQ(baseline["torus"].p95, 95.0);
+    EXPECT_FALSE(BenchReport::parseBaseline("{\"scenes\": [", baseline));
+
+    EXPECT_TRUE(BenchReport::compare(report, baseline, 0.1).empty());
+    report.scenes[1].frameMs.median = 56.0;  // +12%
+    auto regressions = BenchReport::compare(report, baseline, 0.1);
+    ASSERT_EQ(regressions.size(), 1u);
+    EXPECT_EQ(regressions[0].scene, "torus");
+    EXPECT_STREQ(regressions[0].metric, "median");
+    EXPECT_NEAR(regressions[0].ratio(), 1.12, 1e-9);
+    EXPECT_TRUE(BenchReport::compare(report, baseline, 0.15).empty());
+}
+
+// `3DEngine --bench > base.json` must give a file --baseline can read, so
+// importing models may not print to stdout.
+TEST(BenchReportTest, StdoutHoldsOnlyTheReportWhenScenesImportModels) {
+    const std::string yamlPath = writeImportScene("render3d_bench_stdout_test");
+
+    SceneSnapshot::setEnabled(false);
+    testing::internal::CaptureStdout();
+    // A parsed import, then the same model from the mesh cache.
+    const bool parsed = SceneLoader::loadFromFile(yamlPath, Screen{32, 24}) != nullptr;
+    const bool cached = SceneLoader::loadFromFile(yamlPath, Screen{32, 24}) != nullptr;
+    BenchReport::Report report;
+    report.scenes.push_back({"imported", 1, BenchReport::summarize({2.0})});
+    std::fputs(BenchReport::toJson(report).c_str(), stdout);
+    std::fflush(stdout);
+    const std::string out = testing::internal::GetCapturedStdout();
+    SceneSnapshot::setEnabled(true);
+
+    EXPECT_TRUE(parsed);
+    EXPECT_TRUE(cached);
+    std::map<std::string, BenchReport::Baseline> baseline;
+    ASSERT_TRUE(BenchReport::parseBaseline(out, baseline)) << out;
+    EXPECT_DOUBLE_EQ(baseline["imported"].median, 2.0);
+}
+
+// ============================================================================
+// Json Tests
+// ============================================================================
+
+TEST(JsonTest, AppendStringEscapesQuotesBackslashesAndControlCharacters) {
+    std::string out = "[";
+    Json::appendString(out, "a \"b\"\\c\td\n\xc3\xa9");
+    EXPECT_EQ(out, "[\"a \\\"b\\\"\\\\c\\u0009d\\u000a\xc3\xa9\"");
+}
+
+// ============================================================================
+// Profiler Tests
+// ============================================================================
+
+TEST(ProfilerTest, GathersNestedZonesFromEveryThreadIntoFrames) {
+    Profiler::clear();
+    Profiler::setThreadName("Test main");
+    Profiler::endFrame();  // starts the first measured frame
+    {
+        Profiler::Scope outer("outer");
+        Profiler::Scope inner("inner");
+    }
+    std::thread([] { Profiler::Scope worker("worker"); }).join();
+    Profiler::endFrame();
+
+    std::vector<Profiler::Frame> frames = Profiler::frames(1);
+    ASSERT_EQ(frames.size(), 1u);
+    const Profiler::Frame& frame = frames[0];
+    ASSERT_EQ(frame.zones.size(), 3u);
+    std::map<std::string, Profiler::Zone> zones;
+    for (const auto& zone : frame.zones)
+        zones[zone.name] = zone;
+    EXPECT_EQ(zones["outer"].depth, 0u);
+    EXPECT_EQ(zones["inner"].depth, 1u);
+    EXPECT_LE(zones["outer"].startNs, zones["inner"].startNs);
+    EXPECT_GE(zones["outer"].endNs, zones["inner"].endNs);
+    EXPECT_EQ(zones["outer"].thread, Profiler::threadId());
+    EXPECT_NE(zones["worker"].thread, Profiler::threadId());
+    EXPECT_GE(frame.endNs, zones["worker"].endNs);
+
+    Profiler::setEnabled(false);
+    { Profiler::Scope skipped("skipped"); }
+    Profiler::endFrame();
+    Profiler::setEnabled(true);
+    EXPECT_EQ(Profiler::frames().back().index, frame.index);
+
+    const std::string json = Profiler::toChromeTrace(frames);
+    EXPECT_NE(json.find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\": \"inner\", \"ph\": \"X\""), std::string::npos);
+    EXPECT_NE(json.find("\"args\": {\"name\": \"Test main\"}"), std::string::npos);
+    EXPECT_EQ(std::count(json.begin(), json.end(), '{'), std::count(json.begin(), json.end(), '}'));
+    Profiler::clear();
+    EXPECT_TRUE(Profiler::frames().empty());
+}
+
+// ============================================================================
+// RenderPipeline Tests
+// ============================================================================
+
+TEST(RenderPipelineTest, SwapsDrawnPixelsIntoTheFrontBuffer) {
+    SceneDescription description;
+    SolidDescription cube;
+    cube.type = "cube";
+    description.solids.push_back(cube);
+    auto scene = SceneLoader::build(description, Screen{32, 24});
+    ASSERT_NE(scene, nullptr);
+
+    Renderer renderer;
+    renderer.drawScene(*scene);
+    const std::vector<uint32_t> expected = scene->pixels;
+
+    RenderPipeline pipeline(renderer);
+    EXPECT_FALSE(pipeline.finish());
+    EXPECT_TRUE(pipeline.frontBuffer().empty());
+
+    for (int frame = 0; frame < 3; ++frame) {
+        std::fill(scene->pixels.begin(), scene->pixels.end(), 0x12345678u);
+        pipeline.submit(*scene);
+        EXPECT_TRUE(pipeline.inFlight());
+        ASSERT_TRUE(pipeline.finish());
+        EXPECT_FALSE(pipeline.inFlight());
+        EXPECT_EQ(pipeline.frontBuffer(), expected);
+        EXPECT_EQ(scene->pixels.size(), expected.size());
+    }
+    EXPECT_EQ(pipeline.stats().frames, 3u);
+
+    // Destroying the pipeline with a frame in flight waits for it.
+    pipeline.submit(*scene);
+}
+
+TEST(RenderPipelineTest, CopyOfUpdatedSceneDrawsTheSameFrame) {
+    SceneDescription description;
+    SolidDescription cube;
+    cube.type = "cube";
+    cube.rotationEnabled = true;
+    description.solids.push_back(cube);
+    SolidDescription lamp;
+    lamp.type = "icosahedron";
+    lamp.light = LightDescription{};
+    lamp.position = slib::vec3{0, 30, -20};
+    description.solids.push_back(lamp);
+    auto live = SceneLoader::build(description, Screen{32, 24});
+    ASSERT_NE(live, nullptr);
+    BackgroundFactory::setBackground(*live, BackgroundFactory::create(live->backgroundType));
+    auto copy = FrameState::clone(*live);
+    ASSERT_EQ(copy->entities.size(), live->entities.size());
+    EXPECT_NE(copy->registry.meshes().get(copy->entities[0])->vertexData.data(),
+              live->registry.meshes().get(live->entities[0])->vertexData.data());
+
+    // What a few frames of Scene::update and UI edits do to the live scene.
+    for (int frame = 0; frame < 5; ++frame) {
+        live->update(0.1f);
+    }
+    TransformComponent* moved = live->registry.transforms().get(live->entities[0]);
+    moved->position.xAngle += 30.0f;
+    moved->position.x += 2.0f;
+    live->registry.lights().get(live->entities[1])->light.intensity *= 0.5f;
+    live->camera.pos.x += 1.0f;
+    live->depthSortEnabled = !live->depthSortEnabled;
+
+    FrameState::copy(*live, *copy);
+    const TransformComponent* copied = copy->registry.transforms().get(copy->entities[0]);
+    EXPECT_FLOAT_EQ(copied->position.xAngle, moved->position.xAngle);
+    EXPECT_FLOAT_EQ(copied->position.x, moved->position.x);
+    EXPECT_FLOAT_EQ(copy->registry.lights().get(copy->entities[1])->light.intensity,
+                    live->registry.lights().get(live->entities[1])->light.intensity);
+    EXPECT_FLOAT_EQ(copy->camera.pos.x, live->camera.pos.x);
+    EXPECT_EQ(copy->depthSortEnabled, live->depthSortEnabled);
+
+    Renderer renderer;
+    renderer.drawScene(*live);
+    renderer.drawScene(*copy);
+    EXPECT_EQ(copy->pixels, live->pixels);
+
+    // The framebuffer follows the dynamic resolution of the live scene.
+    live->screen = Screen{16, 12};
+    live->pixels.resize(16 * 12);
+    FrameState::copy(*live, *copy);
+    EXPECT_EQ(copy->screen.width, 16);
+    EXPECT_EQ(copy->pixels.size(), 16u * 12u);
+}
+
+TEST(RenderPipelineTest, CopyFollowsHotReloadEntityByEntity) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "render3d_copy_reload_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::string yamlPath = (dir / "scene.yaml").string();
+    std::ofstream(yamlPath) <<
+        "scene:\n"
+        "  solids:\n"
+        "    - type: torus\n"
+        "      u_steps: 8\n"
+        "      v_steps: 4\n"
+        "    - type: icosahedron\n"
+        "      name: lamp\n"
+        "      light:\n"
+        "        type: point\n"
+        "    - type: cube\n"
+        "    - type: cube\n";
+
+    auto live = SceneLoader::build(SceneLoader::parseFile(yamlPath), Screen{32, 24});
+    ASSERT_NE(live, nullptr);
+    BackgroundFactory::setBackground(*live, BackgroundFactory::create(live->backgroundType));
+    SceneReloader reloader;
+    reloader.track(yamlPath, *live);
+    RenderCopy copy;
+    copy.scene = FrameState::clone(*live);
+    copy.meshLod.build(*copy.scene);
+    const Entity keptCopy = copy.scene->entities[1];
+    const VertexData* keptVertices =
+        copy.scene->registry.meshes().get(keptCopy)->vertexData.data();
+
+    // Rebuild the torus, rename the lamp and drop its light, remove a cube.
+    std::ofstream(yamlPath) <<
+        "scene:\n"
+        "  solids:\n"
+        "    - type: torus\n"
+        "      u_steps: 12\n"
+        "      v_steps: 4\n"
+        "    - type: icosahedron\n"
+        "      name: bulb\n"
+        "    - type: cube\n";
+    SceneReloader::Result result = reloader.apply(SceneLoader::parseFile(yamlPath), *live);
+    ASSERT_TRUE(result.error.empty()) << result.error;
+    ASSERT_EQ(result.rebuiltEntities.size(), 1u);
+    ASSERT_EQ(result.removedSlots.size(), 1u);
+
+    copy.meshLod.restore(*copy.scene);
+    const std::vector<Entity> rebuilt = FrameState::copyReload(*live, *copy.scene, result);
+    copy.meshLod.rebuild(*copy.scene, rebuilt);
+    ASSERT_EQ(rebuilt.size(), 1u);
+    EXPECT_EQ(rebuilt[0], copy.scene->entities[0]);
+
+    ASSERT_EQ(copy.scene->entities.size(), live->entities.size());
+    for (size_t i = 0; i < live->entities.size(); ++i) {
+        const Entity source = live->entities[i];
+        const Entity target = copy.scene->entities[i];
+        EXPECT_EQ(copy.scene->registry.meshes().get(target)->faceData.size(),
+                  live->registry.meshes().get(source)->faceData.size());
+        EXPECT_EQ(copy.scene->registry.names().get(target)->name,
+                  live->registry.names().get(source)->name);
+        EXPECT_EQ(copy.scene->registry.lights().get(target) != nullptr,
+                  live->registry.lights().get(source) != nullptr);
+    }
+    // Patched entities keep their meshes.
+    EXPECT_EQ(copy.scene->entities[1], keptCopy);
+    EXPECT_EQ(copy.scene->registry.meshes().get(keptCopy)->vertexData.data(), keptVertices);
+
+    Renderer renderer;
+    FrameState::copy(*live, *copy.scene);
+    renderer.drawScene(*live);
+    renderer.drawScene(*copy.scene);
+    EXPECT_EQ(copy.scene->pixels, live->pixels);
+}
+
+// ============================================================================
+// DynamicResolution Tests
+// ============================================================================
+
+TEST(DynamicResolutionTest, ShrinksToHoldTargetAndGrowsBackWithHysteresis) {
+    DynamicResolution resolution;
+    resolution.targetMs = 10.0f;
+    resolution.minScale = 0.5f;
+
+    // Disabled, nothing moves however slow the frames are.
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_FALSE(resolution.update(40.0));
+    }
+    EXPECT_FLOAT_EQ(resolution.scale(), 1.0f);
+
+    resolution.enabled = true;
+    // Draw time proportional to the pixel count: 16 ms at full size.
+    auto drawMs = [&resolution]() { return 16.0 * resolution.scale() * resolution.scale(); };
+    int changes = 0;
+    int lastChange = -DynamicResolution::kCooldownFrames;
+    for (int frame = 0; frame < 400; ++frame) {
+        if (resolution.update(drawMs())) {
+            EXPECT_GE(frame - lastChange, DynamicResolution::kCooldownFrames);
+            lastChange = frame;
+            ++changes;
+        }
+    }
+    EXPECT_GE(changes, 1);
+    EXPECT_LT(changes, 6);
+    EXPECT_LT(resolution.scale(), 1.0f);
+    EXPECT_GE(resolution.scale(), 0.5f);
+    EXPECT_LE(drawMs(), 10.0 * DynamicResolution::kUpperBand);
+    EXPECT_GE(drawMs(), 10.0 * DynamicResolution::kLowerBand * 0.9);
+
+    // Settled inside the band: no more changes.
+    const float settled = resolution.scale();
+    for (int frame = 0; frame < 200; ++frame) {
+        EXPECT_FALSE(resolution.update(drawMs()));
+    }
+    EXPECT_FLOAT_EQ(resolution.scale(), settled);
+
+    // Far too slow even at the bound: stops at minScale.
+    for (int frame = 0; frame < 400; ++frame) {
+        resolution.update(100.0);
+    }
+    EXPECT_FLOAT_EQ(resolution.scale(), 0.5f);
+    Screen half = resolution.screenFor(Screen{641, 400});
+    EXPECT_EQ(half.width, 320);
+    EXPECT_EQ(half.height, 200);
+
+    // Light scene again: back to full size, never above it.
+    for (int frame = 0; frame < 400; ++frame) {
+        resolution.update(1.0);
+    }
+    EXPECT_FLOAT_EQ(resolution.scale(), 1.0f);
+    Screen full = resolution.screenFor(Screen{641, 400});
+    EXPECT_EQ(full.width, 641);
+    EXPECT_EQ(full.height, 400);
+
+    resolution.enabled = false;
+    resolution.update(100.0);
+    EXPECT_FLOAT_EQ(resolution.scale(), 1.0f);
+}
+
+// ============================================================================
+// MeshSimplify / MeshLod Tests
+// ============================================================================
+
+TEST(MeshSimplifyTest, HalvesTorusKeepingMaterialsAndBounds) {
+    MeshComponent mesh;
+    MaterialComponent material;
+    PrefabFactory::buildTorus(mesh, material, 32, 16, 1.0f, 0.3f);
+    const size_t full = MeshSimplify::triangleCount(mesh);
+    ASSERT_GE(full, 1000u);
+
+    MeshComponent half = MeshSimplify::simplify(mesh, full / 2);
+    const size_t reached = MeshSimplify::triangleCount(half);
+    EXPECT_LE(reached, full / 2);
+    EXPECT_GT(reached, full / 3);
+    EXPECT_FLOAT_EQ(half.radius, mesh.radius);
+    EXPECT_LT(half.vertexData.size(), mesh.vertexData.size());
+
+    std::set<std::string> keys, keptKeys;
+    for (const auto& face : mesh.faceData) {
+        keys.insert(face.face.materialKey);
+    }
+    for (const auto& face : half.faceData) {
+        ASSERT_EQ(face.face.vertexIndices.size(), 3u);
+        for (int index : face.face.vertexIndices) {
+            ASSERT_GE(index, 0);
+            ASSERT_LT(index, static_cast<int>(half.vertexData.size()));
+        }
+        keptKeys.insert(face.face.materialKey);
+    }
+    EXPECT_EQ(keptKeys, keys);
+
+    // Collapsed vertices stay on the surface: within the tube of radius r.
+    for (const auto& vertex : half.vertexData) {
+        float ring = std::sqrt(vertex.vertex.x * vertex.vertex.x + vertex.vertex.y * vertex.vertex.y);
+        float tube = std::sqrt((ring - 1.0f) * (ring - 1.0f) + vertex.vertex.z * vertex.vertex.z);
+        EXPECT_NEAR(tube, 0.3f, 0.05f);
+    }
+}
+
+TEST(MeshLodTest, DropsLevelsWithDistance) {
+    Scene scene(Screen{200, 200});
+    MaterialComponent material;
+    MeshComponent torus;
+    PrefabFactory::buildTorus(torus, material, 32, 16, 1.0f, 0.3f);
+    torus.radius = 1.3f;
+    std::vector<Entity> entities;
+    for (int i = 0; i < 2; ++i) {
+        Entity entity = scene.createEntity();
+        scene.registry.transforms().add(entity, TransformComponent{});
+        scene.registry.meshes().add(entity, torus);
+        entities.push_back(entity);
+    }
+    const size_t full = MeshSimplify::triangleCount(torus);
+
+    MeshLod lod;
+    lod.build(scene);
+    ASSERT_EQ(lod.stats().meshes, 2u);
+    EXPECT_EQ(lod.stats().fullTriangles, 2 * full);
+    EXPECT_GT(lod.stats().levelBytes, 0u);
+    auto boundTriangles = [&]() {
+        return MeshSimplify::triangleCount(*scene.registry.meshes().get(entities[0]));
+    };
+
+    scene.camera.pos = {0.0f, 0.0f, 3.0f};
+    lod.update(scene);
+    EXPECT_EQ(boundTriangles(), full);
+    EXPECT_EQ(lod.stats().meshesPerLevel[0], 2u);
+    EXPECT_EQ(lod.stats().trianglesPerLevel[0], 2 * full);
+
+    scene.camera.pos = {0.0f, 0.0f, 400.0f};
+    lod.update(scene);
+    EXPECT_LT(boundTriangles(), full / 4);
+    EXPECT_EQ(lod.stats().reduced, 2u);
+    EXPECT_LT(lod.stats().boundTriangles, lod.stats().fullTriangles);
+    EXPECT_EQ(lod.stats().meshesPerLevel[0], 0u);
+
+    lod.enabled = false;
+    lod.update(scene);
+    EXPECT_EQ(boundTriangles(), full);
+    EXPECT_EQ(lod.stats().reduced, 0u);
+}
+
+TEST(MeshLodTest, SharesLevelsOnlyBetweenIdenticalMeshes) {
+    Scene scene(Screen{200, 200});
+    MaterialComponent material;
+    MeshComponent torus;
+    PrefabFactory::buildTorus(torus, material, 32, 16, 1.0f, 0.3f);
+    torus.radius = 1.3f;
+
+    // Same positions, different UVs and material assignment.
+    MeshComponent retextured = torus;
+    for (auto& vertex : retextured.vertexData) {
+        vertex.texCoord.x = 1.0f - vertex.texCoord.x;
+    }
+    for (auto& face : retextured.faceData) {
+        face.face.materialKey = "other";
+    }
+
+    std::vector<Entity> entities;
+    for (const MeshComponent* mesh : {&torus, &torus, &retextured}) {
+        Entity entity = scene.createEntity();
+        scene.registry.transforms().add(entity, TransformComponent{});
+        scene.registry.meshes().add(entity, *mesh);
+        entities.push_back(entity);
+    }
+
+    MeshLod lod;
+    lod.build(scene);
+    scene.camera.pos = {0.0f, 0.0f, 400.0f};
+    lod.update(scene);
+    ASSERT_EQ(lod.stats().reduced, 3u);
+
+    for (const auto& face : scene.registry.meshes().get(entities[0])->faceData) {
+        EXPECT_NE(face.face.materialKey, "other");
+    }
+    for (const auto& face : scene.registry.meshes().get(entities[2])->faceData) {
+        EXPECT_EQ(face.face.materialKey, "other");
+    }
+    EXPECT_EQ(scene.registry.meshes().get(entities[0])->vertexData.size(),
+              scene.registry.meshes().get(entities[1])->vertexData.size());
+}
+
+TEST(MeshLodTest, RebuildsOnlyTheGivenEntities) {
+    Scene scene(Screen{200, 200});
+    MaterialComponent material;
+    MeshComponent torus;
+    PrefabFactory::buildTorus(torus, material, 32, 16, 1.0f, 0.3f);
+    torus.radius = 1.3f;
+    MeshComponent smaller;
+    PrefabFactory::buildTorus(smaller, material, 24, 12, 1.0f, 0.3f);
+    smaller.radius = 1.3f;
+
+    std::vector<Entity> entities;
+    for (int i = 0; i < 3; ++i) {
+        Entity entity = scene.createEntity();
+        scene.registry.transforms().add(entity, TransformComponent{});
+        scene.registry.meshes().add(entity, torus);
+        entities.push_back(entity);
+    }
+    MeshLod lod;
+    lod.build(scene);
+    ASSERT_EQ(lod.stats().meshes, 3u);
+
+    // Entity 2 gets another mesh, entity 1 goes away, and a new one arrives.
+    *scene.registry.meshes().get(entities[2]) = smaller;
+    scene.registry.destroyEntity(entities[1]);
+    scene.entities.erase(scene.entities.begin() + 1);
+    Entity added = scene.createEntity();
+    scene.registry.transforms().add(added, TransformComponent{});
+    scene.registry.meshes().add(added, smaller);
+    lod.rebuild(scene, {entities[2], added});
+
+    MeshLod fresh;
+    fresh.build(scene);
+    EXPECT_EQ(lod.stats().meshes, 3u);
+    EXPECT_EQ(lod.stats().fullTriangles, fresh.stats().fullTriangles);
+    EXPECT_EQ(lod.stats().levelBytes, fresh.stats().levelBytes);
+
+    scene.camera.pos = {0.0f, 0.0f, 400.0f};
+    lod.update(scene);
+    EXPECT_EQ(lod.stats().reduced, 3u);
+    EXPECT_LT(scene.registry.meshes().get(added)->faceData.size(), smaller.faceData.size());
+    lod.restore(scene);
+    EXPECT_EQ(scene.registry.meshes().get(entities[2])->faceData.size(), smaller.faceData.size());
+    EXPECT_EQ(scene.registry.meshes().get(entities[0])->faceData.size(), torus.faceData.size());
+}
+
+// ============================================================================
+// CubeMapLoader Tests
+// ============================================================================
+
+TEST(CubeMapLoaderTest, MemoizesByFacePaths) {
+    CubeMapLoader::clear();
+    std::filesystem::path dir = std::filesystem::path(__FILE__).parent_path().parent_path() /
+        "resources" / "skybox" / "1";
+    auto face = [&](const char* name) { return (dir / name).string(); };
+
+    CubeMap first = CubeMapLoader::load(face("px.png"), face("nx.png"), face("py.png"),
+                                        face("ny.png"), face("pz.png"), face("nz.png"));
+    CubeMap second = CubeMapLoader::load(face("px.png"), face("nx.png"), face("py.png"),
+                                         face("ny.png"), face("pz.png"), face("nz.png"));
+    CubeMapLoader::Stats stats = CubeMapLoader::stats();
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_TRUE(stats.lastWasMemoized);
+    EXPECT_EQ(stats.bytes, 6u * 512u * 512u * 4u);
+
+    // Swapping two faces is a different cubemap.
+    CubeMapLoader::load(face("nx.png"), face("px.png"), face("py.png"),
+                        face("ny.png"), face("pz.png"), face("nz.png"));
+    EXPECT_EQ(CubeMapLoader::stats().entries, 2u);
+
+    CubeMapLoader::load(face("missing.png"), face("px.png"), face("py.png"),
+                        face("ny.png"), face("pz.png"), face("nz.png"));
+    EXPECT_EQ(CubeMapLoader::stats().entries, 2u);
+    CubeMapLoader::clear();
+}
+
+// ============================================================================
+// HdrCache Tests
+// ============================================================================
+
+TEST(HdrCacheTest, RgbeRoundTripIsExactForHdrValues) {
+    // Values an .hdr file can hold: 8-bit mantissas under a shared exponent.
+    const uint8_t stored[][4] = {{200, 100, 3, 130}, {128, 0, 255, 120}, {0, 0, 0, 0}, {255, 255, 255, 140}};
+    for (const auto& texel : stored) {
+        float r, g, b;
+        HdrCache::decodeRgbe(texel, r, g, b);
+        uint8_t encoded[4];
+        HdrCache::encodeRgbe(r, g, b, encoded);
+        float r2, g2, b2;
+        HdrCache::decodeRgbe(encoded, r2, g2, b2);
+        EXPECT_EQ(r, r2);
+        EXPECT_EQ(g, g2);
+        EXPECT_EQ(b, b2);
+    }
+}
+
+TEST(HdrCacheTest, SidecarRoundTripAndInvalidation) {
+    std::vector<float> rgb;
+    for (int i = 0; i < 8 * 4; ++i) {
+        rgb.insert(rgb.end(), {i * 0.5f, 1.0f, 0.0f});
+    }
+    int width = 8, height = 4;
+    HdrCache::shrinkToWidth(rgb, width, height, 4);
+    EXPECT_EQ(width, 4);
+    EXPECT_EQ(height, 2);
+    EXPECT_FLOAT_EQ(rgb[0], (0.0f + 0.5f + 4.0f + 4.5f) / 4.0f);
+
+    HdrCache::CompactImage image = HdrCache::compress(rgb.data(), width, height);
+    EXPECT_EQ(image.bytes(), 4u * 2u * 4u);
+
+    std::string path = (std::filesystem::temp_directory_path() / "r3d_test.r3dhdr").string();
+    ASSERT_TRUE(HdrCache::save(path, 42, 4, image));
+    HdrCache::CompactImage loaded;
+    ASSERT_TRUE(HdrCache::load(path, 42, 4, loaded));
+    EXPECT_EQ(loaded.rgbe, image.rgbe);
+    EXPECT_EQ(HdrCache::expand(loaded), HdrCache::expand(image));
+    EXPECT_FALSE(HdrCache::load(path, 43, 4, loaded));
+    EXPECT_FALSE(HdrCache::load(path, 42, 0, loaded));
+    std::filesystem::remove(path);
+}
+
 // ============================================================================
 // System Tests — TransformSystem rotation (formerly RotationSystem)
 // ============================================================================